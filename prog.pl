@@ -1,17 +1,27 @@
 #!/usr/bin/perl
 use strict;
 use warnings;
+use Getopt::Long;
 
-# cache parameters
+# cache parameters, these must match [perf_model/cap] in the simulator config:
+#   --subarrays   num_subarrays
+#   --lines       lines_per_subarray
+#   --stes        stes_per_subarray
 my $cache_line_bit_width = 512;
 my $single_SA_num_lines = 256;
 my $num_subarrays = 1;
+my $file = 'snort1.anml';
 
-# swizzle switch parameters
-my $swizzle_switch_x = 512*$num_subarrays;
-my $swizzle_switch_y = 512*$num_subarrays;
+GetOptions('subarrays=i' => \$num_subarrays,
+           'lines=i'     => \$single_SA_num_lines,
+           'stes=i'      => \$cache_line_bit_width,
+           'anml=s'      => \$file)
+   or die "USAGE: $0 [--subarrays N] [--lines N] [--stes N] [--anml file]\n";
+
+# swizzle switch parameters (switch_rows = x, switch_row_bytes = y/8)
+my $swizzle_switch_x = $cache_line_bit_width*$num_subarrays;
+my $swizzle_switch_y = $cache_line_bit_width*$num_subarrays;
 
-my $file = 'snort1.anml';
 my @STE_id;
 my $STE_id_ctr = 0;
 my @symbol_set;
@@ -310,7 +310,8 @@ Core::initiateMemoryAccess(MemComponent::component_t mem_component,
       Byte* data_buf, UInt32 data_size,
       MemModeled modeled,
       IntPtr eip,
-      SubsecondTime now)
+      SubsecondTime now,
+      UInt32 accel_op)
 {
    MYLOG("access %lx+%u %c%c modeled(%s)", address, data_size, mem_op_type == Core::WRITE ? 'W' : 'R', mem_op_type == Core::READ_EX ? 'X' : ' ', ModeledString(modeled));
 
@@ -402,7 +403,8 @@ Core::initiateMemoryAccess(MemComponent::component_t mem_component,
                mem_op_type,
                curr_addr_aligned, curr_offset,
                data_buf ? curr_data_buffer_head : NULL, curr_size,
-               modeled);
+               modeled,
+               curr_addr_aligned == begin_addr_aligned ? accel_op : 0);
 
       if (hit_where != (HitWhere::where_t)mem_component)
       {
@@ -510,7 +512,7 @@ Core::initiateMemoryAccess(MemComponent::component_t mem_component,
  *   number of misses :: State the number of cache misses
  */
 MemoryResult
-Core::accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size, MemModeled modeled, IntPtr eip, SubsecondTime now, bool is_fault_mask)
+Core::accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size, MemModeled modeled, IntPtr eip, SubsecondTime now, bool is_fault_mask, UInt32 accel_op)
 {
 
   // if(mem_op_type == Core::WRITE) 
@@ -537,9 +539,39 @@ Core::accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_add
    if (modeled == MEM_MODELED_NONE)
       return makeMemoryResult(HitWhere::UNKNOWN, SubsecondTime::Zero());
    else
-      return initiateMemoryAccess(MemComponent::L1_DCACHE, lock_signal, mem_op_type, d_addr, (Byte*) data_buffer, data_size, modeled, eip, now);
+      return initiateMemoryAccess(MemComponent::L1_DCACHE, lock_signal, mem_op_type, d_addr, (Byte*) data_buffer, data_size, modeled, eip, now, accel_op);
 }
 
+MemoryResult
+Core::accessPic(UInt32 pic_op, UInt32 logic, UInt32 count, IntPtr src, IntPtr dst, SubsecondTime now)
+{
+   MYLOG("pic op(%u) logic(%u) count(%u) src(%lx) dst(%lx)", pic_op, logic, count, src, dst);
+
+   SubsecondTime initial_time = (now == SubsecondTime::MaxTime()) ? getPerformanceModel()->getElapsedTime() : now;
+
+   m_mem_lock.acquire();
+
+   getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, initial_time);
+
+   HitWhere::where_t hit_where = getMemoryManager()->coreInitiatePicOperation(pic_op, logic, count, src, dst);
+
+   SubsecondTime final_time = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+   LOG_ASSERT_ERROR(final_time >= initial_time,
+         "final_time(%s) < initial_time(%s)",
+         itostr(final_time).c_str(),
+         itostr(initial_time).c_str());
+
+   m_mem_lock.release();
+
+   SubsecondTime shmem_time = final_time - initial_time;
+   getShmemPerfModel()->incrTotalMemoryAccessLatency(shmem_time);
+
+   // The PIC operation completes wherever its operands live, no single level hit
+   if (hit_where == HitWhere::UNKNOWN)
+      hit_where = HitWhere::MISS;
+
+   return makeMemoryResult(hit_where, shmem_time);
+}
 
 MemoryResult
 Core::nativeMemOp(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size)
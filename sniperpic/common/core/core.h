@@ -92,8 +92,11 @@ class Core
       MemoryResult readInstructionMemory(IntPtr address,
             UInt32 instruction_size);
 
-      MemoryResult accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size, MemModeled modeled = MEM_MODELED_NONE, IntPtr eip = 0, SubsecondTime now = SubsecondTime::MaxTime(), bool is_fault_mask = false);
+      // accel_op: CAP/PIC op table tag of a synthetic accelerator access (DynamicInstructionInfo), 0 for normal accesses
+      MemoryResult accessMemory(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size, MemModeled modeled = MEM_MODELED_NONE, IntPtr eip = 0, SubsecondTime now = SubsecondTime::MaxTime(), bool is_fault_mask = false, UInt32 accel_op = 0);
       MemoryResult nativeMemOp(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size);
+      // PIC: one PIC operation (SIM_PIC_* encoding) on the data cache hierarchy
+      MemoryResult accessPic(UInt32 pic_op, UInt32 logic, UInt32 count, IntPtr src, IntPtr dst, SubsecondTime now = SubsecondTime::MaxTime());
 
       void accessMemoryFast(bool icache, mem_op_t mem_op_type, IntPtr address);
 
@@ -164,7 +167,8 @@ class Core
             Byte* data_buf, UInt32 data_size,
             MemModeled modeled,
             IntPtr eip,
-            SubsecondTime now);
+            SubsecondTime now,
+            UInt32 accel_op = 0);
 
       void hookPeriodicInsCheck();
       void hookPeriodicInsCall();
@@ -0,0 +1,76 @@
+#ifndef ADDR_BANK_MAPPING_H
+#define ADDR_BANK_MAPPING_H
+
+#include "cache_cntlr.h"
+
+namespace ParametricDramDirectoryMSI
+{
+	//#ifdef PIC_ENABLE_OPERATIONS
+	// PIC: Bank topology of one cache, built from its sets, ways and configured
+	// number of banks (perf_model/<cache>/banks). Every mapping policy numbers
+	// the lines (set, way) in its own order and gives each bank an equal slice
+	// of that order, so a bank lookup is a multiply and a divide.
+	//
+	// The placement policy (perf_model/<cache>/pic_map_policy) is the mapping the
+	// cache places PIC operands by: with pic_colocate an operand is inserted in
+	// the bank of its partner line when its set has a way there.
+	class AddrBankMapping
+	{
+		public:
+			AddrBankMapping(String name, UInt32 num_sets, UInt32 associativity, UInt32 num_banks,
+				CacheCntlr::pic_map_policy_t placement_policy = CacheCntlr::PIC_ALL_WAYS_ONE_BANK,
+				bool colocate = false);
+
+			UInt32 getNumBanks() const { return m_num_banks; }
+			bool getColocate() const { return m_colocate; }
+
+			UInt32 getBank(UInt32 set, UInt32 way, CacheCntlr::pic_map_policy_t policy) const
+			{
+				assert(set < m_num_sets);
+				assert(way < m_associativity);
+				switch(policy) {
+					case CacheCntlr::PIC_ALL_WAYS_ONE_BANK:		//consecutive sets, all their ways
+						return (set * m_associativity + way) / m_lines_per_bank;
+					case CacheCntlr::PIC_MORE_SETS_ONE_BANK:	//consecutive ways, more sets of each
+						return (way * m_num_sets + set) / m_lines_per_bank;
+					case CacheCntlr::PIC_SET_INTERLEAVED:		//low order set bits pick the bank
+						return (way * m_num_sets + set) % m_num_banks;
+					default:
+						LOG_PRINT_ERROR("Unknown PIC bank mapping policy %d", policy);
+				}
+				return 0;
+			}
+
+			bool inSameBank(UInt32 set1, UInt32 way1, UInt32 set2, UInt32 way2,
+				CacheCntlr::pic_map_policy_t policy) const
+			{
+				return getBank(set1, way1, policy) == getBank(set2, way2, policy);
+			}
+
+			UInt32 getPlacementBank(UInt32 set, UInt32 way) const
+			{
+				return getBank(set, way, m_placement_policy);
+			}
+
+			// Ways of set that lie in bank under the placement policy, as a bit mask
+			UInt64 getWaysInBank(UInt32 set, UInt32 bank) const
+			{
+				UInt64 ways = 0;
+				for(UInt32 way = 0; way < m_associativity; ++way)
+					if(getPlacementBank(set, way) == bank)
+						ways |= 1ULL << way;
+				return ways;
+			}
+
+		private:
+			UInt32 m_num_sets;
+			UInt32 m_associativity;
+			UInt32 m_num_banks;
+			UInt32 m_lines_per_bank;
+			CacheCntlr::pic_map_policy_t m_placement_policy;
+			bool m_colocate;
+	};
+	//#endif
+}
+
+#endif /* ADDR_BANK_MAPPING_H */
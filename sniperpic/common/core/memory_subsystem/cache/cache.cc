@@ -1,6 +1,9 @@
 #include "simulator.h"
 #include "cache.h"
 #include "log.h"
+#include "stats.h"
+#include "addr_bank_mapping.h"
+#include "config.hpp"
 
 // Cache class
 // constructors/destructors
@@ -22,13 +25,41 @@ Cache::Cache(
    m_num_accesses(0),
    m_num_hits(0),
    m_cache_type(cache_type),
-   m_fault_injector(fault_injector)
+   m_fault_injector(fault_injector),
+   m_bank_mapping(NULL),
+   m_pic_pairs_inserted(0),
+   m_pic_pairs_colocated(0)
 {
    m_set_info = CacheSet::createCacheSetInfo(name, cfgname, core_id, replacement_policy, m_associativity);
+
+   // Data-less: only tags and state, for timing-only runs where nothing reads
+   // line contents. CAP images and functional PIC operands travel between the
+   // levels as line data, and the fault injector works on it, so with any of
+   // those every level keeps its data.
+   config::Config *cfg = Sim()->getCfg();
+   m_store_data = true;
+   if (cfg->getBoolDefault(cfgname + "/data_less", false))
+   {
+      if (m_fault_injector || cfg->getBoolDefault("general/cap_on", false) || cfg->getBoolDefault("general/pic_on", false))
+      {
+         LOG_PRINT_WARNING("%s: ignoring %s/data_less, line data is needed for CAP, PIC or fault injection", name.c_str(), cfgname.c_str());
+      }
+      else
+         m_store_data = false;
+   }
+
+   // Room for each set: its object (with replacement state) and each array
+   // rounded up to the arena's alignment
+   UInt64 set_bytes = 256
+      + 64 + CacheSetTags::paddedWays(m_associativity) * sizeof(IntPtr)
+      + 64 + m_associativity * CacheBlockInfo::getSize(m_cache_type)
+      + (m_store_data ? 64 + m_associativity * m_blocksize : 0);
+   m_arena = new CacheArena(m_num_sets * set_bytes);
+
    m_sets = new CacheSet*[m_num_sets];
    for (UInt32 i = 0; i < m_num_sets; i++)
    {
-      m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info);
+      m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info, m_arena, m_store_data);
    }
 
    #ifdef ENABLE_SET_USAGE_HIST
@@ -52,8 +83,17 @@ Cache::~Cache()
       delete m_set_info;
 
    for (SInt32 i = 0; i < (SInt32) m_num_sets; i++)
-      delete m_sets[i];
+      m_sets[i]->~CacheSet();
    delete [] m_sets;
+   delete m_arena;
+}
+
+void
+Cache::setBankMapping(const ParametricDramDirectoryMSI::AddrBankMapping *bank_mapping, core_id_t core_id)
+{
+   m_bank_mapping = bank_mapping;
+   registerStatsMetric(m_name, core_id, "pic_pairs_inserted", &m_pic_pairs_inserted);
+   registerStatsMetric(m_name, core_id, "pic_pairs_colocated", &m_pic_pairs_colocated);
 }
 
 Lock&
@@ -140,6 +180,9 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
    	UInt32 other_line_index2;
 		int avoid_line_index	= -1;
 		int avoid_line_index2	= -1;
+		bool has_partner			= false;
+		UInt32 partner_bank		= 0;
+		UInt64 colocate_ways	= 0;
 
 		if(other_pic_addr != 0) {
    		splitAddress(other_pic_addr, other_tag, other_set_index);
@@ -147,8 +190,18 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
 			if(other_set_index == set_index) {
 				if(m_sets[other_set_index]->find(other_tag, &other_line_index)) {
 					avoid_line_index = other_line_index;
+					has_partner = true;
 				}
 			}
+			else if(m_bank_mapping && m_sets[other_set_index]->find(other_tag, &other_line_index))
+				has_partner = true;
+
+			//PIC: prefer a victim in the bank the partner operand lives in
+			if(has_partner && m_bank_mapping) {
+				partner_bank = m_bank_mapping->getPlacementBank(other_set_index, other_line_index);
+				if(m_bank_mapping->getColocate())
+					colocate_ways = m_bank_mapping->getWaysInBank(set_index, partner_bank);
+			}
 		}
 		if(other_pic_addr2 != 0) {
    		splitAddress(other_pic_addr2, other_tag2, other_set_index2);
@@ -162,10 +215,17 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
    CacheBlockInfo* cache_block_info = CacheBlockInfo::create(m_cache_type);
    cache_block_info->setTag(tag);
 
-   m_sets[set_index]->insert(cache_block_info, fill_buff,
-         eviction, evict_block_info, evict_buff, cntlr, avoid_line_index, avoid_line_index2);
+   UInt32 inserted_index = m_sets[set_index]->insert(cache_block_info, fill_buff,
+         eviction, evict_block_info, evict_buff, cntlr, avoid_line_index, avoid_line_index2, colocate_ways);
    *evict_addr = tagToAddress(evict_block_info->getTag());
 
+   if (has_partner && m_bank_mapping)
+   {
+      ++m_pic_pairs_inserted;
+      if (m_bank_mapping->getPlacementBank(set_index, inserted_index) == partner_bank)
+         ++m_pic_pairs_colocated;
+   }
+
    if (m_fault_injector) {
       // NOTE: no callback is generated for read of evicted data
       UInt32 line_index = -1;
@@ -194,15 +254,16 @@ Cache::peekSingleLine(IntPtr addr)
    return m_sets[set_index]->find(tag);
 }
 
-void 
+// Location of a line, false if it is not in the cache
+bool
 Cache::peekSingleLine(IntPtr addr, UInt32* si, UInt32* li)
 {
    IntPtr tag;
    UInt32 set_index;
    splitAddress(addr, tag, set_index);
 
-   assert(m_sets[set_index]->find(tag, li));
 	 *si = set_index;
+   return m_sets[set_index]->find(tag, li) != NULL;
 }
 
 void
@@ -15,6 +15,11 @@
 // Define to enable the set usage histogram
 //#define ENABLE_SET_USAGE_HIST
 
+namespace ParametricDramDirectoryMSI
+{
+   class AddrBankMapping;
+}
+
 class Cache : public CacheBase
 {
    private:
@@ -28,9 +33,18 @@ class Cache : public CacheBase
       cache_t m_cache_type;
       CacheSet** m_sets;
       CacheSetInfo* m_set_info;
+      // Backs the sets, their block infos and data (see cache_arena.h)
+      CacheArena* m_arena;
+      // False for a data-less cache (perf_model/<cache>/data_less)
+      bool m_store_data;
 
       FaultInjector *m_fault_injector;
 
+      // PIC: Bank topology for placing PIC operands next to their partner line
+      const ParametricDramDirectoryMSI::AddrBankMapping *m_bank_mapping;
+      UInt64 m_pic_pairs_inserted;     // PIC operands inserted while their partner line was cached
+      UInt64 m_pic_pairs_colocated;    // ... that ended up in the partner's bank
+
       #ifdef ENABLE_SET_USAGE_HIST
       UInt64* m_set_usage_hist;
       #endif
@@ -50,6 +64,8 @@ class Cache : public CacheBase
             AddressHomeLookup *ahl = NULL);
       ~Cache();
 
+      void setBankMapping(const ParametricDramDirectoryMSI::AddrBankMapping *bank_mapping, core_id_t core_id);
+
       Lock& getSetLock(IntPtr addr);
 
       bool invalidateSingleLine(IntPtr addr);
@@ -60,9 +76,10 @@ class Cache : public CacheBase
             CacheBlockInfo* evict_block_info, Byte* evict_buff, SubsecondTime now, CacheCntlr *cntlr = NULL, 
 						IntPtr other_pic_addr= 0, IntPtr other_pic_addr2= 0);
       CacheBlockInfo* peekSingleLine(IntPtr addr);
-      void peekSingleLine(IntPtr addr, UInt32* set_index, UInt32* line_indes);
+      bool peekSingleLine(IntPtr addr, UInt32* set_index, UInt32* line_index);
 
       CacheBlockInfo* peekBlock(UInt32 set_index, UInt32 way) const { return m_sets[set_index]->peekBlock(way); }
+      bool storesData() const { return m_store_data; }
 
       // Update Cache Counters
       void updateCounters(bool cache_hit);
@@ -0,0 +1,65 @@
+#include "cache_arena.h"
+#include "log.h"
+
+#include <sys/mman.h>
+#include <algorithm>
+
+CacheArena::CacheArena(UInt64 size_hint)
+   : m_next(NULL)
+   , m_end(NULL)
+   , m_size_hint(size_hint)
+   , m_allocated(0)
+   , m_mapped(0)
+{
+}
+
+CacheArena::~CacheArena()
+{
+   for (std::vector<Chunk>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+      munmap(it->base, it->size);
+}
+
+void
+CacheArena::map(UInt64 bytes)
+{
+   UInt64 size = std::max(bytes, m_size_hint);
+   bool huge = size >= HugePageSize;
+   // Whole hugepages, so that the tail of the mapping can be backed by one as well.
+   // Smaller caches (L1, L2) get normal pages: a hugepage would be backed in full
+   // as soon as it is touched, most of it for nothing.
+   if (huge)
+      size = (size + HugePageSize - 1) & ~(HugePageSize - 1);
+   else
+      size = (size + PageSize - 1) & ~(PageSize - 1);
+   void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+   LOG_ASSERT_ERROR(base != MAP_FAILED, "Could not map %lu bytes for cache storage", size);
+   #ifdef MADV_HUGEPAGE
+   if (huge)
+      madvise(base, size, MADV_HUGEPAGE); // Only a hint, fine to fail when hugepages are unavailable
+   #endif
+
+   Chunk chunk = { (char*)base, size };
+   m_chunks.push_back(chunk);
+   m_next = chunk.base;
+   m_end = chunk.base + size;
+   m_mapped += size;
+   // Later mappings are for what the hint did not cover, keep them small
+   m_size_hint = HugePageSize;
+}
+
+void*
+CacheArena::allocate(UInt64 bytes, UInt64 align)
+{
+   LOG_ASSERT_ERROR((align & (align - 1)) == 0, "Alignment %lu is not a power of two", align);
+
+   char* ptr = (char*)(((IntPtr)m_next + align - 1) & ~(IntPtr)(align - 1));
+   if (m_next == NULL || ptr + bytes > m_end)
+   {
+      map(bytes + align);
+      ptr = (char*)(((IntPtr)m_next + align - 1) & ~(IntPtr)(align - 1));
+   }
+
+   m_next = ptr + bytes;
+   m_allocated += bytes;
+   return ptr;
+}
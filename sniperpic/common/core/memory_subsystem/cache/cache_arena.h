@@ -0,0 +1,48 @@
+#ifndef CACHE_ARENA_H
+#define CACHE_ARENA_H
+
+#include "fixed_types.h"
+
+#include <vector>
+
+// Per-Cache storage for the sets: the CacheSet objects, their tag arrays,
+// CacheBlockInfos and data blocks are carved out of a few large anonymous
+// mappings, in set order, instead of several heap allocations per set.
+// Mappings of at least a hugepage are advised as transparent hugepages; all
+// mappings come zero-filled.
+//
+// Memory is only returned when the arena is destroyed; objects placed in it
+// must be destroyed explicitly (not deleted) before that.
+class CacheArena
+{
+   public:
+      // size_hint: expected total, the first mapping is made this large
+      CacheArena(UInt64 size_hint);
+      ~CacheArena();
+
+      void* allocate(UInt64 bytes, UInt64 align = 64);
+
+      UInt64 getAllocated() const { return m_allocated; }
+      UInt64 getMapped() const { return m_mapped; }
+
+   private:
+      struct Chunk
+      {
+         char* base;
+         UInt64 size;
+      };
+
+      static const UInt64 HugePageSize = 2 << 20;
+      static const UInt64 PageSize = 4096;
+
+      std::vector<Chunk> m_chunks;
+      char* m_next;
+      char* m_end;
+      UInt64 m_size_hint;
+      UInt64 m_allocated;
+      UInt64 m_mapped;
+
+      void map(UInt64 bytes);
+};
+
+#endif /* CACHE_ARENA_H */
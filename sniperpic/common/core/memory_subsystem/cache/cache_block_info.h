@@ -36,6 +36,10 @@ class CacheBlockInfo
       virtual ~CacheBlockInfo();
 
       static CacheBlockInfo* create(CacheBase::cache_t cache_type);
+      // Construct in storage of at least getSize(cache_type) bytes, for the
+      // per-set block info arrays. Destroy with ~CacheBlockInfo() only.
+      static CacheBlockInfo* create(CacheBase::cache_t cache_type, void* storage);
+      static UInt32 getSize(CacheBase::cache_t cache_type);
 
       virtual void invalidate(void);
       virtual void clone(CacheBlockInfo* cache_block_info);
@@ -13,22 +13,46 @@
 #include "config.h"
 #include "config.hpp"
 
+#include <algorithm>
+#include <new>
+
 CacheSet::CacheSet(CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize):
-      m_associativity(associativity), m_blocksize(blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheArena* arena, bool store_data):
+      m_arena(arena), m_associativity(associativity), m_blocksize(blocksize)
 {
-   m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
+   LOG_ASSERT_ERROR(m_associativity <= 64, "Cache sets of more than 64 ways are not supported (%u)", m_associativity);
+
+   const UInt32 num_tags = CacheSetTags::paddedWays(m_associativity);
+   m_block_info_size = CacheBlockInfo::getSize(cache_type);
+   if (m_arena)
+   {
+      m_tags = (IntPtr*) m_arena->allocate(num_tags * sizeof(IntPtr), 32);
+      m_block_infos = (char*) m_arena->allocate(m_associativity * m_block_info_size);
+   }
+   else
+   {
+      m_tags = new IntPtr[num_tags];
+      m_block_infos = (char*) ::operator new(m_associativity * m_block_info_size);
+   }
+   std::fill(m_tags, m_tags + num_tags, CacheSetTags::InvalidTag);
+
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
+      CacheBlockInfo::create(cache_type, m_block_infos + i * m_block_info_size);
    }
 
-   if (/*Sim()->getFaultinjectionManager()*/1)
+   if (store_data)
    {
-      m_blocks = new char[m_associativity * m_blocksize];
-      memset(m_blocks, 0x00, m_associativity * m_blocksize);
+      if (m_arena)
+         // Arena memory is mapped zero-filled, untouched lines cost no physical memory
+         m_blocks = (char*) m_arena->allocate(m_associativity * m_blocksize);
+      else
+      {
+         m_blocks = new char[m_associativity * m_blocksize];
+         memset(m_blocks, 0x00, m_associativity * m_blocksize);
+      }
    } else {
-      printf("CAP: Uh oh! m_blocks is NULL!!\n");
+      // Data-less: lines are only tags and state, reads and writes copy nothing
       m_blocks = NULL;
    }
 }
@@ -36,9 +60,14 @@ CacheSet::CacheSet(CacheBase::cache_t cache_type,
 CacheSet::~CacheSet()
 {
    for (UInt32 i = 0; i < m_associativity; i++)
-      delete m_cache_block_info_array[i];
-   delete [] m_cache_block_info_array;
-   delete [] m_blocks;
+      getBlockInfo(i)->~CacheBlockInfo();
+   // Arena storage goes with the arena
+   if (!m_arena)
+   {
+      ::operator delete(m_block_infos);
+      delete [] m_tags;
+      delete [] m_blocks;
+   }
 }
 
 void
@@ -76,50 +105,50 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
 CacheBlockInfo*
 CacheSet::find(IntPtr tag, UInt32* line_index)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
-      }
-   }
-   return NULL;
+   UInt64 match = CacheSetTags::matchWays(m_tags, m_associativity, tag);
+   if (!match)
+      return NULL;
+
+   // Highest matching way, as when the ways were scanned from the last one down
+   UInt32 index = 63 - __builtin_clzll(match);
+   if (line_index != NULL)
+      *line_index = index;
+   return getBlockInfo(index);
 }
 
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-      }
-   }
-   return false;
+   UInt64 match = CacheSetTags::matchWays(m_tags, m_associativity, tag);
+   if (!match)
+      return false;
+
+   UInt32 index = 63 - __builtin_clzll(match);
+   getBlockInfo(index)->invalidate();
+   m_tags[index] = CacheSetTags::InvalidTag;
+   return true;
 }
 
-void
+UInt32
 CacheSet::insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr, 
-int avoid_index, int avoid_index2)
+int avoid_index, int avoid_index2, UInt64 way_mask)
 {
    // This replacement strategy does not take into account the fact that
    // cache blocks can be voluntarily flushed or invalidated due to another write request
-   const UInt32 index = getReplacementIndex(cntlr, avoid_index, avoid_index2);
+   const UInt32 index = way_mask
+      ? getReplacementIndexIn(cntlr, way_mask, avoid_index, avoid_index2)
+      : getReplacementIndex(cntlr, avoid_index, avoid_index2);
    assert(index < m_associativity);
 	 assert(index != avoid_index);
 	 assert(index != avoid_index2);
 
    assert(eviction != NULL);
 
-   if (m_cache_block_info_array[index]->isValid())
+   if (isValidWay(index))
    {
       *eviction = true;
       // FIXME: This is a hack. I dont know if this is the best way to do
-      evict_block_info->clone(m_cache_block_info_array[index]);
+      evict_block_info->clone(getBlockInfo(index));
       if (evict_buff != NULL && m_blocks != NULL)
          memcpy((void*) evict_buff, &m_blocks[index * m_blocksize], m_blocksize);
    }
@@ -129,52 +158,59 @@ int avoid_index, int avoid_index2)
    }
 
    // FIXME: This is a hack. I dont know if this is the best way to do
-   m_cache_block_info_array[index]->clone(cache_block_info);
+   getBlockInfo(index)->clone(cache_block_info);
+   m_tags[index] = cache_block_info->getTag();
 
    if (fill_buff != NULL && m_blocks != NULL)
       memcpy(&m_blocks[index * m_blocksize], (void*) fill_buff, m_blocksize);
+
+   return index;
 }
 
 char*
 CacheSet::getDataPtr(UInt32 line_index, UInt32 offset)
 {
+   assert(m_blocks != NULL);
    return &m_blocks[line_index * m_blocksize + offset];
 }
 
+// Placement in the arena when there is one, the set's own storage follows it
+#define NEW_CACHE_SET(type, args) (arena ? new (arena->allocate(sizeof(type))) type args : new type args)
+
 CacheSet*
 CacheSet::createCacheSet(String cfgname, core_id_t core_id,
       String replacement_policy,
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info)
+      UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info, CacheArena* arena, bool store_data)
 {
    CacheBase::ReplacementPolicy policy = parsePolicyType(replacement_policy);
    switch(policy)
    {
       case CacheBase::ROUND_ROBIN:
-         return new CacheSetRoundRobin(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetRoundRobin, (cache_type, associativity, blocksize, arena, store_data));
 
       case CacheBase::LRU:
       case CacheBase::LRU_QBS:
-         return new CacheSetLRU(cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         return NEW_CACHE_SET(CacheSetLRU, (cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id), arena, store_data));
 
       case CacheBase::NRU:
-         return new CacheSetNRU(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetNRU, (cache_type, associativity, blocksize, arena, store_data));
 
       case CacheBase::MRU:
-         return new CacheSetMRU(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetMRU, (cache_type, associativity, blocksize, arena, store_data));
 
       case CacheBase::NMRU:
-         return new CacheSetNMRU(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetNMRU, (cache_type, associativity, blocksize, arena, store_data));
 
       case CacheBase::PLRU:
-         return new CacheSetPLRU(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetPLRU, (cache_type, associativity, blocksize, arena, store_data));
 
       case CacheBase::SRRIP:
       case CacheBase::SRRIP_QBS:
-         return new CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         return NEW_CACHE_SET(CacheSetSRRIP, (cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id), arena, store_data));
 
       case CacheBase::RANDOM:
-         return new CacheSetRandom(cache_type, associativity, blocksize);
+         return NEW_CACHE_SET(CacheSetRandom, (cache_type, associativity, blocksize, arena, store_data));
 
       default:
          LOG_PRINT_ERROR("Unrecognized Cache Replacement Policy: %i",
@@ -185,6 +221,8 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
    return (CacheSet*) NULL;
 }
 
+#undef NEW_CACHE_SET
+
 CacheSetInfo*
 CacheSet::createCacheSetInfo(String name, String cfgname, core_id_t core_id, String replacement_policy, UInt32 associativity)
 {
@@ -243,7 +281,7 @@ CacheSet::parsePolicyType(String policy)
 
 bool CacheSet::isValidReplacement(UInt32 index)
 {
-   if (m_cache_block_info_array[index]->getCState() == CacheState::SHARED_UPGRADING)
+   if (getBlockInfo(index)->getCState() == CacheState::SHARED_UPGRADING)
    {
       return false;
    }
@@ -7,6 +7,8 @@
 #include "lock.h"
 #include "random.h"
 #include "log.h"
+#include "cache_set_tags.h"
+#include "cache_arena.h"
 
 #include <cstring>
 
@@ -23,14 +25,22 @@ class CacheSet
 {
    public:
 
-      static CacheSet* createCacheSet(String cfgname, core_id_t core_id, String replacement_policy, CacheBase::cache_t cache_type, UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info = NULL);
+      // With an arena, the set and all of its storage are placed in it: destroy with ~CacheSet(), do not delete.
+      // Without store_data, only tags and state are kept (see Cache::Cache)
+      static CacheSet* createCacheSet(String cfgname, core_id_t core_id, String replacement_policy, CacheBase::cache_t cache_type, UInt32 associativity, UInt32 blocksize, CacheSetInfo* set_info = NULL, CacheArena* arena = NULL, bool store_data = true);
       static CacheSetInfo* createCacheSetInfo(String name, String cfgname, core_id_t core_id, String replacement_policy, UInt32 associativity);
       static CacheBase::ReplacementPolicy parsePolicyType(String policy);
       static UInt8 getNumQBSAttempts(CacheBase::ReplacementPolicy, String cfgname, core_id_t core_id);
 
    protected:
-      CacheBlockInfo** m_cache_block_info_array;
+      // Ways are searched in m_tags (invalid ways hold ~0), their
+      // CacheBlockInfos sit side by side in m_block_infos. A tag only
+      // changes through insert() and invalidate(), which keep both in step.
+      IntPtr* m_tags;
+      char* m_block_infos;
+      UInt32 m_block_info_size;
       char* m_blocks;
+      CacheArena* m_arena;
       UInt32 m_associativity;
       UInt32 m_blocksize;
       Lock m_lock;
@@ -38,7 +48,7 @@ class CacheSet
    public:
 
       CacheSet(CacheBase::cache_t cache_type,
-            UInt32 associativity, UInt32 blocksize);
+            UInt32 associativity, UInt32 blocksize, CacheArena* arena = NULL, bool store_data = true);
       virtual ~CacheSet();
 
       UInt32 getBlockSize() { return m_blocksize; }
@@ -49,15 +59,22 @@ class CacheSet
       void write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 bytes, bool update_replacement);
       CacheBlockInfo* find(IntPtr tag, UInt32* line_index = NULL);
       bool invalidate(IntPtr& tag);
-      void insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr = NULL, int avoid_index= -1, int avoid_index2=-1);
+      UInt32 insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr = NULL, int avoid_index= -1, int avoid_index2=-1, UInt64 way_mask = 0);
 
-      CacheBlockInfo* peekBlock(UInt32 way) const { return m_cache_block_info_array[way]; }
+      CacheBlockInfo* peekBlock(UInt32 way) const { return getBlockInfo(way); }
+      CacheBlockInfo* getBlockInfo(UInt32 way) const { return (CacheBlockInfo*)(m_block_infos + way * m_block_info_size); }
+      bool isValidWay(UInt32 way) const { return m_tags[way] != CacheSetTags::InvalidTag; }
 
       char* getDataPtr(UInt32 line_index, UInt32 offset = 0);
       UInt32 getBlockSize(void) const { return m_blocksize; }
 
       virtual UInt32 getReplacementIndex(CacheCntlr *cntlr, 
 																					int avoid_index = -1, int avoid_index2 = -1) = 0;
+      // PIC: Victim among the ways in way_mask, policies that cannot restrict
+      // their choice fall back to their normal victim
+      virtual UInt32 getReplacementIndexIn(CacheCntlr *cntlr, UInt64 way_mask,
+                                           int avoid_index = -1, int avoid_index2 = -1)
+      { return getReplacementIndex(cntlr, avoid_index, avoid_index2); }
       virtual void updateReplacementIndex(UInt32) = 0;
 
       bool isValidReplacement(UInt32 index);
@@ -6,8 +6,9 @@
 
 CacheSetLRU::CacheSetLRU(
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts)
-   : CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts,
+      CacheArena* arena, bool store_data)
+   : CacheSet(cache_type, associativity, blocksize, arena, store_data)
    , m_num_attempts(num_attempts)
    , m_set_info(set_info)
 {
@@ -27,7 +28,7 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_i
    // First try to find an invalid block
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          // Mark our newly-inserted line as most-recently used
          moveToMRU(i);
@@ -54,7 +55,7 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_i
       if (attempt < m_num_attempts - 1)
       {
          LOG_ASSERT_ERROR(cntlr != NULL, "CacheCntlr == NULL, QBS can only be used when cntlr is passed in");
-         qbs_reject = cntlr->isInLowerLevelCache(m_cache_block_info_array[index]);
+         qbs_reject = cntlr->isInLowerLevelCache(getBlockInfo(index));
       }
 
       if (qbs_reject)
@@ -77,6 +78,37 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_i
    LOG_PRINT_ERROR("Should not reach here");
 }
 
+// PIC: LRU line among the ways in way_mask (an invalid one first), or the
+// normal LRU victim when none of them can be replaced
+UInt32
+CacheSetLRU::getReplacementIndexIn(CacheCntlr *cntlr, UInt64 way_mask, int avoid_index, int avoid_index2)
+{
+   SInt32 index = -1;
+   UInt8 max_bits = 0;
+   for (UInt32 i = 0; i < m_associativity; i++)
+   {
+      if (!(way_mask & (1ULL << i)) || (SInt32)i == avoid_index || (SInt32)i == avoid_index2)
+         continue;
+      if (!isValidWay(i))
+      {
+         index = i;
+         break;
+      }
+      if (isValidReplacement(i) && (index == -1 || m_lru_bits[i] > max_bits))
+      {
+         index = i;
+         max_bits = m_lru_bits[i];
+      }
+   }
+
+   if (index == -1)
+      return getReplacementIndex(cntlr, avoid_index, avoid_index2);
+
+   // Mark our newly-inserted line as most-recently used
+   moveToMRU(index);
+   return index;
+}
+
 void
 CacheSetLRU::updateReplacementIndex(UInt32 accessed_index)
 {
@@ -30,10 +30,12 @@ class CacheSetLRU : public CacheSet
 {
    public:
       CacheSetLRU(CacheBase::cache_t cache_type,
-            UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts);
+            UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts,
+            CacheArena* arena = NULL, bool store_data = true);
       virtual ~CacheSetLRU();
 
       virtual UInt32 getReplacementIndex(CacheCntlr *cntlr, int avoid_index = -1, int avoid_index2 = -1);
+      virtual UInt32 getReplacementIndexIn(CacheCntlr *cntlr, UInt64 way_mask, int avoid_index = -1, int avoid_index2 = -1);
       void updateReplacementIndex(UInt32 accessed_index);
 
    protected:
@@ -5,8 +5,8 @@
 
 CacheSetNMRU::CacheSetNMRU(
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize) :
-   CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheArena* arena, bool store_data) :
+   CacheSet(cache_type, associativity, blocksize, arena, store_data)
 {
    m_lru_bits = new UInt8[m_associativity];
    for (UInt32 i = 0; i < m_associativity; i++)
@@ -27,7 +27,7 @@ CacheSetNMRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_
 
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          updateReplacementIndex(i);
          return i;
@@ -5,8 +5,8 @@
 
 CacheSetNRU::CacheSetNRU(
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize) :
-   CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheArena* arena, bool store_data) :
+   CacheSet(cache_type, associativity, blocksize, arena, store_data)
 {
    m_lru_bits = new UInt8[m_associativity];
    for (UInt32 i = 0; i < m_associativity; i++)
@@ -28,7 +28,7 @@ CacheSetNRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_i
 
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          // If there is an invalid line(s) in the set, regardless of the LRU bits of other lines, we choose the first invalid line to replace
          // Mark our newly-inserted line as recently used
@@ -5,8 +5,8 @@
 
 CacheSetPLRU::CacheSetPLRU(
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize) :
-   CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheArena* arena, bool store_data) :
+   CacheSet(cache_type, associativity, blocksize, arena, store_data)
 {
    LOG_ASSERT_ERROR(associativity == 4 || associativity == 8,
       "PLRU not implemted for associativity %d (only 4, 8)", associativity);
@@ -25,7 +25,7 @@ CacheSetPLRU::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_
 
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          updateReplacementIndex(i);
          return i;
@@ -7,8 +7,8 @@
 
 CacheSetRandom::CacheSetRandom(
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize) :
-   CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheArena* arena, bool store_data) :
+   CacheSet(cache_type, associativity, blocksize, arena, store_data)
 {
    m_rand.seed(time(NULL));
 }
@@ -24,7 +24,7 @@ CacheSetRandom::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoi
 
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-       if (!m_cache_block_info_array[i]->isValid())
+       if (!isValidWay(i))
           return i;   // if there is an invalid line, use that line
    }
 
@@ -7,7 +7,7 @@ class CacheSetRandom : public CacheSet
 {
    public:
       CacheSetRandom(CacheBase::cache_t cache_type,
-            UInt32 associativity, UInt32 blocksize);
+            UInt32 associativity, UInt32 blocksize, CacheArena* arena = NULL, bool store_data = true);
       ~CacheSetRandom();
 
       UInt32 getReplacementIndex(CacheCntlr *cntlr, int avoid_index = -1, int avoid_index2 = -1);
@@ -7,7 +7,7 @@ class CacheSetRoundRobin : public CacheSet
 {
    public:
       CacheSetRoundRobin(CacheBase::cache_t cache_type,
-            UInt32 associativity, UInt32 blocksize);
+            UInt32 associativity, UInt32 blocksize, CacheArena* arena = NULL, bool store_data = true);
       ~CacheSetRoundRobin();
 
       UInt32 getReplacementIndex(CacheCntlr *cntlr,
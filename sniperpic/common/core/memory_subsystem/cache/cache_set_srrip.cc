@@ -8,8 +8,9 @@
 CacheSetSRRIP::CacheSetSRRIP(
       String cfgname, core_id_t core_id,
       CacheBase::cache_t cache_type,
-      UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts)
-   : CacheSet(cache_type, associativity, blocksize)
+      UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts,
+      CacheArena* arena, bool store_data)
+   : CacheSet(cache_type, associativity, blocksize, arena, store_data)
    , m_rrip_numbits(Sim()->getCfg()->getIntArray(cfgname + "/srrip/bits", core_id))
    , m_rrip_max((1 << m_rrip_numbits) - 1)
    , m_rrip_insert(m_rrip_max - 1)
@@ -32,7 +33,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid
 {
    for (UInt32 i = 0; i < m_associativity; i++)
    {
-      if (!m_cache_block_info_array[i]->isValid())
+      if (!isValidWay(i))
       {
          // If there is an invalid line(s) in the set, regardless of the LRU bits of other lines, we choose the first invalid line to replace
          // Prepare way for a new line: set prediction to 'long'
@@ -56,7 +57,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid
             if (attempt < m_num_attempts - 1)
             {
                LOG_ASSERT_ERROR(cntlr != NULL, "CacheCntlr == NULL, QBS can only be used when cntlr is passed in");
-               qbs_reject = cntlr->isInLowerLevelCache(m_cache_block_info_array[index]);
+               qbs_reject = cntlr->isInLowerLevelCache(getBlockInfo(index));
             }
 
             if (qbs_reject)
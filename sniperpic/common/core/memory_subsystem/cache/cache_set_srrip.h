@@ -9,7 +9,8 @@ class CacheSetSRRIP : public CacheSet
    public:
       CacheSetSRRIP(String cfgname, core_id_t core_id,
             CacheBase::cache_t cache_type,
-            UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts);
+            UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts,
+            CacheArena* arena = NULL, bool store_data = true);
       ~CacheSetSRRIP();
 
       UInt32 getReplacementIndex(CacheCntlr *cntlr, int avoid_index, int avoid_index2);
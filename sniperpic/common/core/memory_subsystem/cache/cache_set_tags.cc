@@ -0,0 +1,81 @@
+#include "cache_set_tags.h"
+
+#include <immintrin.h>
+
+namespace CacheSetTags
+{
+
+static inline UInt64 waysMask(UInt32 num_ways)
+{
+   return num_ways >= 64 ? ~0ULL : (1ULL << num_ways) - 1;
+}
+
+UInt64 matchWaysScalar(const IntPtr* tags, UInt32 num_ways, IntPtr tag)
+{
+   UInt64 match = 0;
+   for (UInt32 i = 0; i < num_ways; ++i)
+      match |= UInt64(tags[i] == tag) << i;
+   return match;
+}
+
+// SSE2 has no 64-bit compare: a 64-bit lane matches when both of its
+// 32-bit halves do
+static UInt64 matchWaysSSE2(const IntPtr* tags, UInt32 num_ways, IntPtr tag)
+{
+   const __m128i key = _mm_set1_epi64x(tag);
+   UInt64 match = 0;
+   for (UInt32 i = 0; i < num_ways; i += 2)
+   {
+      __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(tags + i)), key);
+      eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+      match |= UInt64(_mm_movemask_pd(_mm_castsi128_pd(eq))) << i;
+   }
+   return match & waysMask(num_ways);
+}
+
+__attribute__((target("avx2")))
+static UInt64 matchWaysAVX2(const IntPtr* tags, UInt32 num_ways, IntPtr tag)
+{
+   const __m256i key = _mm256_set1_epi64x(tag);
+   UInt64 match = 0;
+   for (UInt32 i = 0; i < num_ways; i += 4)
+   {
+      __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(tags + i)), key);
+      match |= UInt64(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << i;
+   }
+   return match & waysMask(num_ways);
+}
+
+typedef UInt64 (*match_ways_func_t)(const IntPtr*, UInt32, IntPtr);
+
+static match_ways_func_t selectMatchWays(const char** name)
+{
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      *name = "avx2";
+      return matchWaysAVX2;
+   }
+   if (__builtin_cpu_supports("sse2"))
+   {
+      *name = "sse2";
+      return matchWaysSSE2;
+   }
+   *name = "scalar";
+   return matchWaysScalar;
+}
+
+static const char* s_match_ways_name = "scalar";
+static const match_ways_func_t s_match_ways = selectMatchWays(&s_match_ways_name);
+
+UInt64 matchWays(const IntPtr* tags, UInt32 num_ways, IntPtr tag)
+{
+   return s_match_ways(tags, num_ways, tag);
+}
+
+const char* isaString()
+{
+   return s_match_ways_name;
+}
+
+}
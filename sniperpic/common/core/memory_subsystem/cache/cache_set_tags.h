@@ -0,0 +1,28 @@
+#pragma once
+
+#include "fixed_types.h"
+
+// Way search over the contiguous tag array of a CacheSet
+//
+// Each set keeps the tags of its ways in one array (invalid ways hold ~0),
+// padded to a multiple of PadWays entries so the vector kernels never need a
+// tail loop. The tags are compared 4 at a time with AVX2 or 2 at a time with
+// SSE2, selected once at startup from the host CPU features.
+namespace CacheSetTags
+{
+   static const UInt32 PadWays = 4;
+   static const IntPtr InvalidTag = ~(IntPtr)0;
+
+   // Number of entries to allocate for a set of num_ways ways
+   inline UInt32 paddedWays(UInt32 num_ways) { return (num_ways + PadWays - 1) & ~(PadWays - 1); }
+
+   // Bit i is set if tags[i] == tag, for i < num_ways (at most 64).
+   // tags must hold paddedWays(num_ways) entries.
+   UInt64 matchWays(const IntPtr* tags, UInt32 num_ways, IntPtr tag);
+
+   // Scalar reference of matchWays
+   UInt64 matchWaysScalar(const IntPtr* tags, UInt32 num_ways, IntPtr tag);
+
+   // Name of the way search kernel selected for this host
+   const char* isaString();
+}
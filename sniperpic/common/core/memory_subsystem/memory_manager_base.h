@@ -48,7 +48,12 @@ class MemoryManagerBase
             Core::mem_op_t mem_op_type,
             IntPtr address, UInt32 offset,
             Byte* data_buf, UInt32 data_length,
-            Core::MemModeled modeled) = 0;
+            Core::MemModeled modeled,
+            UInt32 accel_op = 0) = 0;
+      // PIC: one PIC operation as decoded from the instruction stream (SIM_PIC_* encoding)
+      virtual HitWhere::where_t coreInitiatePicOperation(
+            UInt32 pic_op, UInt32 logic, UInt32 count,
+            IntPtr src, IntPtr dst) = 0;
       virtual SubsecondTime coreInitiateMemoryAccessFast(
             bool icache,
             Core::mem_op_t mem_op_type,
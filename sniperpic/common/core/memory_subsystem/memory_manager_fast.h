@@ -24,7 +24,8 @@ class MemoryManagerFast : public MemoryManagerBase
             Core::mem_op_t mem_op_type,
             IntPtr address, UInt32 offset,
             Byte* data_buf, UInt32 data_length,
-            Core::MemModeled modeled)
+            Core::MemModeled modeled,
+            UInt32 accel_op = 0)
       {
          // Emulate slow interface by calling into fast interface
          assert(data_buf == NULL);
@@ -36,6 +37,11 @@ class MemoryManagerFast : public MemoryManagerBase
             return HitWhere::where_t(mem_component);
       }
 
+      HitWhere::where_t coreInitiatePicOperation(
+            UInt32 pic_op, UInt32 logic, UInt32 count,
+            IntPtr src, IntPtr dst)
+      { assert(false); }
+
       virtual SubsecondTime coreInitiateMemoryAccessFast(
             bool icache,
             Core::mem_op_t mem_op_type,
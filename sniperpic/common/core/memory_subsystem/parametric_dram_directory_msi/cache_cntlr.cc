@@ -9,6 +9,9 @@
 #include "hooks_manager.h"
 #include "cache_atd.h"
 #include "shmem_perf.h"
+#include "cap_bitset.h"
+#include "cap_trace.h"
+#include "addr_bank_mapping.h"
 
 #include <cstring>
 
@@ -114,6 +117,7 @@ CacheMasterCntlr::accessATDs(Core::mem_op_t mem_op_type, bool hit, IntPtr addres
 
 CacheMasterCntlr::~CacheMasterCntlr()
 {
+   delete m_bank_mapping;
    delete m_cache;
    for(std::vector<ATD*>::iterator it = m_atds.begin(); it != m_atds.end(); ++it)
    {
@@ -131,6 +135,7 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
       UInt32 cache_block_size,
       ComponentLatency ss_program_time,
       CacheParameters & cache_params,
+      const CapParameters & cap_params,
       ShmemPerfModel* shmem_perf_model,
       bool is_last_level_cache):
    m_mem_component(mem_component),
@@ -138,11 +143,17 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    m_next_cache_cntlr(NULL),
    m_last_level(NULL),
    m_tag_directory_home_lookup(tag_directory_home_lookup),
+   m_cap(cap_params),
+   m_swizzleSwitch(NULL),
+   m_reportingSteInfo(NULL),
+   m_startSTEMask(NULL),
+   m_currStateMask(NULL),
+   m_capActiveBuf(NULL),
+   m_allInputMask(NULL),
+   m_capHasAllInput(false),
+   m_logASCIISetIndex(cap_params.log_lines_per_subarray),  // CAP:
    m_numFSMmatches(0),
-   m_swizzleSwitch(new Byte[SWIZZLE_SWITCH_X * SWIZZLE_SWITCH_Y]), // CAP: adding swizzle switch in ctrlr
-   m_currStateMask(new Byte[SWIZZLE_SWITCH_Y]),
-   m_reportingSteInfo(new Byte[NUM_SUBARRAYS*cache_block_size]),
-   m_startSTEMask(new Byte[NUM_SUBARRAYS*cache_block_size]),
+   m_capReports(NULL),
    m_perfect(cache_params.perfect),
    m_coherent(cache_params.coherent),
    m_prefetch_on_prefetch_hit(false),
@@ -161,12 +172,37 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    m_last_remote_hit_where(HitWhere::UNKNOWN),
    m_shmem_perf(new ShmemPerf()),
    m_shmem_perf_global(NULL),
-   m_shmem_perf_model(shmem_perf_model),
-   m_logASCIISetIndex(8)  // CAP:   
+   m_shmem_perf_model(shmem_perf_model)
 {
    m_core_id_master = m_core_id - m_core_id % m_shared_cores;
    Sim()->getStatsManager()->logTopology(name, core_id, m_core_id_master);
 
+   // CAP: only the CAP units (see isCapUnit) hold a swizzle switch and state vectors,
+   // the switch alone is switch_rows * switch_row_bytes (128 MB for 64 subarrays of 512 STEs)
+   if (isCapUnit())
+   {
+      m_swizzleSwitch = new Byte[(UInt64)m_cap.switch_rows * m_cap.switch_row_bytes];
+      m_reportingSteInfo = new Byte[m_cap.switch_row_bytes];
+      m_startSTEMask = new Byte[m_cap.switch_row_bytes];
+      m_currStateMask = new Byte[m_cap.switch_row_bytes];
+      m_capActiveBuf = new Byte[m_cap.switch_row_bytes];
+      m_allInputMask = new Byte[m_cap.switch_row_bytes];
+
+      // CAP: state vectors may be wider than the STEs in the cache, keep the tail clear
+      memset(m_swizzleSwitch, 0, (UInt64)m_cap.switch_rows * m_cap.switch_row_bytes);
+      memset(m_reportingSteInfo, 0, m_cap.switch_row_bytes);
+      memset(m_startSTEMask, 0, m_cap.switch_row_bytes);
+      memset(m_currStateMask, 0, m_cap.switch_row_bytes);
+      memset(m_capActiveBuf, 0, m_cap.switch_row_bytes);
+      memset(m_allInputMask, 0, m_cap.switch_row_bytes);
+   }
+
+   // CAP: stream 0 owns the initial current state mask register
+   CapStreamContext ctx = { m_currStateMask, 0, 0 };
+   m_capCurrStream = 0;
+   m_capCurrCtx = &(m_capStreams[m_capCurrStream] = ctx);
+   m_capNumStreams = 1;
+
    LOG_ASSERT_ERROR(!Sim()->getCfg()->hasKey("perf_model/perfect_llc"),
                     "perf_model/perfect_llc is deprecated, use perf_model/lX_cache/perfect instead");
 
@@ -186,6 +222,14 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
             Sim()->getFaultinjectionManager()
                ? Sim()->getFaultinjectionManager()->getFaultInjector(m_core_id_master, mem_component)
                : NULL);
+      m_master->m_bank_mapping = new AddrBankMapping(name,
+            cache_params.num_sets, cache_params.associativity, cache_params.num_banks,
+            Sim()->getCfg()->hasKey("perf_model/" + cache_params.configName + "/pic_map_policy")
+               ? parsePicMapPolicy(Sim()->getCfg()->getString("perf_model/" + cache_params.configName + "/pic_map_policy"))
+               : CacheCntlr::PIC_ALL_WAYS_ONE_BANK,
+            Sim()->getCfg()->getBoolDefault("perf_model/" + cache_params.configName + "/pic_colocate", false));
+      m_master->m_cache->setBankMapping(m_master->m_bank_mapping, m_core_id);
+      m_master->m_pic_bank_free.resize(m_master->m_bank_mapping->getNumBanks(), SubsecondTime::Zero());
       m_master->m_prefetcher = Prefetcher::createPrefetcher(cache_params.prefetcher, cache_params.configName, m_core_id, m_shared_cores);
 
       if (Sim()->getCfg()->getBoolDefault("perf_model/" + cache_params.configName + "/atd/enabled", false))
@@ -212,6 +256,13 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    if (m_master->m_prefetcher)
       m_prefetch_on_prefetch_hit = Sim()->getCfg()->getBoolArray("perf_model/" + cache_params.configName + "/prefetcher/prefetch_on_prefetch_hit", core_id);
 
+   for(UInt32 op = 0; op < NUM_PIC_OPS; ++op)
+      m_energy.pic_line_op[op] = getAccelEnergyFJ("perf_model/" + cache_params.configName + "/pic_energy/" + picOpString(pic_ops_t(op)));
+   m_energy.cap_subarray_read = getAccelEnergyFJ("perf_model/cap/energy/subarray_read");
+   m_energy.cap_switch_row = getAccelEnergyFJ("perf_model/cap/energy/switch_row");
+   m_energy.cap_state_update = getAccelEnergyFJ("perf_model/cap/energy/state_update");
+   m_energy.cap_program_write = getAccelEnergyFJ("perf_model/cap/energy/program_write");
+
    bzero(&stats, sizeof(stats));
 
    registerStatsMetric(name, core_id, "loads", &stats.loads);
@@ -344,9 +395,13 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
 						String("pic_ops_inv")+op_str, &stats.pic_ops_inv[(int)start]);
     		registerStatsMetric(name, core_id, 
 						String("pic_ops_wb")+op_str, &stats.pic_ops_wb[(int)start]);
+    		registerStatsMetric(name, core_id, 
+						String("pic_energy_")+op_str, &stats.pic_energy[(int)start]);
 			}
    		registerStatsMetric(name, core_id, "pic_key_writes", &stats.pic_key_writes);
    		registerStatsMetric(name, core_id, "pic_key_misses", &stats.pic_key_misses);
+   		registerStatsMetric(name, core_id, "pic_bank_conflicts", &stats.pic_bank_conflicts);
+   		registerStatsMetric(name, core_id, "pic_bank_conflict_delay", &stats.pic_bank_conflict_delay);
 		}
 		else {
 			m_pic_use_vpic = false; 
@@ -357,6 +412,36 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
    	registerStatsMetric(name, core_id, "dirty_backinval", &stats.dirty_backinval);
    	registerStatsMetric(name, core_id, "writebacks", &stats.writebacks);
 
+   if (isCapUnit())
+   {
+      registerStatsMetric(name, core_id, "cap_symbols", &stats.cap_symbols);
+      registerStatsMetric(name, core_id, "cap_matches", &stats.cap_matches);
+      registerStatsMetric(name, core_id, "cap_context_switches", &stats.cap_context_switches);
+      registerStatsMetric(name, core_id, "cap_subarray_reads", &stats.cap_subarray_reads);
+      registerStatsMetric(name, core_id, "cap_switch_traversals", &stats.cap_switch_traversals);
+      registerStatsMetric(name, core_id, "cap_state_updates", &stats.cap_state_updates);
+      registerStatsMetric(name, core_id, "cap_program_writes", &stats.cap_program_writes);
+      registerStatsMetric(name, core_id, "cap_energy_subarray", &stats.cap_energy_subarray);
+      registerStatsMetric(name, core_id, "cap_energy_switch", &stats.cap_energy_switch);
+      registerStatsMetric(name, core_id, "cap_energy_state", &stats.cap_energy_state);
+      registerStatsMetric(name, core_id, "cap_energy_program", &stats.cap_energy_program);
+
+      // one report file per CAP unit, e.g. cap_reports-0.bin
+      String report_file = Sim()->getCfg()->getString("perf_model/cap/report_file");
+      if (!report_file.empty())
+         report_file = Sim()->getConfig()->formatOutputFileName(report_file + "-" + itostr(core_id) + ".bin");
+      m_capReports = new CapReportQueue(Sim()->getCfg()->getInt("perf_model/cap/report_queue_size"), report_file, core_id);
+   }
+}
+
+// CAP: the controller running the CAP ops of one CAP unit: at the CAP level, the
+// master of its slice and within the partitions (MemoryManager::m_cap_participates).
+// Shared cache proxies and cores beyond the partitions hold no CAP state.
+bool
+CacheCntlr::isCapUnit()
+{
+   return m_cap.num_subarrays && m_mem_component == m_cap.component()
+      && isMasterCache() && getMemoryManager()->capParticipates();
 }
 
 CacheCntlr::~CacheCntlr()
@@ -368,6 +453,14 @@ CacheCntlr::~CacheCntlr()
    delete m_shmem_perf;
    if (m_shmem_perf_global)
       delete m_shmem_perf_global;
+   delete [] m_swizzleSwitch;
+   for(CapStreamMap::iterator it = m_capStreams.begin(); it != m_capStreams.end(); ++it)
+      delete [] it->second.currStateMask;
+   delete [] m_reportingSteInfo;
+   delete [] m_startSTEMask;
+   delete [] m_capActiveBuf;
+   delete [] m_allInputMask;
+   delete m_capReports;
    #ifdef TRACK_LATENCY_BY_HITWHERE
    for(std::unordered_map<HitWhere::where_t, StatHist>::iterator it = lat_by_where.begin(); it != lat_by_where.end(); ++it) {
       printf("%2u-%s: ", m_core_id, HitWhereString(it->first));
@@ -415,9 +508,22 @@ const char * picMapString(CacheCntlr::pic_map_policy_t pic_policy) {
    {
       case CacheCntlr::PIC_ALL_WAYS_ONE_BANK:			return "all_ways";
       case CacheCntlr::PIC_MORE_SETS_ONE_BANK:    return "more_sets";
+      case CacheCntlr::PIC_SET_INTERLEAVED:       return "set_interleaved";
       default:                      							return "????";
    }
 }
+UInt64 getAccelEnergyFJ(String key) {
+   return Sim()->getCfg()->hasKey(key) 
+      ? UInt64(Sim()->getCfg()->getFloat(key) * 1000 + .5) : 0;
+}
+CacheCntlr::pic_map_policy_t parsePicMapPolicy(String pic_policy) {
+   for(CacheCntlr::pic_map_policy_t policy = CacheCntlr::PIC_ALL_WAYS_ONE_BANK;
+         policy < CacheCntlr::NUM_PIC_MAP_POLICY;
+         policy = CacheCntlr::pic_map_policy_t(int(policy)+1))
+      if(pic_policy == picMapString(policy))
+         return policy;
+   LOG_PRINT_ERROR("Unknown PIC bank mapping policy %s", pic_policy.c_str());
+}
 void CacheCntlr::picUpdateCounters(CacheCntlr::pic_ops_t pic_opcode, 
   IntPtr ca_address1, HitWhere::where_t hit_where1, 
   IntPtr ca_address2, HitWhere::where_t hit_where2,
@@ -426,6 +532,7 @@ void CacheCntlr::picUpdateCounters(CacheCntlr::pic_ops_t pic_opcode,
 	{
   	ScopedLock sl(getLock());
     stats.pic_ops[(int)pic_opcode]++;
+    stats.pic_energy[(int)pic_opcode] += m_energy.pic_line_op[(int)pic_opcode];
     //stats.pics_where[(int)hit_where1][(int) hit_where2]++;
 		if(m_microbench_loopsize && (pic_opcode == CacheCntlr::PIC_SEARCH)) {
 			if(m_master->m_prev_cache_cntlrs.empty()) { //L1
@@ -464,14 +571,16 @@ void CacheCntlr::picUpdateCounters(CacheCntlr::pic_ops_t pic_opcode,
 		if(!ca_address3) {
 			UInt32 set1, way1;
 			UInt32 set2, way2;
-			m_master->m_cache->peekSingleLine(ca_address1, &set1, &way1);
-			m_master->m_cache->peekSingleLine(ca_address2, &set2, &way2);
+			__attribute__((unused)) bool present =
+				m_master->m_cache->peekSingleLine(ca_address1, &set1, &way1)
+				&& m_master->m_cache->peekSingleLine(ca_address2, &set2, &way2);
+			assert(present);
 
     	for(CacheCntlr::pic_map_policy_t map_start = 
 				CacheCntlr::PIC_ALL_WAYS_ONE_BANK; 
 				map_start < CacheCntlr::NUM_PIC_MAP_POLICY; 
 				map_start = CacheCntlr::pic_map_policy_t(int(map_start)+1)) {
-				if(inSameBank(m_mem_component, set1, way1, set2, way2, map_start))
+				if(m_master->m_bank_mapping->inSameBank(set1, way1, set2, way2, map_start))
     			stats.pic_ops_in_bank[(int)pic_opcode][(int)map_start]++;
 			}
 		}
@@ -514,51 +623,38 @@ IntPtr ca_address1, IntPtr ca_address2) {
 HitWhere::where_t
 CacheCntlr::processPicVOpFromCoreLOGICAL(
 			CacheCntlr::pic_ops_t pic_opcode,
-      IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3, UInt32 count)
+      IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3, UInt32 count,
+			CacheCntlr::pic_logic_ops_t logic_op)
 {
 
 	HitWhere::where_t hit_where = HitWhere::UNKNOWN;
 	HitWhere::where_t this_hit_where;
-	SubsecondTime t_pic_begin, t_pic_entry_avail, t_pic_end;
+	SubsecondTime t_pic_begin;
+	PicPipeline pipe;
 	{
   	ScopedLock sl(getLock());
     stats.pic_vops[(int)pic_opcode]++;
 	}
+	picPipelineStart(pipe);
 	while(count) {
-		//Model finite PIC Controller table
-		{
-  	  ScopedLock sl(getLock());
-  	  t_pic_begin = getShmemPerfModel()->getElapsedTime(
-																					ShmemPerfModel::_USER_THREAD);
-  	  t_pic_entry_avail = t_pic_begin;
-  	  t_pic_entry_avail = m_master->m_l1_pic_entries.getStartTime(t_pic_begin);
-  	  SubsecondTime pic_entry_latency = t_pic_entry_avail - t_pic_begin;
-  	  // Delay until we have an empty slot in the MSHR
-  	  getShmemPerfModel()->incrElapsedTime(pic_entry_latency, 
-			 												ShmemPerfModel::_USER_THREAD);
-		}
+		t_pic_begin = picLineIssue(pipe);
 
   	this_hit_where = processPicSOpFromCoreLOGICAL(pic_opcode, ca_address1,
-				ca_address2, ca_address3);
+				ca_address2, ca_address3, logic_op);
     if (hit_where == HitWhere::UNKNOWN || (this_hit_where > hit_where))
     	hit_where = this_hit_where;
 		--count;
 
+		picLineRetire(pipe, t_pic_begin, ca_address1, ca_address2);
+		LOG_PRINT("\nV%d+%lx..+%lx:  %lu ns- %lu ns", (int)pic_opcode, 
+				ca_address1, ca_address2, t_pic_begin.getNS(), 
+				pipe.t_retire.getNS());
+
 		ca_address1 += 64;
 		ca_address2 += 64;
 		ca_address3 += 64;
-		{
-    	t_pic_end = getShmemPerfModel()->getElapsedTime(
-																			ShmemPerfModel::_USER_THREAD);
-      ScopedLock sl(getLock());
-      m_master->m_l1_pic_entries.getCompletionTime(t_pic_begin, 
-														t_pic_end - t_pic_entry_avail);
-    }
-		LOG_PRINT("\nV%d+%lx..+%lx:  %lu ns- %lu ns - %lu ns", (int)pic_opcode, 
-				ca_address1, ca_address2, t_pic_begin.getNS(), 
-				t_pic_entry_avail.getNS(),
-				t_pic_end.getNS());
 	}
+	picPipelineEnd(pipe);
   return hit_where;
 }
 HitWhere::where_t
@@ -570,7 +666,8 @@ CacheCntlr::processPicVOpFromCoreCLMULT(
 
 	HitWhere::where_t hit_where = HitWhere::UNKNOWN;
 	HitWhere::where_t this_hit_where;
-	SubsecondTime t_pic_begin, t_pic_entry_avail, t_pic_end;
+	SubsecondTime t_pic_begin;
+	PicPipeline pipe;
 	{
   	ScopedLock sl(getLock());
     stats.pic_vops[(int)pic_opcode]++;
@@ -579,19 +676,9 @@ CacheCntlr::processPicVOpFromCoreCLMULT(
 	//word_size is in bites. 64/128/256/512=#rows
 	UInt32 rows_per_cb = (512/word_size);
 	UInt32 count = (word_size/rows_per_cb);
+	picPipelineStart(pipe);
 	while(count) {
-		//Model finite PIC Controller table
-		{
-  	  ScopedLock sl(getLock());
-  	  t_pic_begin = getShmemPerfModel()->getElapsedTime(
-																					ShmemPerfModel::_USER_THREAD);
-  	  t_pic_entry_avail = t_pic_begin;
-  	  t_pic_entry_avail = m_master->m_l1_pic_entries.getStartTime(t_pic_begin);
-  	  SubsecondTime pic_entry_latency = t_pic_entry_avail - t_pic_begin;
-  	  // Delay until we have an empty slot in the MSHR
-  	  getShmemPerfModel()->incrElapsedTime(pic_entry_latency, 
-			 												ShmemPerfModel::_USER_THREAD);
-		}
+		t_pic_begin = picLineIssue(pipe);
 
   	this_hit_where = processPicSOpFromCore(pic_opcode, ca_address1,
 				ca_address2);
@@ -599,19 +686,15 @@ CacheCntlr::processPicVOpFromCoreCLMULT(
     	hit_where = this_hit_where;
 		--count;
 
-		ca_address1 += 64;
-		{
-    	t_pic_end = getShmemPerfModel()->getElapsedTime(
-																			ShmemPerfModel::_USER_THREAD);
-      ScopedLock sl(getLock());
-      m_master->m_l1_pic_entries.getCompletionTime(t_pic_begin, 
-														t_pic_end - t_pic_entry_avail);
-    }
-		LOG_PRINT("\nVMULT%d+%lx..+%lx..+%lx:  %lu ns- %lu ns - %lu ns", (int)pic_opcode, 
+		//ca_address2 is the row all line-ops multiply with
+		picLineRetire(pipe, t_pic_begin, ca_address1, 0);
+		LOG_PRINT("\nVMULT%d+%lx..+%lx..+%lx:  %lu ns- %lu ns", (int)pic_opcode, 
 				ca_address1, ca_address2, ca_address3, t_pic_begin.getNS(), 
-				t_pic_entry_avail.getNS(),
-				t_pic_end.getNS());
+				pipe.t_retire.getNS());
+
+		ca_address1 += 64;
 	}
+	picPipelineEnd(pipe);
 	//Result accumulated: tags is 1 cycle
   getMemoryManager()->incrElapsedTime(m_mem_component, 
 	CachePerfModel::ACCESS_CACHE_TAGS, ShmemPerfModel::_USER_THREAD);
@@ -632,24 +715,15 @@ CacheCntlr::processPicVOpFromCore(
 
 	HitWhere::where_t hit_where = HitWhere::UNKNOWN;
 	HitWhere::where_t this_hit_where;
-	SubsecondTime t_pic_begin, t_pic_entry_avail, t_pic_end;
+	SubsecondTime t_pic_begin;
+	PicPipeline pipe;
 	{
   	ScopedLock sl(getLock());
     stats.pic_vops[(int)pic_opcode]++;
 	}
+	picPipelineStart(pipe);
 	while(count) {
-		//Model finite PIC Controller table
-		{
-  	  ScopedLock sl(getLock());
-  	  t_pic_begin = getShmemPerfModel()->getElapsedTime(
-																					ShmemPerfModel::_USER_THREAD);
-  	  t_pic_entry_avail = t_pic_begin;
-  	  t_pic_entry_avail = m_master->m_l1_pic_entries.getStartTime(t_pic_begin);
-  	  SubsecondTime pic_entry_latency = t_pic_entry_avail - t_pic_begin;
-  	  // Delay until we have an empty slot in the MSHR
-  	  getShmemPerfModel()->incrElapsedTime(pic_entry_latency, 
-			 												ShmemPerfModel::_USER_THREAD);
-		}
+		t_pic_begin = picLineIssue(pipe);
 
   	this_hit_where = processPicSOpFromCore(pic_opcode, ca_address1,
 				ca_address2);
@@ -657,28 +731,102 @@ CacheCntlr::processPicVOpFromCore(
     	hit_where = this_hit_where;
 		--count;
 
+		//The search key is latched once, it does not hold up its bank
+		picLineRetire(pipe, t_pic_begin, ca_address1, 
+				(pic_opcode != PIC_SEARCH) ? ca_address2 : 0);
+		LOG_PRINT("\nV%d+%lx..+%lx:  %lu ns- %lu ns", (int)pic_opcode, 
+				ca_address1, ca_address2, t_pic_begin.getNS(), 
+				pipe.t_retire.getNS());
+
 		ca_address1 += 64;
 		if(pic_opcode != PIC_SEARCH)
 			ca_address2 += 64;		//Key is a constant address
-
-		{
-    	t_pic_end = getShmemPerfModel()->getElapsedTime(
-																			ShmemPerfModel::_USER_THREAD);
-      ScopedLock sl(getLock());
-      m_master->m_l1_pic_entries.getCompletionTime(t_pic_begin, 
-														t_pic_end - t_pic_entry_avail);
-    }
-		LOG_PRINT("\nV%d+%lx..+%lx:  %lu ns- %lu ns - %lu ns", (int)pic_opcode, 
-				ca_address1, ca_address2, t_pic_begin.getNS(), 
-				t_pic_entry_avail.getNS(),
-				t_pic_end.getNS());
 	}
+	picPipelineEnd(pipe);
   return hit_where;
 }
+
+//PIC: Pipelined vector engine. Line-ops issue one tag access apart, so the tag
+//lookup of a line overlaps the data-array operation of the one before it. A
+//line-op starts once a PIC entry is free (pic_outstanding), and is then
+//serialized with earlier line-ops on the banks of its operands. The vector op
+//retires in order, when its slowest line-op is done, so a vector op spread
+//over independent banks costs about the time of its most loaded bank.
+void
+CacheCntlr::picPipelineStart(PicPipeline& pipe)
+{
+	pipe.t_issue = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+	pipe.t_retire = pipe.t_issue;
+}
+
+SubsecondTime
+CacheCntlr::picLineIssue(PicPipeline& pipe)
+{
+	SubsecondTime t_begin;
+	{
+		ScopedLock sl(getLock());
+		t_begin = m_master->m_l1_pic_entries.getStartTime(pipe.t_issue);
+	}
+	getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_begin);
+	return t_begin;
+}
+
+void
+CacheCntlr::picLineRetire(PicPipeline& pipe, SubsecondTime t_begin,
+			IntPtr ca_address1, IntPtr ca_address2)
+{
+	SubsecondTime t_end = getShmemPerfModel()->getElapsedTime(
+																ShmemPerfModel::_USER_THREAD);
+	SubsecondTime t_start = t_begin;
+	IntPtr addresses[2] = { ca_address1, ca_address2 };
+	UInt32 banks[2];
+	UInt32 num_banks = 0;
+
+	ScopedLock sl(getLock());
+	if(m_master->m_pic_bank_free.size() == 1)
+		banks[num_banks++] = 0;
+	else if(m_master->m_pic_bank_free.size()) {
+		//Operands that did not end up here were operated on at another level
+		for(UInt32 i = 0; i < 2; ++i) {
+			UInt32 set, way;
+			if(addresses[i] && m_master->m_cache->peekSingleLine(addresses[i], &set, &way)) {
+				UInt32 bank = m_master->m_bank_mapping->getPlacementBank(set, way);
+				if(num_banks == 0 || banks[0] != bank)
+					banks[num_banks++] = bank;
+			}
+		}
+	}
+
+	SubsecondTime t_bank_free = t_start;
+	for(UInt32 i = 0; i < num_banks; ++i)
+		if(m_master->m_pic_bank_free[banks[i]] > t_bank_free)
+			t_bank_free = m_master->m_pic_bank_free[banks[i]];
+	if(t_bank_free > t_start) {
+		stats.pic_bank_conflicts++;
+		stats.pic_bank_conflict_delay += t_bank_free - t_start;
+		t_end += t_bank_free - t_start;
+		t_start = t_bank_free;
+	}
+	for(UInt32 i = 0; i < num_banks; ++i)
+		m_master->m_pic_bank_free[banks[i]] = t_end;
+
+	m_master->m_l1_pic_entries.getCompletionTime(t_start, t_end - t_start);
+	pipe.t_issue = t_start + m_tags_access_time.getLatency();
+	if(t_end > pipe.t_retire)
+		pipe.t_retire = t_end;
+}
+
+void
+CacheCntlr::picPipelineEnd(PicPipeline& pipe)
+{
+	getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, pipe.t_retire);
+}
+
 HitWhere::where_t
 CacheCntlr::processPicSOpFromCoreLOGICAL(
 			CacheCntlr::pic_ops_t pic_opcode,
-      IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3)
+      IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3,
+			CacheCntlr::pic_logic_ops_t logic_op)
 {
 	LOG_PRINT("\n%d+%lx..+%lx..+%lx", (int)pic_opcode, ca_address1, ca_address2, ca_address3);
   SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(
@@ -744,6 +892,8 @@ CacheCntlr::processPicSOpFromCoreLOGICAL(
 
 		picUpdateCounters(pic_opcode, ca_address1, hit_where1, 
 										ca_address2, hit_where2, ca_address3, hit_where3);
+		picExecute(getMemoryManager(), pic_opcode, ca_address1, ca_address2,
+										ca_address3, logic_op);
 		LOG_PRINT("\nL1%d+%lx..+%lx..+%lx, %s,%s,%s", (int)pic_opcode, 
 				ca_address1, ca_address2, ca_address3, HitWhereString(hit_where1), 
 				HitWhereString(hit_where2), HitWhereString(hit_where3));
@@ -835,6 +985,7 @@ CacheCntlr::processPicSOpFromCore(
 
 		picUpdateCounters(pic_opcode, ca_address1, hit_where1, 
 										ca_address2, hit_where2);
+		picExecute(getMemoryManager(), pic_opcode, ca_address1, ca_address2);
 		LOG_PRINT("\nL1%d+%lx..+%lx, %s,%s", (int)pic_opcode, 
 				ca_address1, ca_address2, HitWhereString(hit_where1), 
 				HitWhereString(hit_where2));
@@ -862,6 +1013,76 @@ CacheCntlr::processPicSOpFromCore(
 	}
 }
 
+//PIC: Functional part of an op, once both operands are present at this level.
+//Lines that are not here (no data, e.g. a remote bank) are seen as zeros.
+//COPY: line2 = line1
+//CMP/SEARCH: mask bit i set if byte i of line1 and line2 are equal
+//LOGICAL: line3 = line1 op line2
+//CLMULT is timing only
+void
+CacheCntlr::picExecute(MemoryManager* issuer, CacheCntlr::pic_ops_t pic_opcode,
+			IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3,
+			CacheCntlr::pic_logic_ops_t logic_op)
+{
+	UInt32 line_size = getCacheBlockSize();
+	Byte line1[line_size], line2[line_size];
+	UInt64 mask = 0;
+	bool matched = false;
+
+	picReadLine(ca_address1, 0, line1, line_size);
+	switch(pic_opcode) {
+		case PIC_COPY:
+			picWriteLine(ca_address2, 0, line1, line_size);
+			break;
+		case PIC_CMP:
+		case PIC_SEARCH:
+			picReadLine(ca_address2, 0, line2, line_size);
+			for(UInt32 i = 0; i < line_size && i < 64; i++)
+				if(line1[i] == line2[i])
+					mask |= (1UL << i);
+			matched = (memcmp(line1, line2, line_size) == 0);
+			break;
+		case PIC_LOGICAL:
+			picReadLine(ca_address2, 0, line2, line_size);
+			for(UInt32 i = 0; i < line_size; i++) {
+				switch(logic_op) {
+					case PIC_LOGIC_AND: line1[i] &= line2[i]; break;
+					case PIC_LOGIC_XOR: line1[i] ^= line2[i]; break;
+					default:            line1[i] |= line2[i]; break;
+				}
+			}
+			picWriteLine(ca_address3, 0, line1, line_size);
+			break;
+		default:
+			return;
+	}
+	issuer->recordPicResult(pic_opcode, mask, matched);
+}
+
+bool
+CacheCntlr::picReadLine(IntPtr ca_address, UInt32 offset, Byte* data_buf, 
+			UInt32 data_length)
+{
+	bool present = m_master->m_cache->accessSingleLine(ca_address + offset, 
+			Cache::LOAD, data_buf, data_length,
+			getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD), 
+			false) != NULL;
+	if(!present)
+		memset(data_buf, 0, data_length);
+	return present;
+}
+
+bool
+CacheCntlr::picWriteLine(IntPtr ca_address, UInt32 offset, Byte* data_buf, 
+			UInt32 data_length)
+{
+	getMemoryManager()->markCheckpointDirtyLine(ca_address);
+	return m_master->m_cache->accessSingleLine(ca_address + offset, 
+			Cache::STORE, data_buf, data_length,
+			getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD), 
+			false) != NULL;
+}
+
 //This is very similar to existing function "processMemOpFromCore" just that I
 //avoid updating any statistics and avoid DATA access
 HitWhere::where_t
@@ -1115,7 +1336,7 @@ CacheCntlr::processMemOpFromCore(
 MYLOG("----------------------------------------------");
 MYLOG("%c%c %lx+%u..+%u", mem_op_type == Core::WRITE ? 'W' : 'R', mem_op_type == Core::READ_EX ? 'X' : ' ', ca_address, offset, data_length);
 
-if(DEBUG_ENABLED)  printf("\n processMemOpFromCore(), mem_op_type(%u), ca_address(0x%x), data(%d) data length(%d), offset(%d)", mem_op_type, ca_address, (UInt32)(*data_buf), data_length, offset);
+CAP_TRACE("mem", "processMemOpFromCore() type %lu addr 0x%lx offset %lu length %lu", (UInt64)mem_op_type, (UInt64)ca_address, (UInt64)offset, (UInt64)data_length);
 
 
 
@@ -1913,6 +2134,8 @@ bool modeled, bool count, SubsecondTime t_issue) {
 
 		picUpdateCounters(pic_opcode, ca_address1, hit_where1, 
 										ca_address2, hit_where2);
+		picExecute(requester->getMemoryManager(), pic_opcode, ca_address1, 
+										ca_address2);
 		LOG_PRINT("\nL2%d+%lx..+%lx, %s,%s", (int)pic_opcode, 
 				ca_address1, ca_address2, HitWhereString(hit_where1), 
 				HitWhereString(hit_where2));
@@ -2502,6 +2725,8 @@ CacheCntlr::accessCache(
       case Core::WRITE:
          m_master->m_cache->accessSingleLine(ca_address + offset, Cache::STORE, data_buf, data_length,
                                              getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD), update_replacement);
+         // PIC: incremental checkpoints copy only the lines written here
+         getMemoryManager()->markCheckpointDirtyLine(ca_address);
          // Write-through cache - Write the next level cache also
          if (m_cache_writethrough) {
             LOG_ASSERT_ERROR(m_next_cache_cntlr, "Writethrough enabled on last-level cache !?");
@@ -2587,13 +2812,24 @@ void CacheCntlr::updateCAPLatency()
    getMemoryManager()->incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
 }
 
+void CacheCntlr::updateCAPEnergy(UInt64 subarray_reads, UInt64 switch_rows, UInt64 state_updates, UInt64 program_writes)
+{
+   stats.cap_subarray_reads += subarray_reads;
+   stats.cap_switch_traversals += switch_rows;
+   stats.cap_state_updates += state_updates;
+   stats.cap_program_writes += program_writes;
+   stats.cap_energy_subarray += subarray_reads * m_energy.cap_subarray_read;
+   stats.cap_energy_switch += switch_rows * m_energy.cap_switch_row;
+   stats.cap_energy_state += state_updates * m_energy.cap_state_update;
+   stats.cap_energy_program += program_writes * m_energy.cap_program_write;
+}
+
 /*****************************************************************************
  * CAP: Program the swizzle switch for the current state with corresponding 
  *      next_state vectors
  *****************************************************************************/
 void CacheCntlr::updateSwizzleSwitch(UInt32 steNum_BytePos, Byte* nextStateInfo, UInt32 data_length)
 {
-   //UInt32 nextStateVecLength = SWIZZLE_SWITCH_Y; 
    memcpy((m_swizzleSwitch+steNum_BytePos), nextStateInfo, data_length);
 }
 
@@ -2612,7 +2848,140 @@ void CacheCntlr::updateReportingSteInfo(UInt32 bytePos, Byte *data_buf, UInt32 d
 void CacheCntlr::updateStartStateMask(UInt32 bytePos, Byte *data_buf, UInt32 data_length)
 {
    memcpy((m_startSTEMask + bytePos), data_buf, data_length);
-   memcpy((m_currStateMask + bytePos), data_buf, data_length);  // also update the curr state mask the first time
+   // also update the curr state mask of every stream the first time
+   for(CapStreamMap::iterator it = m_capStreams.begin(); it != m_capStreams.end(); ++it)
+      memcpy((it->second.currStateMask + bytePos), data_buf, data_length);
+}
+
+/*****************************************************************************
+ * CAP: Switch the matcher to another input stream. The current state vector
+ * of the outgoing stream is kept in its context and the one of the incoming
+ * stream is loaded, which is charged context_switch_time. A stream seen for
+ * the first time starts from the start state mask.
+ *****************************************************************************/
+void CacheCntlr::switchCapStream(UInt32 stream_id)
+{
+   if (stream_id == m_capCurrStream)
+      return;
+
+   CapStreamMap::iterator it = m_capStreams.find(stream_id);
+   if (it == m_capStreams.end())  {
+      CapStreamContext ctx = { new Byte[m_cap.switch_row_bytes], 0, 0 };
+      memcpy(ctx.currStateMask, m_startSTEMask, m_cap.switch_row_bytes);
+      it = m_capStreams.insert(std::make_pair(stream_id, ctx)).first;
+      ++m_capNumStreams;
+   }
+
+   CAP_TRACE("cap", "switch stream %lu -> %lu", (UInt64)m_capCurrStream, (UInt64)stream_id);
+
+   m_capCurrStream = stream_id;
+   m_capCurrCtx = &it->second;
+   m_currStateMask = m_capCurrCtx->currStateMask;
+
+   ++stats.cap_context_switches;
+   updateCAPEnergy(0, 0, 1, 0);
+   getMemoryManager()->incrElapsedTime(m_cap.context_switch_time.getLatency(), ShmemPerfModel::_USER_THREAD);
+}
+
+/*****************************************************************************
+ * CAP: Release the context of an input stream that has ended, so that many
+ * short streams do not accumulate contexts. The current stream keeps its
+ * context (the current state mask register points into it), which is reset
+ * to the start state mask as if the stream had never been seen.
+ *****************************************************************************/
+void CacheCntlr::endCapStream(UInt32 stream_id)
+{
+   CapStreamMap::iterator it = m_capStreams.find(stream_id);
+   if (it == m_capStreams.end())
+      return;
+
+   CAP_TRACE("cap", "end stream %lu", (UInt64)stream_id);
+
+   if (stream_id == m_capCurrStream)  {
+      memcpy(it->second.currStateMask, m_startSTEMask, m_cap.switch_row_bytes);
+      it->second.numSymbols = 0;
+      it->second.numMatches = 0;
+   }
+   else  {
+      delete [] it->second.currStateMask;
+      m_capStreams.erase(it);
+   }
+}
+
+/*****************************************************************************
+ * CAP: Program the cache subarrays from a cache image (num_subarrays x 
+ * lines_per_subarray lines of stes_per_subarray bits). Each line is written
+ * functionally through the hierarchy and charged a single programming latency.
+ *****************************************************************************/
+void CacheCntlr::programCacheImage(Byte* image, UInt32 length)
+{
+   UInt32 m_log_blocksize = floorLog2(m_cache_block_size);
+   UInt32 lineBytes = m_cap.steBytesPerSubarray();
+   UInt32 numLines = length / lineBytes;
+
+   LOG_ASSERT_ERROR(numLines <= m_cap.num_subarrays*m_cap.lines_per_subarray, "CAP cache image has %d lines, only %d fit", numLines, m_cap.num_subarrays*m_cap.lines_per_subarray);
+
+   for (UInt32 line = 0; line < numLines; ++line)  {
+      UInt32 subarray = line / m_cap.lines_per_subarray;
+      UInt32 cacheLine = line % m_cap.lines_per_subarray;
+      IntPtr addr = (IntPtr)((subarray<<(m_logASCIISetIndex+m_log_blocksize)) | (cacheLine<<m_log_blocksize));
+
+      // Install the line without charging the hierarchy latency, programming is modeled below
+      SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+      processMemOpFromCore(Core::NONE, Core::WRITE, addr, 0, image + line*lineBytes, lineBytes, false, false);
+      getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_start);
+
+      getMemoryManager()->incrElapsedTime(m_ss_program_time.getLatency(), ShmemPerfModel::_USER_THREAD);
+   }
+   updateCAPEnergy(0, 0, 0, numLines);
+
+   if (DEBUG_ENABLED)  printf("programCacheImage: %d lines programmed\n", numLines);
+}
+
+/*****************************************************************************
+ * CAP: Program the swizzle switch from an image of switch_rows rows of
+ * switch_row_bytes bytes, charging one programming latency per row
+ *****************************************************************************/
+void CacheCntlr::programSwizzleSwitch(Byte* image, UInt32 length)
+{
+   UInt32 rowBytes = m_cap.switch_row_bytes;
+   UInt32 numRows = length / rowBytes;
+
+   LOG_ASSERT_ERROR(numRows <= m_cap.switch_rows, "CAP swizzle switch image has %d rows, only %d fit", numRows, m_cap.switch_rows);
+
+   for (UInt32 row = 0; row < numRows; ++row)  {
+      updateSwizzleSwitch(row*rowBytes, image + row*rowBytes, rowBytes);
+      getMemoryManager()->incrElapsedTime(m_ss_program_time.getLatency(), ShmemPerfModel::_USER_THREAD);
+   }
+   updateCAPEnergy(0, 0, 0, numRows);
+
+   if(DEBUG_ENABLED)  showSwizzleSwitch();
+}
+
+/*****************************************************************************
+ * CAP: Program the start state mask and the reporting STE mask. The image
+ * holds the start mask for all subarrays followed by the reporting mask.
+ * Images built from ANML add a third mask with the all-input STEs.
+ *****************************************************************************/
+void CacheCntlr::programSteMasks(Byte* image, UInt32 length)
+{
+   UInt32 maskLength = m_cap.stateBytes();
+   UInt32 numMasks = (length >= 3*maskLength) ? 3 : 2;
+
+   LOG_ASSERT_ERROR(length >= 2*maskLength, "CAP STE image has %d bytes, expected %d", length, 2*maskLength);
+
+   updateStartStateMask(0, image, maskLength);
+   updateReportingSteInfo(0, image + maskLength, maskLength);
+
+   memset(m_allInputMask, 0, m_cap.switch_row_bytes);
+   m_capHasAllInput = false;
+   if (numMasks == 3)  {
+      memcpy(m_allInputMask, image + 2*maskLength, maskLength);
+      m_capHasAllInput = CapBitset::intersects(m_allInputMask, m_allInputMask, maskLength);
+   }
+
+   getMemoryManager()->incrElapsedTime(numMasks*m_cap.num_subarrays*m_ss_program_time.getLatency(), ShmemPerfModel::_USER_THREAD);
+   updateCAPEnergy(0, 0, 0, numMasks*m_cap.num_subarrays);
 }
 
 /*****************************************************************************
@@ -2623,9 +2992,9 @@ void CacheCntlr::showSwizzleSwitch()
 {
    Byte singleByte;
    printf("CAP:::: SWIZZLE SWITCH\n");
-   for (int i=0; i<SWIZZLE_SWITCH_X; i++)  {
-      for (int j=0; j<SWIZZLE_SWITCH_Y; j++)  {
-         singleByte = *(m_swizzleSwitch + (i*SWIZZLE_SWITCH_Y + j));
+   for (UInt32 i=0; i<m_cap.switch_rows; i++)  {
+      for (UInt32 j=0; j<m_cap.switch_row_bytes; j++)  {
+         singleByte = *(m_swizzleSwitch + ((UInt64)i*m_cap.switch_row_bytes + j));
          printf("%d ", (UInt32)(singleByte));
       }
       printf("\n");
@@ -2638,62 +3007,18 @@ void CacheCntlr::showSwizzleSwitch()
  *
  * Description:
  * Reads the incoming bit stream comprising of current state STE bits.
- * If any of the STE bits is set, the corresponding next state STE bits are read out 
- * There is additional logic to account for multiple STEs in current state
+ * Only the set STE bits are visited (a 64-bit word at a time), and the
+ * next state rows of all of them are OR-ed together into outDataBuf.
  * 
  *****************************************************************************/
-void CacheCntlr::retrieveNextStateInfo(Byte* inDataBuf, Byte* outDataBuf)
+UInt32 CacheCntlr::retrieveNextStateInfo(Byte* inDataBuf, Byte* outDataBuf)
 {
-   UInt32 currStateVecLength = SWIZZLE_SWITCH_X; 
-   UInt32 nextStateVecLength = SWIZZLE_SWITCH_Y; 
-
-   UInt32 i=0, j=0, k=0, l=0;
-   Byte* tempOutDataBuf = new Byte[nextStateVecLength];
-   Byte trueOutByte, tempOutByte;
-   bool activeStateFound = 0;
-
-
-   for (i=0; i<nextStateVecLength; i++) {
-      Byte dataByte;  // temp var to store each byte from input currState vector
-      memcpy(&dataByte, inDataBuf+i, 1);
-
-      while (j<8) {
-         if ((Byte)(dataByte>>(7-j)) & 0x1) {   // check if last bit is 1
-            int byteToReadFrom = (i*8+j)*nextStateVecLength;  // skip every 64B chunk
-
-            memcpy(tempOutDataBuf, m_swizzleSwitch+byteToReadFrom, nextStateVecLength);  // swizzle switch look-up
-
-            if(DEBUG_ENABLED)  {
-               printf("Found next state vector at STE:%d at byte position: %d\n", (i*8+j), byteToReadFrom);
-               for (l=0; l<nextStateVecLength; l++)  
-                  printf("%d\t", (Byte)(*(tempOutDataBuf+l)));
-               printf ("\n");
-            }
-
-            if (activeStateFound) { // this means more than one active curr_state bit in input
-               while (k<nextStateVecLength)  {
-                  memcpy(&trueOutByte, outDataBuf+k, 1);
-                  memcpy(&tempOutByte, tempOutDataBuf+k, 1);
-                  trueOutByte = trueOutByte | tempOutByte;
-                  memcpy(outDataBuf+k, &trueOutByte, 1);
-                  ++k;
-               }
-               k = 0;
-            }
+   UInt32 numActive = CapBitset::nextState(m_swizzleSwitch, m_cap.switch_row_bytes, m_cap.switch_rows, inDataBuf, outDataBuf);
 
-            // copy into outDataBuf just during first hit to ensure that if another hit is found, outDataBuf does not have junk values
-            if (!activeStateFound)  
-               memcpy(outDataBuf, m_swizzleSwitch+byteToReadFrom, nextStateVecLength); 
+   CAP_TRACE("cap", "next state: %lu active STEs looked up", (UInt64)numActive);
 
-            activeStateFound = 1; // set flag to denote next_state found
-         }
-         ++j;
-      }
-      j = 0;
-   }
-
-   delete tempOutDataBuf;
-   LOG_ASSERT_ERROR(activeStateFound == 1, "No next_states were found for currently active state!");
+   LOG_ASSERT_ERROR(numActive != 0, "No next_states were found for currently active state!");
+   return numActive;
 }
 
 /*****************************************************************************
@@ -2707,38 +3032,29 @@ void CacheCntlr::processPatternMatch(UInt32 inputChar)
    UInt32 subarrayIndexBits = 0, k=0, i=0;
    UInt32 address;
    IntPtr addr;
-   Byte* temp_data_buf = new Byte[m_cache_block_size];
-   Byte* data_buf = new Byte[NUM_SUBARRAYS*m_cache_block_size];
-   Byte* out_data_buf = new Byte[NUM_SUBARRAYS*m_cache_block_size];
-   Byte tempA_data_buf, tempB_data_buf;
-   UInt32 nextStateVecLength = SWIZZLE_SWITCH_Y;
+   UInt32 nextStateVecLength = m_cap.switch_row_bytes;
+   UInt32 steBytes = m_cap.steBytesPerSubarray();
    UInt32 m_log_blocksize = floorLog2(m_cache_block_size);
 
-   while(subarrayIndexBits<NUM_SUBARRAYS){
+   while(subarrayIndexBits<m_cap.num_subarrays){
       // encode the single input character into N addresses for lookup in N subarrays
       address = (subarrayIndexBits<<(m_logASCIISetIndex+m_log_blocksize)) | (inputChar<<m_log_blocksize);
-      UInt32 offset = address & (m_log_blocksize-1);
       UInt32 addrAligned = address & (~(m_log_blocksize-1));
       addr = (IntPtr)addrAligned;
 
-      if (DEBUG_ENABLED)  printf("processPatternMatch: Value read from Cache at full addr 0x%x addr_aligned: 0x%x offset: 0x%x for input (int)%d (char)%c \n", address, addrAligned, offset, (char)(inputChar), (UInt32)(inputChar));
-
-      printf ("Reading input char: %c\n", (char)(inputChar));
+      CAP_TRACE("cap", "symbol 0x%lx subarray %lu line 0x%lx", (UInt64)inputChar, (UInt64)subarrayIndexBits, (UInt64)addr);
 
-      accessCache(Core::READ, addr, 0, temp_data_buf, m_cache_block_size, 1);
-
-      //Byte_pos = 0 means it's the first character. If its first character, then load the curr state mask
-      //if(!byte_pos)   
-      //   memcpy(m_currStateMask,temp_data_buf, SWIZZLE_SWITCH_Y);
+      // Each subarray's STE bits land directly in their slot of the active state vector
+      Byte* lineBuf = m_capActiveBuf + subarrayIndexBits*steBytes;
+      accessCache(Core::READ, addr, 0, lineBuf, steBytes, 1);
 
       if(DEBUG_ENABLED)  {
          // print the cache line
-         for (i=0; i<m_cache_block_size; i++)  
-            printf("%d\t", (Byte)(*(temp_data_buf+i)));
+         for (i=0; i<steBytes; i++)  
+            printf("%d\t", (Byte)(*(lineBuf+i)));
          printf ("\n");
       }
 
-      memcpy((data_buf+(subarrayIndexBits*m_cache_block_size)), temp_data_buf, m_cache_block_size);
       ++subarrayIndexBits;
       updateCAPLatency();
    }
@@ -2746,7 +3062,7 @@ void CacheCntlr::processPatternMatch(UInt32 inputChar)
    if(DEBUG_ENABLED)  {
       // print the reporting STE info
       printf ("Reporting STE info:\n");
-      for (i=0; i<SWIZZLE_SWITCH_Y; i++)  
+      for (i=0; i<nextStateVecLength; i++)  
          printf("%d\t", (Byte)(*(m_reportingSteInfo+i)));
       printf("\n");
    }
@@ -2754,82 +3070,81 @@ void CacheCntlr::processPatternMatch(UInt32 inputChar)
    if(DEBUG_ENABLED)  {
       // print the starting state mask
       printf ("Start state mask info:\n");
-      for (i=0; i<SWIZZLE_SWITCH_Y; i++)  
+      for (i=0; i<nextStateVecLength; i++)  
          printf("%d\t", (Byte)(*(m_startSTEMask+i)));
       printf("\n");
 
       // print the current state info before masking
       printf ("Current state info before masking: \n");
-      for (i=0; i<m_cache_block_size; i++)  
-         printf("%d\t", (Byte)(*(data_buf+i)));
+      for (i=0; i<nextStateVecLength; i++)  
+         printf("%d\t", (Byte)(*(m_capActiveBuf+i)));
       printf("\n");
    }
    
-   bool activeCurrStFound = 0;
-
-   // Mask curr state vectors read from cache subarrays with the current state Mask 
-   while (k<nextStateVecLength)  {
-      memcpy(&tempA_data_buf, data_buf+k, 1);
-      memcpy(&tempB_data_buf, m_currStateMask+k, 1);
-      tempA_data_buf = tempA_data_buf & tempB_data_buf;
+   ++stats.cap_symbols;
+   ++m_capCurrCtx->numSymbols;
 
-      if (tempA_data_buf) 
-         activeCurrStFound = 1;
+   // all-input STEs are enabled on every symbol, on top of the current state
+   if (m_capHasAllInput)
+      CapBitset::orRow(m_currStateMask, m_allInputMask, nextStateVecLength);
 
-      memcpy(data_buf+k, &tempA_data_buf, 1);
-      ++k;
-   }
+   // Mask curr state vectors read from cache subarrays with the current state Mask 
+   bool activeCurrStFound = CapBitset::maskAnd(m_capActiveBuf, m_capActiveBuf, m_currStateMask, nextStateVecLength);
 
    if(DEBUG_ENABLED)  {
       // print the current state info after masking
       printf ("Current state info after masking: \n");
-      for (i=0; i<m_cache_block_size; i++)  
-         printf("%d\t", (Byte)(*(data_buf+i)));
+      for (i=0; i<nextStateVecLength; i++)  
+         printf("%d\t", (Byte)(*(m_capActiveBuf+i)));
       printf("\n");
    }
 
    if (!activeCurrStFound) {
-      printf("No active state found for current input. Invalid transition... Resetting...\n");
+      if (DEBUG_ENABLED)  printf("No active state found for current input. Invalid transition... Resetting...\n");
 
       // update the start state mask
-      memcpy(m_currStateMask, m_startSTEMask, (NUM_SUBARRAYS*m_cache_block_size));
+      memcpy(m_currStateMask, m_startSTEMask, nextStateVecLength);
+      updateCAPEnergy(m_cap.num_subarrays, 0, 1, 0);
    }
    else { // an active current state has been found
 
-      // Look up in the swizzle switch to get the next_state vector
-      retrieveNextStateInfo(data_buf, out_data_buf);
+      // Look up in the swizzle switch to get the next_state vector, straight into the mask register
+      UInt32 switchRows = retrieveNextStateInfo(m_capActiveBuf, m_currStateMask);
+      updateCAPEnergy(m_cap.num_subarrays, switchRows, 1, 0);
      
       if(DEBUG_ENABLED)  {
          // print the next state info
          printf ("Overall next state info: \n");
-         for (i=0; i<m_cache_block_size; i++)  
-            printf("%d\t", (Byte)(*(out_data_buf+i)));
+         for (i=0; i<nextStateVecLength; i++)  
+            printf("%d\t", (Byte)(*(m_currStateMask+i)));
          printf("\n");
       }
 
-      // Update the mask register with next state bits 
-      k=0;
-      while (k<nextStateVecLength)  {
-         memcpy(m_currStateMask+k, out_data_buf+k, 1);
-         ++k;
-      }
-
-      // Reporting STE detection
-      k = 0;
-      while (k<nextStateVecLength)  {
-         memcpy(&tempA_data_buf, m_currStateMask+k, 1);
-         memcpy(&tempB_data_buf, m_reportingSteInfo+k, 1);
-         tempA_data_buf = tempA_data_buf & tempB_data_buf;
-         if (tempA_data_buf) {
-            printf("Yaay! FSM Match found! \n");
-            m_numFSMmatches++;
-             // update the start state mask
-            memcpy(m_currStateMask, m_startSTEMask, (NUM_SUBARRAYS*m_cache_block_size));
-           //exit(0);
+      // Reporting STE detection: every enabled reporting STE is one report event.
+      // The state is kept as is, so the other active STEs (and overlapping matches) go on.
+      UInt64 cycle = 0;
+      for (k = 0; k < nextStateVecLength; k++)  {
+         Byte reports = m_currStateMask[k] & m_reportingSteInfo[k];
+         if (!reports)
+            continue;
+         if (!cycle)
+            cycle = (getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD) / m_data_access_time.getPeriod()).getInternalDataForced();
+         for (i = 0; i < 8; i++)  {
+            if (reports & (0x80 >> i))  {
+               CapReport report;
+               report.offset = m_capCurrCtx->numSymbols - 1;
+               report.cycle = cycle;
+               report.ste = 8*k + i;
+               report.stream = m_capCurrStream;
+               m_capReports->push(report);
+               CAP_TRACE("cap", "report STE %lu stream %lu offset %lu", (UInt64)report.ste, (UInt64)report.stream, report.offset);
+
+               m_numFSMmatches++;
+               ++stats.cap_matches;
+               ++m_capCurrCtx->numMatches;
+            }
          }
-         ++k;
       }
-      
    }
 }
 
@@ -2839,46 +3154,32 @@ CacheCntlr::processCAPSOpFromCore(
 			CacheCntlr::cap_ops_t cap_op,
             IntPtr addr,
             Byte* data_buf, 
-            UInt32 data_length)  {
-   static int m_gl_count = 0;
+            UInt32 data_length,
+            UInt32 stream_id)  {
    static int first_print = 0;
-   if(DEBUG_ENABLED)  printf("processCAPSOpFromCore: CAP OPCODE :%d, addr (hex): 0x%x data: (int)%d (char)%c\n", (int)cap_op, (UInt32)(addr), (Byte)(*data_buf), (char)(*data_buf));
-
-   if (cap_op == CacheCntlr::CAP_SS)  {  // call the updateSwizzleSwitch function. I know this is redundant.
-      UInt32 steNum = (UInt32)(addr) / SWIZZLE_SWITCH_Y;
-      UInt32 bytePos = (UInt32)(addr) % SWIZZLE_SWITCH_Y;
-
-      if(DEBUG_ENABLED)  printf("processCAPSOpFromCore: CAP OPCODE :%d, STE (hex): 0x%x, STE Num: %d, byte position: %d\n", (int)cap_op, (UInt32)(addr), steNum, bytePos);
-
-      UInt32 steNum_BytePos = (UInt32)(addr);
-      updateSwizzleSwitch(steNum_BytePos, data_buf, data_length);
+   CAP_TRACE("cap", "op %lu addr 0x%lx length %lu stream %lu", (UInt64)cap_op, (UInt64)addr, (UInt64)data_length, (UInt64)stream_id);
 
-      // Add time
-      getMemoryManager()->incrElapsedTime(m_ss_program_time.getLatency(), ShmemPerfModel::_USER_THREAD);
-      m_gl_count++;
-      
-      // printf("gl_count=%d\n",m_gl_count);
-      if(DEBUG_ENABLED) {
-         if (m_gl_count == SWIZZLE_SWITCH_X*SWIZZLE_SWITCH_Y)  // print SS contents after all programming
-            showSwizzleSwitch();
-      }
+   if (cap_op == CacheCntlr::CAP_PROGRAM)  {  // whole cache image
+      programCacheImage(data_buf, data_length);
    }
-
-   else if (cap_op == CacheCntlr::CAP_REP_STE)  { // reporting STE programming logic
-      UInt32 bytePos = (UInt32)(addr);
-      updateReportingSteInfo(bytePos, data_buf, data_length);
+   else if (cap_op == CacheCntlr::CAP_SS)  {  // whole swizzle switch image
+      programSwizzleSwitch(data_buf, data_length);
+   }
+   else if (cap_op == CacheCntlr::CAP_REP_STE)  { // start mask and reporting STE image
+      programSteMasks(data_buf, data_length);
    }
-   else if (cap_op == CacheCntlr::CAP_ST_MASK)  { // start mask programming
-      UInt32 bytePos = (UInt32)(addr);
-      updateStartStateMask(bytePos, data_buf, data_length);
+   else if (cap_op == CacheCntlr::CAP_STREAM_END)  {
+      endCapStream(stream_id);
    }
    else {
       if (!first_print) {
          printf ("\n\n Reading input pattern...\n\n");
          first_print++;
       }
-      UInt32 bytePos = (UInt32)(addr);
-      processPatternMatch((Byte)(*data_buf));
+      // a match op carries a whole chunk of one input stream, one symbol per byte
+      switchCapStream(stream_id);
+      for (UInt32 i = 0; i < data_length; i++)
+         processPatternMatch((Byte)(data_buf[i]));
    }
 
    return HitWhere::L1_OWN;  // TODO: HACK: always return hit in L1
@@ -16,6 +16,8 @@
 #include "req_queue_list_template.h"
 #include "stats.h"
 #include "subsecond_time.h"
+#include "cap_report_queue.h"
+#include "cap_parameters.h"
 
 #include "boost/tuple/tuple.hpp"
 
@@ -36,6 +38,7 @@ namespace ParametricDramDirectoryMSI
 {
    class CacheCntlr;
    class MemoryManager;
+   class AddrBankMapping;
 }
 class FaultInjector;
 class ShmemPerf;
@@ -45,16 +48,6 @@ class ShmemPerf;
 // Time between prefetches
 #define PREFETCH_INTERVAL SubsecondTime::NS(1)
 
-// CAP: declare number of subarrays
-#define NUM_SUBARRAYS 1
-
-// CAP: Swizzle switch X (curr state) and Y (next state) dimensions (in Bytes)
-#define SWIZZLE_SWITCH_X (512*NUM_SUBARRAYS) //64 - this is line number
-#define SWIZZLE_SWITCH_Y (64*NUM_SUBARRAYS) //128 - only this is in bytes
-
-// CAP: another way to extract cache size/number of rows per sub-array
-#define CACHE_LINES_PER_SUBARRAY 256
-
 namespace ParametricDramDirectoryMSI
 {
    class Transition
@@ -106,6 +99,7 @@ namespace ParametricDramDirectoryMSI
          String prefetcher;
          UInt32 outstanding_misses;
          UInt32 pic_outstanding;
+         UInt32 num_banks;
 
          CacheParameters()
             : data_access_time(NULL,0)
@@ -118,7 +112,8 @@ namespace ParametricDramDirectoryMSI
             const ComponentLatency& _data_access_time, const ComponentLatency& _tags_access_time,
             const ComponentLatency& _writeback_time, const ComponentBandwidthPerCycle& _next_level_read_bandwidth,
             String _perf_model_type, bool _writethrough, UInt32 _shared_cores,
-            String _prefetcher, UInt32 _outstanding_misses, UInt32 _pic_outstanding)
+            String _prefetcher, UInt32 _outstanding_misses, UInt32 _pic_outstanding,
+            UInt32 _num_banks = 1)
          :
             configName(_configName), size(_size), associativity(_associativity),
             hash_function(_hash_function), replacement_policy(_replacement_policy), perfect(_perfect), coherent(_coherent),
@@ -126,7 +121,7 @@ namespace ParametricDramDirectoryMSI
             writeback_time(_writeback_time), next_level_read_bandwidth(_next_level_read_bandwidth),
             perf_model_type(_perf_model_type), writethrough(_writethrough), shared_cores(_shared_cores),
             prefetcher(_prefetcher), outstanding_misses(_outstanding_misses),
- 						pic_outstanding(_pic_outstanding)
+ 						pic_outstanding(_pic_outstanding), num_banks(_num_banks)
          {
             num_sets = k_KILO * _size / (_associativity * block_size);
             LOG_ASSERT_ERROR(k_KILO * _size == num_sets * associativity * block_size, "Invalid cache configuration: size(%d Kb) != sets(%d) * associativity(%d) * block_size(%d)", _size, num_sets, associativity, block_size);
@@ -188,6 +183,8 @@ namespace ParametricDramDirectoryMSI
          std::deque<IntPtr> m_prefetch_list;
          SubsecondTime m_prefetch_next;
          ContentionModel m_l1_pic_entries;
+         AddrBankMapping* m_bank_mapping;
+         std::vector<SubsecondTime> m_pic_bank_free;   // PIC: time each bank finishes its last line-op
 
          void createSetLocks(UInt32 cache_block_size, UInt32 num_sets, UInt32 core_offset, UInt32 num_cores);
          SetLock* getSetLock(IntPtr addr);
@@ -209,6 +206,7 @@ namespace ParametricDramDirectoryMSI
             , m_prefetch_list()
             , m_prefetch_next(SubsecondTime::Zero())
             , m_l1_pic_entries(name + ".pic_entry_table", core_id, pic_outstanding)
+            , m_bank_mapping(NULL)
          {}
          ~CacheMasterCntlr();
 
@@ -238,8 +236,16 @@ namespace ParametricDramDirectoryMSI
 				 	enum pic_map_policy_t {
 				    PIC_ALL_WAYS_ONE_BANK = 0,
 				    PIC_MORE_SETS_ONE_BANK,
+				    PIC_SET_INTERLEAVED,
 				    NUM_PIC_MAP_POLICY
 				 	};
+				 	//bitwise operation of PIC_LOGICAL
+				 	enum pic_logic_ops_t {
+				    PIC_LOGIC_OR = 0,
+				    PIC_LOGIC_AND,
+				    PIC_LOGIC_XOR,
+				    NUM_PIC_LOGIC_OPS
+				 	};
 				 //#endif
 
       private:
@@ -251,14 +257,50 @@ namespace ParametricDramDirectoryMSI
          CacheCntlr* m_last_level;
          AddressHomeLookup* m_tag_directory_home_lookup;
          std::unordered_map<IntPtr, MemComponent::component_t> m_shmem_req_source_map;
+         // CAP: geometry, all CAP buffers below are sized from it at construction,
+         // and only allocated when this controller is a CAP unit (NULL otherwise)
+         CapParameters m_cap;
+         // CAP/PIC: dynamic energy of one event in fJ, from the pJ values of
+         // [perf_model/<cache>/pic_energy] and [perf_model/cap/energy] that
+         // tools/cacti_pic.py derives from CACTI subarray models. Unset events cost 0.
+         struct AccelEnergy
+         {
+            UInt64 pic_line_op[NUM_PIC_OPS]; // one PIC line-op inside a bank
+            UInt64 cap_subarray_read;        // one STE line read from a subarray
+            UInt64 cap_switch_row;           // one swizzle switch row traversed
+            UInt64 cap_state_update;         // one write of the current state mask register
+            UInt64 cap_program_write;        // one line, switch row or mask programmed
+         } m_energy;
          // CAP: define swizzle switch        
          Byte* m_swizzleSwitch;
          Byte* m_reportingSteInfo;
          Byte* m_startSTEMask;
+         // CAP: one matching context per input stream, created on first use. The
+         // current state mask register points into the context of m_capCurrStream.
+         struct CapStreamContext
+         {
+            Byte* currStateMask;
+            UInt64 numSymbols;
+            UInt64 numMatches;
+         };
+         typedef std::unordered_map<UInt32, CapStreamContext> CapStreamMap;
+         CapStreamMap m_capStreams;
+         CapStreamContext* m_capCurrCtx;
+         UInt32 m_capCurrStream;
+         UInt32 m_capNumStreams;            // streams started, including ended ones
          // CAP: current state mask register
          Byte* m_currStateMask;
+         // CAP: scratch active state vector for processPatternMatch, sized once at construction
+         Byte* m_capActiveBuf;
+         // CAP: all-input STEs, enabled on every input symbol
+         Byte* m_allInputMask;
+         bool m_capHasAllInput;
          UInt32 m_logASCIISetIndex; 
-         UInt32 m_numFSMmatches;
+         UInt64 m_numFSMmatches;
+         // CAP: report events of the matcher, NULL for caches not running CAP
+         CapReportQueue* m_capReports;
+
+         bool isCapUnit();
 
          bool m_perfect;
          bool m_coherent;
@@ -310,8 +352,14 @@ namespace ParametricDramDirectoryMSI
            		UInt64 pic_vops[(CacheCntlr::NUM_PIC_OPS)];
            		UInt64 pic_key_writes;
            		UInt64 pic_key_misses;
+           		UInt64 pic_bank_conflicts;
+           		SubsecondTime pic_bank_conflict_delay;
+           		UInt64 pic_energy[(CacheCntlr::NUM_PIC_OPS)];	//fJ
 						//#endif
 							UInt64 dirty_evicts, dirty_backinval, writebacks;
+           UInt64 cap_symbols, cap_matches, cap_context_switches;
+           UInt64 cap_subarray_reads, cap_switch_traversals, cap_state_updates, cap_program_writes;
+           UInt64 cap_energy_subarray, cap_energy_switch, cap_energy_state, cap_energy_program; // fJ
          } stats;
          #ifdef TRACK_LATENCY_BY_HITWHERE
          std::unordered_map<HitWhere::where_t, StatHist> lat_by_where;
@@ -438,10 +486,11 @@ namespace ParametricDramDirectoryMSI
          enum cap_ops_t {
            CAP_NONE = 0,
            CAP_MATCH,
-           CAP_SS,
-           CAP_REP_STE, // for reporting STEs
-           CAP_ST_MASK,  // for FSM start mask
-           CAP_END
+           CAP_PROGRAM, // bulk cache subarray image
+           CAP_SS,      // bulk swizzle switch image
+           CAP_REP_STE, // bulk start mask + reporting STE image
+           CAP_END,
+           CAP_STREAM_END // end of one input stream, its context is released
          };
 
          CacheCntlr(MemComponent::component_t mem_component,
@@ -454,6 +503,7 @@ namespace ParametricDramDirectoryMSI
                UInt32 cache_block_size,
                ComponentLatency ss_program_time,
                CacheParameters & cache_params,
+               const CapParameters & cap_params,
                ShmemPerfModel* shmem_perf_model,
                bool is_last_level_cache);
 
@@ -480,7 +530,8 @@ namespace ParametricDramDirectoryMSI
                IntPtr ca_address1, IntPtr ca_address2);
 					HitWhere::where_t processPicSOpFromCoreLOGICAL(
 							CacheCntlr::pic_ops_t pic_opcode,
-      				IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3);
+      				IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3,
+							CacheCntlr::pic_logic_ops_t logic_op = PIC_LOGIC_OR);
 
          	HitWhere::where_t processPicVOpFromCore(
 							 CacheCntlr::pic_ops_t pic_opcode,
@@ -488,12 +539,25 @@ namespace ParametricDramDirectoryMSI
 
          	HitWhere::where_t processPicVOpFromCoreLOGICAL(
 							 CacheCntlr::pic_ops_t pic_opcode,
-               IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3, UInt32 count);
+               IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3, UInt32 count,
+							 CacheCntlr::pic_logic_ops_t logic_op = PIC_LOGIC_OR);
 
          	HitWhere::where_t processPicVOpFromCoreCLMULT(
 							 CacheCntlr::pic_ops_t pic_opcode,
                IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3, UInt32 word_size);
 
+					//PIC: Pipelined vector op, one line-op at a time between
+					//picLineIssue and picLineRetire
+					struct PicPipeline {
+						SubsecondTime t_issue;		//issue time of the next line-op
+						SubsecondTime t_retire;		//completion time of all line-ops so far
+					};
+					void picPipelineStart(PicPipeline& pipe);
+					SubsecondTime picLineIssue(PicPipeline& pipe);
+					void picLineRetire(PicPipeline& pipe, SubsecondTime t_begin,
+							IntPtr ca_address1, IntPtr ca_address2);
+					void picPipelineEnd(PicPipeline& pipe);
+
          	HitWhere::where_t picProcessMemOpFromCore(
                Core::lock_signal_t lock_signal,
                Core::mem_op_t mem_op_type,
@@ -526,6 +590,14 @@ namespace ParametricDramDirectoryMSI
 				 IntPtr address1, IntPtr address2, SubsecondTime t_issue);
          void picUpdateCorrections(CacheCntlr::pic_ops_t pic_opcode, 
 					unsigned short inv, unsigned short wb);
+				 //Functional part of a PIC op, on the line bytes held at this level.
+				 //The result goes to the memory manager of the core that issued it.
+				 void picExecute(MemoryManager* issuer, CacheCntlr::pic_ops_t pic_opcode,
+					IntPtr ca_address1, IntPtr ca_address2, IntPtr ca_address3 = 0,
+					CacheCntlr::pic_logic_ops_t logic_op = PIC_LOGIC_OR);
+				 //Line bytes at this level without modeling an access, false if the line is not here
+				 bool picReadLine(IntPtr ca_address, UInt32 offset, Byte* data_buf, UInt32 data_length);
+				 bool picWriteLine(IntPtr ca_address, UInt32 offset, Byte* data_buf, UInt32 data_length);
 				 	IntPtr pic_other_load_address; //No eviction for this line
 				 	IntPtr pic_other_load2_address; //No eviction for this line, too
 				 	IntPtr pic_last_key_address;
@@ -563,6 +635,9 @@ namespace ParametricDramDirectoryMSI
          // CAP: Update latency figures
          void updateCAPLatency();
 
+         // CAP: Count CAP events and charge their energy
+         void updateCAPEnergy(UInt64 subarray_reads, UInt64 switch_rows, UInt64 state_updates, UInt64 program_writes);
+
          // CAP: Program the swizzle switch
          void updateSwizzleSwitch(UInt32 steNum_BytePos, Byte* nextStateInfo, UInt32 data_length);
 
@@ -571,31 +646,55 @@ namespace ParametricDramDirectoryMSI
 
          //CAP: update the curr state mask at the beginning of sim and after every reset
          void updateStartStateMask(UInt32 bytePos, Byte *data_buf, UInt32 data_length);
+
+         // CAP: Bulk programming of the cache subarrays, one line at a time
+         void programCacheImage(Byte* image, UInt32 length);
+
+         // CAP: Bulk programming of the swizzle switch, one STE row at a time
+         void programSwizzleSwitch(Byte* image, UInt32 length);
+
+         // CAP: Bulk programming of the start state mask followed by the reporting STE mask (and optionally the all-input mask)
+         void programSteMasks(Byte* image, UInt32 length);
          
+         // CAP: make stream_id the current input stream, charging a context switch if it changes
+         void switchCapStream(UInt32 stream_id);
+
+         // CAP: release the context of a stream that has ended, a later stream with the same id starts afresh
+         void endCapStream(UInt32 stream_id);
+
          // CAP: show the contents of the swizzle switch
          void showSwizzleSwitch();
 
-         // CAP: Look up next state from current state using swizzle switch 
-         void retrieveNextStateInfo(Byte* inDataBuf, Byte* outDataBuf);
+         // CAP: Look up next state from current state using swizzle switch, returns the rows traversed
+         UInt32 retrieveNextStateInfo(Byte* inDataBuf, Byte* outDataBuf);
 
          // CAP: parent function which gets the input character, accesses the cache subarrays and concatenates the curr_state vectors from each,
          // performs a lookup in the swizzle switch and estimates next_state vectors and writes back into the curr_state mask register
          void processPatternMatch (UInt32 inputChar);
 
-         UInt32 getNumFSMmatches()
+         UInt64 getNumFSMmatches()
          { return m_numFSMmatches;  }
-
-         //CAP: 
+         // CAP: write out the queued report events
+         void drainCapReports()
+         { if (m_capReports) m_capReports->drain();  }
+         UInt32 getNumCapStreams()
+         { return m_capNumStreams;  }
+         UInt64 getCapStreamMatches(UInt32 stream_id)
+         { CapStreamMap::iterator it = m_capStreams.find(stream_id); return it == m_capStreams.end() ? 0 : it->second.numMatches;  }
+
+         //CAP: match ops carry the id of the input stream their symbols belong to
          HitWhere::where_t processCAPSOpFromCore(CacheCntlr::cap_ops_t cap_op,
-                                             IntPtr addr, Byte* data_buf, UInt32 data_length);
+                                             IntPtr addr, Byte* data_buf, UInt32 data_length,
+                                             UInt32 stream_id = 0);
  
          
    };
 	//#ifdef PIC_ENABLE_OPERATIONS
-		extern bool inSameBank(MemComponent::component_t, int set1, int way1, 
-		int set2, int way2, CacheCntlr::pic_map_policy_t policy);
 		const char * picOpString(CacheCntlr::pic_ops_t pic_opcode);
 		const char * picMapString(CacheCntlr::pic_map_policy_t pic_policy);
+		CacheCntlr::pic_map_policy_t parsePicMapPolicy(String pic_policy);
+		//energy of one PIC/CAP event, configured in pJ, returned in fJ (0 if unset)
+		UInt64 getAccelEnergyFJ(String key);
 	//#endif
           
           
@@ -0,0 +1,436 @@
+#include "cap_anml_loader.h"
+#include "log.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+
+namespace ParametricDramDirectoryMSI
+{
+
+CapAnmlLoader::CapAnmlLoader(const CapParameters& cap_params)
+   : m_cap(cap_params)
+{
+}
+
+void
+CapAnmlLoader::load(const String& filename)
+{
+   m_filename = filename;
+
+   std::ifstream in(filename.c_str());
+   LOG_ASSERT_ERROR(in.good(), "CAP: Could not open ANML file %s", filename.c_str());
+   std::stringstream text;
+   text << in.rdbuf();
+
+   m_stes.clear();
+   m_ste_index.clear();
+   m_counters.clear();
+
+   parse(text.str());
+   foldOrs();
+   buildImages();
+}
+
+/*****************************************************************************
+ * Tag level XML scan, ANML does not need more: elements nest at most one
+ * level below state-transition-element, or and counter.
+ *****************************************************************************/
+void
+CapAnmlLoader::parse(const std::string& text)
+{
+   SInt32 current = -1;    // STE or or element whose children are being parsed
+   bool in_counter = false;
+   size_t pos = 0;
+
+   while ((pos = text.find('<', pos)) != std::string::npos)
+   {
+      if (text.compare(pos, 4, "<!--") == 0)
+      {
+         pos = text.find("-->", pos);
+         LOG_ASSERT_ERROR(pos != std::string::npos, "CAP: %s: unterminated comment", m_filename.c_str());
+         continue;
+      }
+
+      size_t end = findTagEnd(text, pos);
+      LOG_ASSERT_ERROR(end != std::string::npos, "CAP: %s: unterminated tag", m_filename.c_str());
+      std::string tag = text.substr(pos + 1, end - pos - 1);
+      pos = end + 1;
+
+      if (tag.empty() || tag[0] == '?' || tag[0] == '!')
+         continue;
+
+      bool closing = (tag[0] == '/');
+      bool self_closing = (tag[tag.size() - 1] == '/');
+      size_t name_start = closing ? 1 : 0;
+      size_t name_end = tag.find_first_of(" \t\r\n/", name_start);
+      std::string name = tag.substr(name_start, name_end == std::string::npos ? std::string::npos : name_end - name_start);
+
+      if (closing)
+      {
+         if (name == "state-transition-element" || name == "or")
+            current = -1;
+         else if (name == "counter")
+            in_counter = false;
+         continue;
+      }
+
+      std::map<std::string, std::string> attrs = parseAttributes(tag);
+
+      if (name == "state-transition-element" || name == "or")
+      {
+         Ste ste;
+         ste.id = attrs["id"];
+         ste.symbols.assign(256, false);
+         ste.start_of_data = ste.all_input = ste.reporting = false;
+         ste.is_or = (name == "or");
+
+         LOG_ASSERT_ERROR(!ste.id.empty(), "CAP: %s: %s without id", m_filename.c_str(), name.c_str());
+         LOG_ASSERT_ERROR(m_ste_index.find(ste.id) == m_ste_index.end(), "CAP: %s: duplicate element id %s", m_filename.c_str(), ste.id.c_str());
+
+         if (name == "state-transition-element")
+         {
+            LOG_ASSERT_ERROR(attrs.count("symbol-set"), "CAP: %s: STE %s without symbol-set", m_filename.c_str(), ste.id.c_str());
+            parseSymbolSet(attrs["symbol-set"], ste.symbols);
+         }
+
+         const std::string& start = attrs["start"];
+         if (start == "start-of-data")
+            ste.start_of_data = true;
+         else if (start == "all-input")
+            ste.all_input = true;
+         else
+            LOG_ASSERT_ERROR(start.empty() || start == "none", "CAP: %s: STE %s has unknown start type %s", m_filename.c_str(), ste.id.c_str(), start.c_str());
+         if (ste.is_or && (ste.start_of_data || ste.all_input))
+            LOG_PRINT_ERROR("CAP: %s: or element %s cannot be a start element", m_filename.c_str(), ste.id.c_str());
+
+         m_ste_index[ste.id] = m_stes.size();
+         m_stes.push_back(ste);
+         current = self_closing ? -1 : (SInt32)(m_stes.size() - 1);
+      }
+      else if (name == "counter")
+      {
+         m_counters[attrs["id"]] = true;
+         in_counter = !self_closing;
+      }
+      else if (name == "activate-on-match")
+      {
+         if (current >= 0)
+            m_stes[current].targets.push_back(attrs["element"]);
+      }
+      else if (name == "report-on-match" || name == "report-on-high")
+      {
+         if (current >= 0)
+            m_stes[current].reporting = true;
+      }
+      else if (name == "activate-on-target" && in_counter)
+      {
+         LOG_PRINT_WARNING("CAP: %s: counters are not supported, dropping counter output to %s", m_filename.c_str(), attrs["element"].c_str());
+      }
+   }
+}
+
+// An or matches when any of its inputs does, in the same cycle: an edge into
+// an or is replaced by edges into its targets (following chains of ors). CAP
+// reports when a reporting STE is enabled, so a reporting or keeps an STE of
+// its own, with no symbols and no targets, that its sources still enable: it
+// reports after the source matched, as prog.pl has it. The other ors are
+// removed, STEs keep their document order.
+void
+CapAnmlLoader::foldOrs()
+{
+   UInt32 num_folded = 0;
+   for (std::vector<Ste>::iterator ste = m_stes.begin(); ste != m_stes.end(); ++ste)
+   {
+      if (ste->is_or)
+      {
+         if (!ste->reporting)
+            ++num_folded;
+         continue;
+      }
+
+      std::vector<std::string> targets;
+      std::vector<std::string> pending(ste->targets.rbegin(), ste->targets.rend());
+      std::map<std::string, bool> visited;
+      while (!pending.empty())
+      {
+         std::string target = pending.back();
+         pending.pop_back();
+
+         std::map<std::string, UInt32>::iterator dest = m_ste_index.find(target);
+         if (dest == m_ste_index.end() || !m_stes[dest->second].is_or)
+         {
+            targets.push_back(target);
+            continue;
+         }
+         if (visited[target])
+            continue;
+         visited[target] = true;
+
+         const Ste& ste_or = m_stes[dest->second];
+         if (ste_or.reporting)
+            targets.push_back(target);
+         pending.insert(pending.end(), ste_or.targets.rbegin(), ste_or.targets.rend());
+      }
+      ste->targets.swap(targets);
+   }
+
+   // A kept or never matches, its targets are reached through its sources
+   for (std::vector<Ste>::iterator ste = m_stes.begin(); ste != m_stes.end(); ++ste)
+      if (ste->is_or)
+         ste->targets.clear();
+
+   if (num_folded == 0)
+      return;
+
+   std::vector<Ste> stes;
+   m_ste_index.clear();
+   for (std::vector<Ste>::iterator ste = m_stes.begin(); ste != m_stes.end(); ++ste)
+   {
+      if (ste->is_or && !ste->reporting)
+         continue;
+      m_ste_index[ste->id] = stes.size();
+      stes.push_back(*ste);
+   }
+   m_stes.swap(stes);
+}
+
+// Position of the > closing the tag starting at pos, > inside quoted attribute values does not count
+size_t
+CapAnmlLoader::findTagEnd(const std::string& text, size_t pos)
+{
+   char quote = 0;
+   for (size_t i = pos + 1; i < text.size(); ++i)
+   {
+      if (quote)
+      {
+         if (text[i] == quote)
+            quote = 0;
+      }
+      else if (text[i] == '"' || text[i] == '\'')
+         quote = text[i];
+      else if (text[i] == '>')
+         return i;
+   }
+   return std::string::npos;
+}
+
+std::map<std::string, std::string>
+CapAnmlLoader::parseAttributes(const std::string& tag)
+{
+   std::map<std::string, std::string> attrs;
+   size_t pos = 0;
+
+   while ((pos = tag.find('=', pos)) != std::string::npos)
+   {
+      size_t name_end = tag.find_last_not_of(" \t\r\n", pos - 1);
+      size_t name_start = tag.find_last_of(" \t\r\n", name_end);
+      std::string name = tag.substr(name_start + 1, name_end - name_start);
+
+      size_t quote = tag.find_first_of("\"'", pos);
+      if (quote == std::string::npos)
+         break;
+      size_t close = tag.find(tag[quote], quote + 1);
+      if (close == std::string::npos)
+         break;
+
+      attrs[name] = decodeEntities(tag.substr(quote + 1, close - quote - 1));
+      pos = close + 1;
+   }
+   return attrs;
+}
+
+std::string
+CapAnmlLoader::decodeEntities(const std::string& value)
+{
+   std::string out;
+   for (size_t i = 0; i < value.size(); ++i)
+   {
+      size_t semi;
+      if (value[i] != '&' || (semi = value.find(';', i)) == std::string::npos)
+      {
+         out += value[i];
+         continue;
+      }
+      std::string entity = value.substr(i + 1, semi - i - 1);
+      if (entity == "amp") out += '&';
+      else if (entity == "lt") out += '<';
+      else if (entity == "gt") out += '>';
+      else if (entity == "quot") out += '"';
+      else if (entity == "apos") out += '\'';
+      else if (entity.size() > 2 && entity[0] == '#' && entity[1] == 'x') out += (char)strtoul(entity.c_str() + 2, NULL, 16);
+      else if (entity.size() > 1 && entity[0] == '#') out += (char)strtoul(entity.c_str() + 1, NULL, 10);
+      else
+      {
+         out += value[i];
+         continue;
+      }
+      i = semi;
+   }
+   return out;
+}
+
+/*****************************************************************************
+ * Symbol sets: "*", a single symbol, or a [...] class with optional ^,
+ * ranges, \xHH, \d \s \w (and their complements) and the usual escapes
+ *****************************************************************************/
+void
+CapAnmlLoader::parseSymbolSet(const std::string& set, std::vector<bool>& symbols)
+{
+   if (set == "*")
+   {
+      symbols.assign(256, true);
+      return;
+   }
+
+   std::string body = set;
+   bool negate = false;
+   if (set.size() >= 2 && set[0] == '[' && set[set.size() - 1] == ']')
+   {
+      body = set.substr(1, set.size() - 2);
+      if (!body.empty() && body[0] == '^')
+      {
+         negate = true;
+         body = body.substr(1);
+      }
+   }
+
+   size_t pos = 0;
+   while (pos < body.size())
+   {
+      std::vector<bool> symbol_class(256, false);
+      int lo = parseSymbol(body, pos, &symbol_class);
+
+      if (lo >= 0 && pos + 1 < body.size() && body[pos] == '-')
+      {
+         ++pos;
+         int hi = parseSymbol(body, pos, &symbol_class);
+         LOG_ASSERT_ERROR(hi >= lo, "CAP: %s: invalid range in symbol-set %s", m_filename.c_str(), set.c_str());
+         for (int c = lo; c <= hi; ++c)
+            symbols[c] = true;
+      }
+      else if (lo >= 0)
+         symbols[lo] = true;
+
+      for (int c = 0; c < 256; ++c)
+         if (symbol_class[c])
+            symbols[c] = true;
+   }
+
+   if (negate)
+      symbols.flip();
+}
+
+// Returns the symbol at pos, or -1 if it was a class escape, whose symbols are set in symbol_class
+int
+CapAnmlLoader::parseSymbol(const std::string& set, size_t& pos, std::vector<bool>* symbol_class)
+{
+   if (set[pos] != '\\' || pos + 1 >= set.size())
+      return (unsigned char)set[pos++];
+
+   char c = set[pos + 1];
+   pos += 2;
+
+   if (c == 'x')
+   {
+      LOG_ASSERT_ERROR(pos + 2 <= set.size() && isxdigit(set[pos]) && isxdigit(set[pos + 1]), "CAP: %s: invalid \\x escape in symbol-set %s", m_filename.c_str(), set.c_str());
+      int value = strtoul(set.substr(pos, 2).c_str(), NULL, 16);
+      pos += 2;
+      return value;
+   }
+
+   char kind = tolower(c);
+   if (kind == 'd' || kind == 's' || kind == 'w')
+   {
+      // upper case is the complement of the class
+      bool negate = isupper(c);
+      for (int s = 0; s < 256; ++s)
+      {
+         bool in_class = (kind == 'd') ? (s >= '0' && s <= '9')
+                       : (kind == 's') ? (s == ' ' || (s >= 9 && s <= 13))
+                       : (isalnum(s) || s == '_');
+         if (in_class != negate)
+            (*symbol_class)[s] = true;
+      }
+      return -1;
+   }
+
+   switch (c)
+   {
+      case 'n': return '\n';
+      case 'r': return '\r';
+      case 't': return '\t';
+      case 'f': return '\f';
+      case 'v': return '\v';
+      case 'a': return '\a';
+      case 'e': return 27;
+      case '0': return 0;
+      default:  return (unsigned char)c;
+   }
+}
+
+void
+CapAnmlLoader::setBit(std::vector<Byte>& image, UInt64 byte_offset, UInt32 bit)
+{
+   image[byte_offset + bit / 8] |= 0x80 >> (bit % 8);
+}
+
+void
+CapAnmlLoader::buildImages()
+{
+   UInt32 num_stes = m_stes.size();
+   UInt32 ste_bytes = m_cap.steBytesPerSubarray();
+   UInt32 state_bytes = m_cap.stateBytes();
+   UInt32 dropped = 0, dangling = 0, edges = 0;
+
+   LOG_ASSERT_ERROR(num_stes <= m_cap.numStes(), "CAP: %s has %d STEs, the configured geometry only holds %d", m_filename.c_str(), num_stes, m_cap.numStes());
+
+   m_cache_image.assign((UInt64)m_cap.num_subarrays * m_cap.lines_per_subarray * ste_bytes, 0);
+   m_swizzle_image.assign((UInt64)m_cap.switch_rows * m_cap.switch_row_bytes, 0);
+   m_ste_image.assign(3 * state_bytes, 0);
+
+   for (UInt32 n = 0; n < num_stes; ++n)
+   {
+      const Ste& ste = m_stes[n];
+      UInt32 subarray = n / m_cap.stes_per_subarray;
+      UInt32 bit = n % m_cap.stes_per_subarray;
+
+      for (UInt32 c = 0; c < 256; ++c)
+         if (ste.symbols[c])
+            setBit(m_cache_image, ((UInt64)subarray * m_cap.lines_per_subarray + c) * ste_bytes, bit);
+
+      for (std::vector<std::string>::const_iterator it = ste.targets.begin(); it != ste.targets.end(); ++it)
+      {
+         // counter ports are written as id:cnt / id:rst
+         std::string target = it->substr(0, it->find(':'));
+         std::map<std::string, UInt32>::iterator dest = m_ste_index.find(target);
+         if (dest == m_ste_index.end())
+         {
+            if (m_counters.count(target))
+               ++dropped;
+            else
+               ++dangling;
+            continue;
+         }
+         setBit(m_swizzle_image, (UInt64)n * m_cap.switch_row_bytes, dest->second);
+         ++edges;
+      }
+
+      if (ste.start_of_data)
+         setBit(m_ste_image, 0, n);
+      if (ste.reporting)
+         setBit(m_ste_image, state_bytes, n);
+      if (ste.all_input)
+         setBit(m_ste_image, 2 * state_bytes, n);
+   }
+
+   if (dropped)
+      LOG_PRINT_WARNING("CAP: %s: counters are not supported, dropped %d edges into counters", m_filename.c_str(), dropped);
+   if (dangling)
+      LOG_PRINT_WARNING("CAP: %s: dropped %d edges into undefined elements", m_filename.c_str(), dangling);
+
+   printf("CAP: Loaded %s: %d STEs, %d edges\n", m_filename.c_str(), num_stes, edges);
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cap_parameters.h"
+#include "fixed_types.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ParametricDramDirectoryMSI
+{
+   // CAP: ANML front end, compiles an automaton straight into the CAP images
+   //
+   // Parses state-transition-element (symbol-set, start, activate-on-match,
+   // report-on-match) and or elements, and builds the images in the layout
+   // prog.pl writes, but unencoded (a 0 byte is a 0):
+   //  - cache image: num_subarrays x lines_per_subarray lines of
+   //    stes_per_subarray bits, line c of a subarray holds the STEs matching c
+   //  - swizzle switch: switch_rows rows of switch_row_bytes, row n holds the
+   //    STEs activated by STE n
+   //  - STE image: start-of-data mask, reporting mask and all-input mask
+   //
+   // STEs are numbered in document order. or elements do not consume a symbol:
+   // their predecessors activate the or's targets directly. A reporting or
+   // keeps a report-only STE (no symbols) its predecessors enable, as CAP
+   // reports on enabled STEs; other ors get no STE. Counters are not
+   // supported by CAP, edges into them are dropped with a warning.
+   class CapAnmlLoader
+   {
+      public:
+         CapAnmlLoader(const CapParameters& cap_params);
+
+         // Parses filename and builds the images, errors are fatal
+         void load(const String& filename);
+
+         std::vector<Byte>& getCacheImage() { return m_cache_image; }
+         std::vector<Byte>& getSwizzleImage() { return m_swizzle_image; }
+         std::vector<Byte>& getSteImage() { return m_ste_image; }
+         UInt32 getNumStes() const { return m_stes.size(); }
+
+      private:
+         struct Ste
+         {
+            std::string id;
+            std::vector<bool> symbols;      // 256 entries
+            std::vector<std::string> targets;
+            bool start_of_data;
+            bool all_input;
+            bool reporting;
+            bool is_or;
+         };
+
+         const CapParameters m_cap;
+         String m_filename;
+         std::vector<Ste> m_stes;
+         std::map<std::string, UInt32> m_ste_index;
+         std::map<std::string, bool> m_counters;
+
+         std::vector<Byte> m_cache_image;
+         std::vector<Byte> m_swizzle_image;
+         std::vector<Byte> m_ste_image;
+
+         void parse(const std::string& text);
+         void foldOrs();
+         void parseSymbolSet(const std::string& set, std::vector<bool>& symbols);
+         int parseSymbol(const std::string& set, size_t& pos, std::vector<bool>* symbol_class);
+         void buildImages();
+
+         static void setBit(std::vector<Byte>& image, UInt64 byte_offset, UInt32 bit);
+         static size_t findTagEnd(const std::string& text, size_t pos);
+         static std::string decodeEntities(const std::string& value);
+         static std::map<std::string, std::string> parseAttributes(const std::string& tag);
+   };
+}
@@ -0,0 +1,153 @@
+#include "cap_bitset.h"
+
+#include <cassert>
+#include <cstring>
+#include <immintrin.h>
+
+namespace CapBitset
+{
+
+static inline UInt64 loadWord(const Byte* p)
+{
+   UInt64 w;
+   memcpy(&w, p, sizeof(w));
+   return w;
+}
+
+static inline void storeWord(Byte* p, UInt64 w)
+{
+   memcpy(p, &w, sizeof(w));
+}
+
+static void orRowScalar(Byte* out, const Byte* row, UInt32 length)
+{
+   UInt32 i = 0;
+   for ( ; i + 8 <= length; i += 8)
+      storeWord(out + i, loadWord(out + i) | loadWord(row + i));
+   for ( ; i < length; ++i)
+      out[i] |= row[i];
+}
+
+static void orRowSSE2(Byte* out, const Byte* row, UInt32 length)
+{
+   UInt32 i = 0;
+   for ( ; i + 16 <= length; i += 16)
+   {
+      __m128i a = _mm_loadu_si128((const __m128i*)(out + i));
+      __m128i b = _mm_loadu_si128((const __m128i*)(row + i));
+      _mm_storeu_si128((__m128i*)(out + i), _mm_or_si128(a, b));
+   }
+   orRowScalar(out + i, row + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static void orRowAVX2(Byte* out, const Byte* row, UInt32 length)
+{
+   UInt32 i = 0;
+   for ( ; i + 32 <= length; i += 32)
+   {
+      __m256i a = _mm256_loadu_si256((const __m256i*)(out + i));
+      __m256i b = _mm256_loadu_si256((const __m256i*)(row + i));
+      _mm256_storeu_si256((__m256i*)(out + i), _mm256_or_si256(a, b));
+   }
+   orRowSSE2(out + i, row + i, length - i);
+}
+
+typedef void (*or_row_func_t)(Byte*, const Byte*, UInt32);
+
+static or_row_func_t selectOrRow(const char** name)
+{
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+   {
+      *name = "avx2";
+      return orRowAVX2;
+   }
+   if (__builtin_cpu_supports("sse2"))
+   {
+      *name = "sse2";
+      return orRowSSE2;
+   }
+   *name = "scalar";
+   return orRowScalar;
+}
+
+static const char* s_or_row_name = "scalar";
+static const or_row_func_t s_or_row = selectOrRow(&s_or_row_name);
+
+void orRow(Byte* out, const Byte* row, UInt32 length)
+{
+   s_or_row(out, row, length);
+}
+
+bool maskAnd(Byte* out, const Byte* a, const Byte* b, UInt32 length)
+{
+   UInt64 any = 0;
+   UInt32 i = 0;
+   for ( ; i + 8 <= length; i += 8)
+   {
+      UInt64 w = loadWord(a + i) & loadWord(b + i);
+      storeWord(out + i, w);
+      any |= w;
+   }
+   for ( ; i < length; ++i)
+   {
+      out[i] = a[i] & b[i];
+      any |= out[i];
+   }
+   return any != 0;
+}
+
+bool intersects(const Byte* a, const Byte* b, UInt32 length)
+{
+   UInt32 i = 0;
+   for ( ; i + 8 <= length; i += 8)
+      if (loadWord(a + i) & loadWord(b + i))
+         return true;
+   for ( ; i < length; ++i)
+      if (a[i] & b[i])
+         return true;
+   return false;
+}
+
+UInt32 nextState(const Byte* swizzle, UInt32 row_length, UInt32 num_rows,
+                 const Byte* active, Byte* next)
+{
+   UInt32 num_active = 0;
+
+   memset(next, 0, row_length);
+
+   for (UInt32 i = 0; i < row_length; i += 8)
+   {
+      UInt64 w;
+      if (i + 8 <= row_length)
+         w = loadWord(active + i);
+      else
+      {
+         w = 0;
+         memcpy(&w, active + i, row_length - i);
+      }
+
+      while (w)
+      {
+         // Little-endian load: word bit b is bit (b%8) of byte i+b/8,
+         // which prog.pl numbers as STE 8*(i+b/8) + 7-(b%8)
+         UInt32 b = __builtin_ctzll(w);
+         w &= w - 1;
+         UInt32 ste = 8 * (i + (b >> 3)) + 7 - (b & 7);
+         assert(ste < num_rows);
+
+         s_or_row(next, swizzle + (UInt64)ste * row_length, row_length);
+         ++num_active;
+      }
+   }
+
+   return num_active;
+}
+
+const char* isaString()
+{
+   return s_or_row_name;
+}
+
+}
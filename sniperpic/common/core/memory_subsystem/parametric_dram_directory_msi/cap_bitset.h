@@ -0,0 +1,34 @@
+#pragma once
+
+#include "fixed_types.h"
+
+// CAP: word-parallel helpers for the swizzle switch next-state lookup
+//
+// State vectors keep the byte layout produced by prog.pl: STE n lives in
+// byte n/8 at bit position 7-(n%8). The helpers view those bytes as 64-bit
+// words, so that inactive STEs are skipped a word at a time (find-first-set
+// on the active bits only) and next-state rows are OR-reduced with SSE2 or
+// AVX2, selected once at startup from the host CPU features.
+//
+// All functions are pure: they only touch the caller-owned buffers passed in
+// and never allocate, so they are safe to call on every input character.
+namespace CapBitset
+{
+   // out = a & b over length bytes, returns true if any bit of out is set
+   bool maskAnd(Byte* out, const Byte* a, const Byte* b, UInt32 length);
+
+   // Returns true if a & b has any bit set
+   bool intersects(const Byte* a, const Byte* b, UInt32 length);
+
+   // out |= row over length bytes
+   void orRow(Byte* out, const Byte* row, UInt32 length);
+
+   // Swizzle switch lookup: next = OR of the swizzle rows (row_length bytes
+   // each, num_rows in total) of every STE set in active (row_length bytes).
+   // Returns the number of active STEs that were looked up.
+   UInt32 nextState(const Byte* swizzle, UInt32 row_length, UInt32 num_rows,
+                    const Byte* active, Byte* next);
+
+   // Name of the OR-reduction kernel selected for this host
+   const char* isaString();
+}
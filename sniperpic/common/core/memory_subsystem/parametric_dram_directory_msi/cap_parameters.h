@@ -0,0 +1,64 @@
+#pragma once
+
+#include "fixed_types.h"
+#include "mem_component.h"
+#include "subsecond_time.h"
+#include "utils.h"
+#include "log.h"
+
+namespace ParametricDramDirectoryMSI
+{
+   // CAP: geometry of the automaton mapped onto the cache, from [perf_model/cap]
+   //
+   // Each subarray holds lines_per_subarray lines, one per input symbol, and each
+   // line holds the match bits of stes_per_subarray STEs. The swizzle switch has
+   // one row per current state STE (switch_rows) of switch_row_bytes next state
+   // bytes. Line l of subarray s lives at (s << (log2(lines) + log2(block))) | (l << log2(block)).
+   class CapParameters
+   {
+      public:
+         UInt32 num_subarrays;
+         UInt32 lines_per_subarray;
+         UInt32 stes_per_subarray;
+         UInt32 switch_rows;
+         UInt32 switch_row_bytes;
+         UInt32 cache_level;         // 1 = L1-D, 2 = L2, ...
+         UInt32 log_lines_per_subarray;
+         ComponentLatency context_switch_time;  // swap the current state vector of two input streams
+
+         CapParameters()
+            : num_subarrays(0), lines_per_subarray(0), stes_per_subarray(0)
+            , switch_rows(0), switch_row_bytes(0), cache_level(1), log_lines_per_subarray(0)
+            , context_switch_time(NULL,0)
+         {}
+         CapParameters(
+            UInt32 _num_subarrays, UInt32 _lines_per_subarray, UInt32 _stes_per_subarray,
+            UInt32 _switch_rows, UInt32 _switch_row_bytes, UInt32 _cache_level,
+            const ComponentLatency& _context_switch_time, UInt32 block_size)
+         :
+            num_subarrays(_num_subarrays), lines_per_subarray(_lines_per_subarray), stes_per_subarray(_stes_per_subarray),
+            switch_rows(_switch_rows), switch_row_bytes(_switch_row_bytes), cache_level(_cache_level),
+            context_switch_time(_context_switch_time)
+         {
+            log_lines_per_subarray = floorLog2(lines_per_subarray);
+            LOG_ASSERT_ERROR(num_subarrays > 0, "Invalid CAP configuration: num_subarrays must be non-zero");
+            LOG_ASSERT_ERROR(lines_per_subarray >= 256 && (1U << log_lines_per_subarray) == lines_per_subarray, "Invalid CAP configuration: lines_per_subarray(%d) must be a power of two >= 256 (one line per input symbol)", lines_per_subarray);
+            LOG_ASSERT_ERROR(stes_per_subarray > 0 && stes_per_subarray % 8 == 0 && stes_per_subarray <= 8 * block_size, "Invalid CAP configuration: stes_per_subarray(%d) must be a non-zero multiple of 8 that fits a %d byte line", stes_per_subarray, block_size);
+            LOG_ASSERT_ERROR(switch_rows >= numStes(), "Invalid CAP configuration: switch_rows(%d) < num_subarrays * stes_per_subarray(%d)", switch_rows, numStes());
+            LOG_ASSERT_ERROR(switch_row_bytes >= stateBytes(), "Invalid CAP configuration: switch_row_bytes(%d) < state vector bytes(%d)", switch_row_bytes, stateBytes());
+            // every bit of a state vector may be looked up as a swizzle switch row (CapBitset::nextState)
+            LOG_ASSERT_ERROR(switch_rows >= 8 * switch_row_bytes, "Invalid CAP configuration: switch_rows(%d) < 8 * switch_row_bytes(%d), one row per state vector bit", switch_rows, switch_row_bytes);
+            LOG_ASSERT_ERROR(cache_level >= 1, "Invalid CAP configuration: cache_level must be >= 1");
+         }
+
+         UInt32 numStes() const { return num_subarrays * stes_per_subarray; }
+         // bytes of the current state vector read from one subarray, and from all of them
+         UInt32 steBytesPerSubarray() const { return stes_per_subarray / 8; }
+         UInt32 stateBytes() const { return numStes() / 8; }
+         // cache controller running the CAP ops, the L1-I is never used for CAP
+         MemComponent::component_t component() const
+         {
+            return cache_level > 1 ? (MemComponent::component_t)(MemComponent::L2_CACHE + cache_level - 2) : MemComponent::L1_DCACHE;
+         }
+   };
+}
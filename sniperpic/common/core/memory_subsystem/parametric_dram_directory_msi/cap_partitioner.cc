@@ -0,0 +1,99 @@
+#include "cap_partitioner.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CapPartitioner
+{
+
+static UInt32 findRoot(std::vector<UInt32>& parent, UInt32 ste)
+{
+   while (parent[ste] != ste)
+   {
+      parent[ste] = parent[parent[ste]];
+      ste = parent[ste];
+   }
+   return ste;
+}
+
+static bool bySizeDescending(const std::pair<UInt32, UInt32>& a, const std::pair<UInt32, UInt32>& b)
+{
+   // (size, root), ties broken on the root to keep the placement deterministic
+   return a.first != b.first ? a.first > b.first : a.second < b.second;
+}
+
+UInt32 partition(const Byte* swizzle, UInt32 row_bytes, UInt32 num_rows,
+                 UInt32 num_stes, UInt32 num_partitions,
+                 std::vector<UInt32>& partition_of_ste)
+{
+   std::vector<UInt32> parent(num_stes);
+   for (UInt32 ste = 0; ste < num_stes; ++ste)
+      parent[ste] = ste;
+
+   // Every set bit of row r is an edge from STE r to the STE it activates
+   UInt32 rows = std::min(num_rows, num_stes);
+   UInt32 bytes = std::min(row_bytes, (num_stes + 7) / 8);
+   for (UInt32 r = 0; r < rows; ++r)
+   {
+      const Byte* row = swizzle + (UInt64)r * row_bytes;
+      for (UInt32 i = 0; i < bytes; ++i)
+      {
+         if (!row[i])
+            continue;
+         for (UInt32 b = 0; b < 8; ++b)
+         {
+            UInt32 ste = 8 * i + b;
+            if (ste < num_stes && (row[i] & (0x80 >> b)))
+            {
+               UInt32 ra = findRoot(parent, r), rb = findRoot(parent, ste);
+               if (ra != rb)
+                  parent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+         }
+      }
+   }
+
+   std::vector<UInt32> size(num_stes, 0);
+   for (UInt32 ste = 0; ste < num_stes; ++ste)
+      ++size[findRoot(parent, ste)];
+
+   std::vector<std::pair<UInt32, UInt32> > components;
+   for (UInt32 ste = 0; ste < num_stes; ++ste)
+      if (size[ste])
+         components.push_back(std::make_pair(size[ste], ste));
+   std::sort(components.begin(), components.end(), bySizeDescending);
+
+   // Largest component first onto the least loaded partition
+   std::vector<UInt32> load(num_partitions, 0);
+   std::vector<UInt32> partition_of_root(num_stes, 0);
+   for (std::vector<std::pair<UInt32, UInt32> >::iterator it = components.begin(); it != components.end(); ++it)
+   {
+      UInt32 target = std::min_element(load.begin(), load.end()) - load.begin();
+      partition_of_root[it->second] = target;
+      load[target] += it->first;
+   }
+
+   partition_of_ste.resize(num_stes);
+   for (UInt32 ste = 0; ste < num_stes; ++ste)
+      partition_of_ste[ste] = partition_of_root[findRoot(parent, ste)];
+
+   return components.size();
+}
+
+UInt32 ownerMask(const std::vector<UInt32>& partition_of_ste, UInt32 partition,
+                 Byte* mask, UInt32 mask_bytes)
+{
+   UInt32 owned = 0;
+   memset(mask, 0, mask_bytes);
+   for (UInt32 ste = 0; ste < partition_of_ste.size() && ste < 8 * mask_bytes; ++ste)
+   {
+      if (partition_of_ste[ste] == partition)
+      {
+         mask[ste / 8] |= 0x80 >> (ste % 8);
+         ++owned;
+      }
+   }
+   return owned;
+}
+
+}
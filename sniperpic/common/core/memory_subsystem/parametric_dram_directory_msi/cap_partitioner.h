@@ -0,0 +1,28 @@
+#pragma once
+
+#include "fixed_types.h"
+
+#include <vector>
+
+// CAP: split an automaton over several CAP units (cores or LLC slices)
+//
+// STEs that can activate each other through the swizzle switch form a
+// connected component and must be matched by the same unit, as the next
+// state of an STE is only looked up in its own unit. Components are found
+// with a union-find over the swizzle switch rows and then placed, largest
+// first, on the least loaded partition. Every unit is then programmed with
+// the full images, masked down to the STEs it owns, and sees the whole input.
+namespace CapPartitioner
+{
+   // Assigns each of num_stes STEs to a partition in [0, num_partitions), given the
+   // swizzle switch image (num_rows rows of row_bytes bytes, prog.pl bit layout).
+   // Returns the number of connected components found.
+   UInt32 partition(const Byte* swizzle, UInt32 row_bytes, UInt32 num_rows,
+                    UInt32 num_stes, UInt32 num_partitions,
+                    std::vector<UInt32>& partition_of_ste);
+
+   // Builds the state vector mask (mask_bytes bytes) of the STEs owned by
+   // partition, returns the number of STEs it owns
+   UInt32 ownerMask(const std::vector<UInt32>& partition_of_ste, UInt32 partition,
+                    Byte* mask, UInt32 mask_bytes);
+}
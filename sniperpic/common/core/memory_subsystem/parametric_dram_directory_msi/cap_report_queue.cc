@@ -0,0 +1,65 @@
+#include "cap_report_queue.h"
+#include "log.h"
+
+#include <cstring>
+
+namespace ParametricDramDirectoryMSI
+{
+
+CapReportQueue::CapReportQueue(UInt32 size, const String& filename, core_id_t core_id)
+   : m_queue(size)
+   , m_filename(filename)
+   , m_core_id(core_id)
+   , m_file(NULL)
+   , m_drained(0)
+   , m_full_drains(0)
+{
+   LOG_ASSERT_ERROR(size > 0, "CAP: report queue size must be non-zero");
+}
+
+CapReportQueue::~CapReportQueue()
+{
+   drain();
+   if (m_file)
+      fclose(m_file);
+}
+
+// The file is only created once there is something to write
+void
+CapReportQueue::open()
+{
+   m_file = fopen(m_filename.c_str(), "wb");
+   LOG_ASSERT_ERROR(m_file != NULL, "CAP: Could not open report file %s", m_filename.c_str());
+
+   CapReportFileHeader header;
+   memcpy(header.magic, "CAPR", 4);
+   header.version = 1;
+   header.record_size = sizeof(CapReport);
+   header.core_id = m_core_id;
+   fwrite(&header, sizeof(header), 1, m_file);
+}
+
+UInt64
+CapReportQueue::drain()
+{
+   ScopedLock sl(m_drain_lock);
+   UInt64 count = 0;
+
+   if (!m_queue.empty() && !m_filename.empty() && !m_file)
+      open();
+
+   while (!m_queue.empty())
+   {
+      if (m_file)
+         fwrite(&m_queue.front(), sizeof(CapReport), 1, m_file);
+      m_queue.pop();
+      ++count;
+   }
+   if (m_file && count)
+      fflush(m_file);
+
+   m_drained += count;
+   return count;
+}
+
+}
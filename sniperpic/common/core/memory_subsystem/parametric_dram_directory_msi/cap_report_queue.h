@@ -0,0 +1,68 @@
+#pragma once
+
+#include "fixed_types.h"
+#include "circular_queue.h"
+#include "lock.h"
+
+#include <cstdio>
+
+namespace ParametricDramDirectoryMSI
+{
+   // CAP: one report event, a reporting STE enabled by the symbol at offset of stream
+   struct CapReport
+   {
+      UInt64 offset;    // symbol offset within the input stream
+      UInt64 cycle;     // core cycle the symbol was matched in
+      UInt32 ste;       // reporting STE id
+      UInt32 stream;    // input stream id
+   };
+
+   // CAP: bounded report queue between the matcher and the report file
+   //
+   // The matcher pushes without locking (CircularQueue is safe for a single
+   // producer and a single consumer). Reports are drained to a binary file:
+   // a CapReportFileHeader followed by raw CapReport records. A full queue is
+   // drained by the producer itself, so no report is ever dropped. Without a
+   // file name reports are only counted.
+   class CapReportQueue
+   {
+      public:
+         struct CapReportFileHeader
+         {
+            char magic[4];          // "CAPR"
+            UInt32 version;
+            UInt32 record_size;     // sizeof(CapReport)
+            UInt32 core_id;
+         };
+
+         CapReportQueue(UInt32 size, const String& filename, core_id_t core_id);
+         ~CapReportQueue();
+
+         void push(const CapReport& report)
+         {
+            if (m_queue.full())
+            {
+               drain();
+               ++m_full_drains;
+            }
+            m_queue.push(report);
+         }
+
+         // Writes all queued reports out, returns the number written
+         UInt64 drain();
+
+         UInt64 getNumDrained() const { return m_drained; }
+         UInt64 getNumFullDrains() const { return m_full_drains; }
+
+      private:
+         CircularQueue<CapReport> m_queue;
+         Lock m_drain_lock;
+         String m_filename;
+         core_id_t m_core_id;
+         FILE* m_file;
+         UInt64 m_drained;
+         UInt64 m_full_drains;
+
+         void open();
+   };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "circular_log.h"
+
+// CAP/PIC trace points for the per-symbol and per-access hot paths
+//
+// CAP_TRACE(type, msg, ...) records a binary event in the circular log (enabled
+// at run time with log/circular_log = true, formatted into sim.clog at the end).
+// Only the format string pointer and up to six 64-bit arguments are stored, so
+// arguments must be integers cast to UInt64 (printed with %lu/%lx) or
+// string constants.
+//
+// Trace points are compiled in only with CAP_TRACE_ENABLED (make CAP_TRACE=1);
+// otherwise they compile to nothing and the arguments are never evaluated.
+#ifndef CAP_TRACE_ENABLED
+#define CAP_TRACE_ENABLED 0
+#endif
+
+#if CAP_TRACE_ENABLED
+#  define CAP_TRACE(type, msg, ...) CLOG(type, msg, __VA_ARGS__)
+#else
+#  define CAP_TRACE(type, msg, ...) do {} while(0)
+#endif
@@ -13,11 +13,15 @@
 #include "config.hpp"
 #include "distribution.h"
 #include "topology_info.h"
+#include "cap_partitioner.h"
+#include "cap_anml_loader.h"
+#include "cap_trace.h"
 
 //#ifdef PIC_IS_MICROBENCH
 	#include "micro_op.h"
 //#endif
 #include <algorithm>
+#include <cstdlib>
 
 #define CAP_ROB_DRAIN
 
@@ -34,6 +38,9 @@ namespace ParametricDramDirectoryMSI
 {
 
 std::map<CoreComponentType, CacheCntlr*> MemoryManager::m_all_cache_cntlrs;
+Lock MemoryManager::s_cap_merge_lock;
+UInt32 MemoryManager::s_cap_partitions_done = 0;
+UInt64 MemoryManager::s_cap_merged_matches = 0;
 
 MemoryManager::MemoryManager(Core* core,
       Network* network, ShmemPerfModel* shmem_perf_model):
@@ -48,6 +55,7 @@ MemoryManager::MemoryManager(Core* core,
    m_ss_program_time(NULL,0),
    m_tag_directory_present(false),
    m_dram_cntlr_present(false),
+   m_access_buf(NULL),
    m_enabled(false),
    m_min_dummy_inst(0)
 {
@@ -73,6 +81,7 @@ MemoryManager::MemoryManager(Core* core,
    try
    {
       m_cache_block_size = Sim()->getCfg()->getInt("perf_model/l1_icache/cache_block_size");
+      m_access_buf = new Byte[m_cache_block_size];
 
       m_min_dummy_inst = Sim()->getCfg()->getIntArray("perf_model/core/interval_timer/dispatch_width", core->getId());
 
@@ -151,7 +160,10 @@ MemoryManager::MemoryManager(Core* core,
                : 0,
             i == MemComponent::L1_DCACHE
                ? Sim()->getCfg()->getIntArray(   "perf_model/" + configName + "/pic_outstanding", core->getId())
-               : 0
+               : 0,
+            Sim()->getCfg()->hasKey(            "perf_model/" + configName + "/banks")
+               ? Sim()->getCfg()->getIntArray(   "perf_model/" + configName + "/banks", core->getId())
+               : 1
          );
          cache_names[(MemComponent::component_t)i] = objectName;
 
@@ -175,7 +187,10 @@ MemoryManager::MemoryManager(Core* core,
             false, true,
             ComponentLatency(global_domain, Sim()->getCfg()->getIntArray("perf_model/nuca/data_access_time", core->getId())),
             ComponentLatency(global_domain, Sim()->getCfg()->getIntArray("perf_model/nuca/tags_access_time", core->getId())),
-            ComponentLatency(global_domain, 0), ComponentBandwidthPerCycle(global_domain, 0), "", false, 0, "", 0, 0 // unused
+            ComponentLatency(global_domain, 0), ComponentBandwidthPerCycle(global_domain, 0), "", false, 0, "", 0, 0, // unused
+            Sim()->getCfg()->hasKey(            "perf_model/nuca/banks")
+               ? Sim()->getCfg()->getIntArray(   "perf_model/nuca/banks", core->getId())
+               : 1
          );
       }
 
@@ -287,6 +302,37 @@ MemoryManager::MemoryManager(Core* core,
       }
    }
 
+   //CAP: constructor changes
+   m_cap_on = Sim()->getCfg()->getBool("general/cap_on");
+   m_cap_match_seq = 0;
+   m_cap_stream_chunk_size = 0;
+   m_cap_partitions = 1;
+   m_cap_partition = 0;
+   m_cap_participates = false;
+   if(m_cap_on) {
+      m_cap_stream_chunk_size = Sim()->getCfg()->getInt("perf_model/cap/stream_chunk_size");
+      LOG_ASSERT_ERROR(m_cap_stream_chunk_size > 0, "perf_model/cap/stream_chunk_size must be non-zero");
+
+      m_cap_params = CapParameters(
+         Sim()->getCfg()->getInt("perf_model/cap/num_subarrays"),
+         Sim()->getCfg()->getInt("perf_model/cap/lines_per_subarray"),
+         Sim()->getCfg()->getInt("perf_model/cap/stes_per_subarray"),
+         Sim()->getCfg()->getInt("perf_model/cap/switch_rows"),
+         Sim()->getCfg()->getInt("perf_model/cap/switch_row_bytes"),
+         Sim()->getCfg()->getInt("perf_model/cap/cache_level"),
+         ComponentLatency(core->getDvfsDomain(), Sim()->getCfg()->getInt("perf_model/cap/context_switch_time")),
+         getCacheBlockSize());
+      LOG_ASSERT_ERROR(m_cap_params.component() <= m_last_level_cache, "perf_model/cap/cache_level(%d) is beyond the last level cache", m_cap_params.cache_level);
+
+      // One partition per CAP unit: every core for a private level, the master core of each slice for a shared one
+      m_cap_partitions = Sim()->getCfg()->getInt("perf_model/cap/partitions");
+      UInt32 cap_shared_cores = cache_parameters[m_cap_params.component()].shared_cores;
+      m_cap_partition = getCore()->getId() / cap_shared_cores;
+      m_cap_participates = (getCore()->getId() % cap_shared_cores == 0) && (m_cap_partition < m_cap_partitions);
+      LOG_ASSERT_ERROR(m_cap_partitions >= 1, "perf_model/cap/partitions must be at least 1");
+   }
+   m_cap_component = m_cap_params.component();
+
    for(UInt32 i = MemComponent::FIRST_LEVEL_CACHE; i <= (UInt32)m_last_level_cache; ++i) {
       CacheCntlr* cache_cntlr = new CacheCntlr(
          (MemComponent::component_t)i,
@@ -299,6 +345,7 @@ MemoryManager::MemoryManager(Core* core,
          getCacheBlockSize(),
          m_ss_program_time,
          cache_parameters[(MemComponent::component_t)i],
+         m_cap_params,
          getShmemPerfModel(),
          i == (UInt32)m_last_level_cache
       );
@@ -391,8 +438,6 @@ MemoryManager::MemoryManager(Core* core,
    //Cap operations
    Sim()->getHooksManager()->registerHook(HookType::HOOK_MAGIC_MARKER, MemoryManager::hookProcessAppMagic, (UInt64)this, HooksManager::ORDER_NOTIFY_PRE);
 
-   //CAP: constructor changes
-   m_cap_on = Sim()->getCfg()->getBool("general/cap_on");
    
 	
 		//#ifdef PIC_ENABLE_CHECKPOINT
@@ -404,7 +449,10 @@ MemoryManager::MemoryManager(Core* core,
 			m_is_checkpointing = false;
 			m_last_checkpoint_time = SubsecondTime::Zero(); 
 			m_last_chkpt_ins_cnt	= 0;
-			m_checkpointed_pages.clear();
+			m_chkpt_last_dirty_page	= 0;
+			m_chkpt_last_dirty_mask	= NULL;
+			m_chkpt_lines = m_chkpt_bytes = m_chkpt_interval_bytes_max = 0;
+			m_chkpt_ins_cnt = 0;
 			m_chkpt_load_inst_addr 	= 80;
 			m_chkpt_store_inst_addr 	= 96;
 			m_num_intervals = 0;
@@ -421,8 +469,18 @@ MemoryManager::MemoryManager(Core* core,
    			registerStatsMetric("mem-manager", m_core_id_master, "intervals", &m_num_intervals);
    			registerStatsMetric("mem-manager", m_core_id_master, "checkpoints", 
 																												&m_num_checkpoints);
+   			registerStatsMetric("mem-manager", m_core_id_master, "checkpoint-lines", 
+																												&m_chkpt_lines);
+   			registerStatsMetric("mem-manager", m_core_id_master, "checkpoint-bytes", 
+																												&m_chkpt_bytes);
+   			registerStatsMetric("mem-manager", m_core_id_master, "checkpoint-interval-bytes-max", 
+																												&m_chkpt_interval_bytes_max);
+				LOG_ASSERT_ERROR(getCacheBlockSize() == 64 
+					&& (CHKPT_PAGE_SIZE / 64) <= sizeof(chkpt_line_mask_t) * 8,
+					"PIC: checkpoint dirty-line masks need 64B lines in a 4KB page");
 			}
 		//#endif
+		m_synthetic_ins.registerStats(m_core_id_master);
 
 		m_pic_on = Sim()->getCfg()->getBool("general/pic_on");
 		if(m_pic_on) {
@@ -433,13 +491,18 @@ MemoryManager::MemoryManager(Core* core,
 		m_microbench_run	= Sim()->getCfg()->getBool("general/microbench_run");
 		if(m_microbench_run) {
 			m_microbench_type	= Sim()->getCfg()->getInt("general/microbench_type");
+    	m_microbench_opsize	
+												= Sim()->getCfg()->getInt("general/microbench_opsize");
+			if(m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+				init_microbench_kernel();
+			}
+			else {
 			//TODO:TADD: how do these calculations change for LOGICAL/BMM
 			m_microbench_loopsize	
 												= Sim()->getCfg()->getInt("general/microbench_loopsize");
-    	m_microbench_opsize	
-												= Sim()->getCfg()->getInt("general/microbench_opsize");
     	m_microbench_totalsize	
 											= Sim()->getCfg()->getInt("general/microbench_totalsize");
+			}
     	m_microbench_outer_loops
 											= Sim()->getCfg()->getInt("general/microbench_outer_loops");
 			assert(m_microbench_outer_loops);
@@ -461,6 +524,10 @@ MemoryManager::MemoryManager(Core* core,
 
 			m_mbench_src_addr		= 8388608;		//need to be same across runs
 			m_mbench_dest_addr	= m_mbench_src_addr + m_microbench_totalsize;
+			if(m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+				m_mbench_dest_addr	= m_mbench_src_addr + m_mbench_kernel.operand_distance;
+				m_mbench_kernel.matrix_addr	= m_mbench_src_addr + 2 * m_mbench_kernel.operand_distance;
+			}
 			if(m_microbench_type == PIC_IS_MICROBENCH_BMM) {
 				m_mbench_src2_addr	= m_mbench_src_addr 	+ m_microbench_totalsize;
 				m_mbench_dest_addr	= m_mbench_src2_addr 	+ m_microbench_totalsize;		
@@ -490,6 +557,7 @@ MemoryManager::MemoryManager(Core* core,
 		m_app_key_addr 					= 4096;
 		m_app_data_addr 				= 0;
 		m_wc_cam_size	= Sim()->getCfg()->getInt("general/wc_cam_size");
+		m_pic_result.mask = m_pic_result.hits = m_pic_result.ops = 0;
 		//End- pic-apps
 }
 
@@ -514,6 +582,33 @@ void MemoryManager::processAppMagic(UInt64 argument) {
 				//printf("\nIN(%u,%u)", array[0], array[1]);
 				init_wordcount(array[0], array[1]);
 			}
+			//PIC: arg0 points to {address, buffer ptr, length}, puts the bytes
+			//in the simulated lines so the PIC ops on them compute on real data
+  		if (marker.compare("picwr") == 0) {
+				UInt64 * array = (UInt64*) (args_in->arg0);
+				init_pic_write(array[0], (Byte*) (array[1]), array[2]);
+			}
+			//PIC: arg0 points to {address, buffer ptr, length}, reads the lines back
+  		if (marker.compare("picrd") == 0) {
+				UInt64 * array = (UInt64*) (args_in->arg0);
+				init_pic_read(array[0], (Byte*) (array[1]), array[2]);
+			}
+			//PIC: arg0 points to {mask, hits, ops}, filled in once the queued
+			//PIC ops are done. The result is reset for the next batch.
+  		if (marker.compare("picres") == 0) {
+				UInt64 * array = (UInt64*) (args_in->arg0);
+				getCore()->getPerformanceModel()->iterate();
+				array[0] = m_pic_result.mask;
+				array[1] = m_pic_result.hits;
+				array[2] = m_pic_result.ops;
+				m_pic_result.mask = m_pic_result.hits = m_pic_result.ops = 0;
+			}
+		}
+	}
+
+	//CAP: every CAP unit taking part in matching handles the CAP markers issued on its own core
+	if(m_cap_on && m_cap_participates && args_in->core_id == getCore()->getId() && args_in->str != NULL) {
+		std::string marker (args_in->str);
       //CAP: initial cache program
       if (marker.compare("cprg") == 0) {
         Byte * cap_pgm_file = (Byte*) (args_in-> arg0);
@@ -531,37 +626,119 @@ void MemoryManager::processAppMagic(UInt64 argument) {
         printf("CAP: Mem manager - Swizzle Switch pgm file ptr :0x%p, content: %d", ss_pgm_file, *(ss_pgm_file+3));
         init_ssprogram(ss_pgm_file);
       }  
+      //CAP: legacy input, a single line ending in '\n'
       if(marker.compare("match") == 0) {
         Byte * match_file =  (Byte*) (args_in-> arg0);
         printf("CAP: Mem manager - Input stream file ptr :0x%p, content: %d", match_file, *(match_file+3));
-        init_pattern_match(match_file);
+        UInt64 length = 0;
+        while ((char)(match_file[length]) != '\n')
+          ++length;
+        init_pattern_match(match_file, length, 0);
+        init_pattern_end();
       }        
-		}
+      //CAP: streaming input, arg0 points to {buffer ptr, length in bytes, stream id}.
+      //Calls for different stream ids may be interleaved, each stream keeps its own state.
+      if(marker.compare("mstream") == 0) {
+        UInt64 * array = (UInt64*) (args_in-> arg0);
+        Byte * match_file = (Byte*) (array[0]);
+        CAP_TRACE("cap", "input stream %lu ptr 0x%lx length %lu", array[2], (UInt64)match_file, array[1]);
+        init_pattern_match(match_file, array[1], (UInt32)array[2]);
+      }
+      //CAP: end of one input stream, arg0 is the stream id
+      if(marker.compare("mstreamend") == 0) {
+        init_stream_end((UInt32)args_in->arg0);
+      }
+      //CAP: end of all input streams
+      if(marker.compare("mend") == 0) {
+        init_pattern_end();
+      }
+      //CAP: program the automaton from an ANML file, in place of ssprg/cprg/repSte.
+      //arg0 is the path, or 0 to use perf_model/cap/anml_file
+      if(marker.compare("anml") == 0) {
+        String anml_file = args_in->arg0 ? String((const char*) (args_in->arg0)) : Sim()->getCfg()->getString("perf_model/cap/anml_file");
+        LOG_ASSERT_ERROR(!anml_file.empty(), "CAP: anml marker without a file and perf_model/cap/anml_file is not set");
+        init_anml(anml_file);
+      }
 	}
 }
 
 //CAP: Storing the STE-mapped FSMs into the cache 
 void  MemoryManager::init_cacheprogram(Byte* cap_file) {
-  create_cache_program_instructions(cap_file);
+  create_cap_program_instruction(CacheCntlr::CAP_PROGRAM, cap_file, m_cap_params.num_subarrays * m_cap_params.lines_per_subarray * m_cap_params.steBytesPerSubarray());
   schedule_cap_instructions();
 } 
 
 //CAP: Programming the SS in the Cache Ctlr
+//With several partitions, the swizzle switch image decides which STEs this
+//CAP unit owns, so it has to be programmed before the cache and STE masks.
 void  MemoryManager::init_ssprogram(Byte* ss_file) {
-  create_cap_ss_instructions(ss_file);
+  Byte* image = create_cap_program_instruction(CacheCntlr::CAP_SS, ss_file, m_cap_params.switch_rows * m_cap_params.switch_row_bytes);
+  compute_cap_partition(image);
   schedule_cap_instructions();
 } 
 
+//CAP: Work out the STEs owned by this CAP unit from the decoded swizzle switch image
+void  MemoryManager::compute_cap_partition(const Byte* ss_image) {
+  if (m_cap_partitions <= 1)
+    return;
+
+  std::vector<UInt32> partition_of_ste;
+  UInt32 components = CapPartitioner::partition(ss_image, m_cap_params.switch_row_bytes, m_cap_params.switch_rows,
+                                                m_cap_params.numStes(), m_cap_partitions, partition_of_ste);
+  m_cap_partition_mask.resize(m_cap_params.stateBytes());
+  UInt32 owned = CapPartitioner::ownerMask(partition_of_ste, m_cap_partition, &m_cap_partition_mask[0], m_cap_partition_mask.size());
+  printf("CAP: partition %d of %d owns %d STEs (%d components in total)\n", m_cap_partition, m_cap_partitions, owned, components);
+}
+
+//CAP: Compile an ANML automaton and program it, swizzle switch first so that
+//the partition is known before the cache image and STE masks are masked.
+//The STE image also carries the all-input mask.
+void  MemoryManager::init_anml(const String& anml_file) {
+  CapAnmlLoader loader(m_cap_params);
+  loader.load(anml_file);
+
+  Byte* image = create_cap_program_instruction(CacheCntlr::CAP_SS, &loader.getSwizzleImage()[0], loader.getSwizzleImage().size(), false);
+  compute_cap_partition(image);
+  schedule_cap_instructions();
+
+  create_cap_program_instruction(CacheCntlr::CAP_PROGRAM, &loader.getCacheImage()[0], loader.getCacheImage().size(), false);
+  schedule_cap_instructions();
+
+  create_cap_program_instruction(CacheCntlr::CAP_REP_STE, &loader.getSteImage()[0], loader.getSteImage().size(), false);
+  schedule_cap_instructions();
+}
+
 //CAP: Providing patterns to the cache to be matched 
-void  MemoryManager::init_pattern_match(Byte* match_file) {
-  create_cap_match_instructions(match_file);
+//The input is streamed through the matcher in chunks of stream_chunk_size bytes.
+//Each chunk becomes one synthetic store queued ahead of the magic instruction,
+//and is queued as soon as it is created: only the chunks still in the
+//performance model's queues hold a copy of their input. This relies on the
+//queues' backpressure, a push into a full queue first models what is queued.
+void  MemoryManager::init_pattern_match(Byte* match_file, UInt64 length, UInt32 stream_id) {
+  for (UInt64 pos = 0; pos < length; pos += m_cap_stream_chunk_size) {
+    UInt32 chunk = (UInt32)std::min((UInt64)m_cap_stream_chunk_size, length - pos);
+    create_cap_match_instruction(CacheCntlr::CAP_MATCH, match_file + pos, chunk, stream_id);
+    schedule_cap_instructions();
+  }
+}
+
+//CAP: Tag the end of the input and drain the ROB so that it is reached
+void  MemoryManager::init_pattern_end() {
+  create_cap_match_instruction(CacheCntlr::CAP_END, NULL, 0, 0);
   schedule_cap_instructions();
   create_schedule_dummy_instructions();
 }
 
-//CAP: Providing patterns to the cache to be matched 
+//CAP: Tag the end of one input stream, its context is released once the
+//chunks queued before it have been matched
+void  MemoryManager::init_stream_end(UInt32 stream_id) {
+  create_cap_match_instruction(CacheCntlr::CAP_STREAM_END, NULL, 0, stream_id);
+  schedule_cap_instructions();
+}
+
+//CAP: Programming the start state mask and the reporting STEs
 void  MemoryManager::init_rep_ste_program(Byte* ste_file) {
-  create_cap_rep_ste_instructions(ste_file);
+  create_cap_program_instruction(CacheCntlr::CAP_REP_STE, ste_file, 2 * m_cap_params.stateBytes());
   schedule_cap_instructions();
 }
 
@@ -608,6 +785,52 @@ void  MemoryManager::init_wordcount(UInt64 cam_id, UInt64 num_words) {
 		m_app_key_addr = (m_app_key_addr > (4096 + (4096 * 8))) ? 4096 : m_app_key_addr;
 }
 
+//PIC: The store is made at the L1 like any core store (not timed, as for the
+//CAP images), then the copies of the lines in the other levels are updated
+void  MemoryManager::init_pic_write(IntPtr address, Byte* data_buf, UInt64 length) {
+  SubsecondTime t_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+	UInt64 done = 0;
+	while(done < length) {
+		IntPtr addr 	= address + done;
+		IntPtr line 	= addr & ~((IntPtr)m_cache_block_size - 1);
+		UInt32 offset	= addr - line;
+		UInt32 size 	= std::min((UInt64)(m_cache_block_size - offset), length - done);
+
+		m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
+			Core::NONE, Core::WRITE, line, offset, data_buf + done, size, false, false);
+		for(UInt32 i = MemComponent::L2_CACHE; i <= (UInt32)m_last_level_cache; ++i)
+			m_cache_cntlrs[i]->picWriteLine(line, offset, data_buf + done, size);
+		done += size;
+	}
+  getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_start);
+	if (DEBUG_ENABLED) printf("\nPIC: wrote %lu bytes at %lx", length, address);
+}
+
+//PIC: Lines are read from the closest level holding them, zeros if none does
+void  MemoryManager::init_pic_read(IntPtr address, Byte* data_buf, UInt64 length) {
+	UInt64 done = 0;
+	while(done < length) {
+		IntPtr addr 	= address + done;
+		IntPtr line 	= addr & ~((IntPtr)m_cache_block_size - 1);
+		UInt32 offset	= addr - line;
+		UInt32 size 	= std::min((UInt64)(m_cache_block_size - offset), length - done);
+
+		for(UInt32 i = MemComponent::L1_DCACHE; i <= (UInt32)m_last_level_cache; ++i)
+			if(m_cache_cntlrs[i]->picReadLine(line, offset, data_buf + done, size))
+				break;
+		done += size;
+	}
+}
+
+void  MemoryManager::recordPicResult(CacheCntlr::pic_ops_t op, UInt64 mask, bool matched) {
+	if(op == CacheCntlr::PIC_CMP || op == CacheCntlr::PIC_SEARCH) {
+		m_pic_result.mask = mask;
+		if(matched)
+			m_pic_result.hits |= (1UL << (m_pic_result.ops % 64));
+	}
+	++m_pic_result.ops;
+}
+
 void  MemoryManager::create_app_search_instructions_stash(
 	IntPtr max_search_size, int word_size, int key_count, bool is_strcmp) {
 	int total_pairs = 0;
@@ -631,111 +854,30 @@ void  MemoryManager::create_app_search_instructions_stash(
 		int pairs_created = 0;
 		while(pairs_created < total_pairs) {
 			int words_done = 0;
-			OperandList load_list;
-			int search_reg	= m_app_regs[0];
-			m_app_regs.erase(m_app_regs.begin());
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list.push_back(Operand(Operand::REG, search_reg, Operand::WRITE, 
-																													"", true));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		load_inst->setAddress(m_app_search_inst_addr);
-      if (DEBUG_ENABLED)  printf("\n OMG look the inst addr is %lu and the load inst addr is %lu", m_app_search_inst_addr, load_inst->getAddress());
-  		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst->setAtomic(false);
-  		load_inst->setDisassembly("");
-  		std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-  		MicroOp *currentLMicroOp = new MicroOp();
-  		currentLMicroOp->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , 8
-  		 );
-			currentLMicroOp->addDestinationRegister((xed_reg_enum_t)search_reg, ""); 
-  		currentLMicroOp->setOperandSize(64); 
-  		currentLMicroOp->setInstruction(load_inst);
-  		currentLMicroOp->setFirst(true);
-  		currentLMicroOp->setLast(true);
-  		load_uops->push_back(currentLMicroOp);
-  		load_inst->setMicroOps(load_uops);
-			m_app_search_ins_stash.push_back(load_inst);
+			int search_reg	= m_app_regs.front();
+			m_app_regs.pop_front();
+			m_app_search_ins_stash.push_back(
+				m_synthetic_ins.getLoad(m_app_search_inst_addr, search_reg, 8));
 
 			while(words_done < words_per_search) {
-				OperandList mask_list;
 				int mask_reg;
 				if (!is_strcmp) {
-					mask_reg	= m_app_regs[0];
-					m_app_regs.erase(m_app_regs.begin());
+					mask_reg	= m_app_regs.front();
+					m_app_regs.pop_front();
 					m_app_regs.push_back(mask_reg);
-					mask_list.push_back(Operand(Operand::REG, search_reg, Operand::READ,
-																															"", true));
-  				mask_list.push_back(Operand(Operand::REG, mask_reg, Operand::READ, 
-																															"", true));
-  				mask_list.push_back(Operand(Operand::REG, mask_reg, Operand::WRITE, 
-																															"", true));
-  				Instruction *mask_inst 	= new GenericInstruction(mask_list);
-					mask_inst->setAddress(m_app_mask_inst_addr);
-					mask_inst->setSize(4);
-					mask_inst->setAtomic(false);
-					mask_inst->setDisassembly("");
-					std::vector<const MicroOp *> *mask_uops
-															= new std::vector<const MicroOp*>();;
-  				MicroOp *currentMMicroOp 	= new MicroOp();
-  				currentMMicroOp->makeExecute(
-  					0, 0
-  				  , XED_ICLASS_AND //TODO: xed_decoded_inst_get_iclass(ins)
-  				  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  				  , false	//not conditional branch
-  				 );
-  				currentMMicroOp->addSourceRegister((xed_reg_enum_t)search_reg, "");
-  				currentMMicroOp->addSourceRegister((xed_reg_enum_t)mask_reg, "");
-  				currentMMicroOp->addDestinationRegister((xed_reg_enum_t)mask_reg, "");
-  				currentMMicroOp->setOperandSize(64); 
-  				currentMMicroOp->setInstruction(mask_inst);
-  				currentMMicroOp->setFirst(true);
-  				currentMMicroOp->setLast(true);
-  				mask_uops->push_back(currentMMicroOp);
-  				mask_inst->setMicroOps(mask_uops);
-					m_app_maskcomp_ins_stash.push_back(mask_inst);
+					m_app_maskcomp_ins_stash.push_back(
+						m_synthetic_ins.getExecute(m_app_mask_inst_addr, XED_ICLASS_AND,
+							search_reg, mask_reg, mask_reg));
 				}
 				else 
 					mask_reg = search_reg;
 
-				OperandList comp_list;
-				int comp_reg	= m_app_regs[0];
-				m_app_regs.erase(m_app_regs.begin());
+				int comp_reg	= m_app_regs.front();
+				m_app_regs.pop_front();
 				m_app_regs.push_back(comp_reg);
-				comp_list.push_back(Operand(Operand::REG, mask_reg, Operand::READ,
-																														"", true));
-				comp_list.push_back(Operand(Operand::REG, comp_reg, Operand::READ,
-																														"", true));
-  			comp_list.push_back(Operand(Operand::REG, comp_reg, Operand::WRITE, 
-																													"", true));
-  			Instruction *comp_inst 	= new GenericInstruction(comp_list);
-				comp_inst->setAddress(m_app_comp_inst_addr);
-				comp_inst->setSize(4);
-				comp_inst->setAtomic(false);
-				comp_inst->setDisassembly("");
-				std::vector<const MicroOp *> *comp_uops
-														= new std::vector<const MicroOp*>();;
-  			MicroOp *currentCMicroOp 	= new MicroOp();
-  			currentCMicroOp->makeExecute(
-  				0, 0
-  			  , XED_ICLASS_CMP //TODO: xed_decoded_inst_get_iclass(ins)
-  			  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  			  , false	//not conditional branch
-  			 );
-  			currentCMicroOp->addSourceRegister((xed_reg_enum_t)mask_reg, "");
-  			currentCMicroOp->addSourceRegister((xed_reg_enum_t)comp_reg, "");
-  			currentCMicroOp->addDestinationRegister((xed_reg_enum_t)comp_reg, "");
-  			currentCMicroOp->setOperandSize(64); 
-  			currentCMicroOp->setInstruction(comp_inst);
-  			currentCMicroOp->setFirst(true);
-  			currentCMicroOp->setLast(true);
-  			comp_uops->push_back(currentCMicroOp);
-  			comp_inst->setMicroOps(comp_uops);
-				m_app_maskcomp_ins_stash.push_back(comp_inst);
+				m_app_maskcomp_ins_stash.push_back(
+					m_synthetic_ins.getExecute(m_app_comp_inst_addr, XED_ICLASS_CMP,
+						mask_reg, comp_reg, comp_reg));
 				words_done++;
 			}
 			m_app_regs.push_back(search_reg);
@@ -814,7 +956,7 @@ int  MemoryManager::create_app_search_instructions(
 				pii.is_vpic	= false;
 				pii.count		= 0;
 			}
-      picInsInfoVec.push_back(std::make_pair(m_app_key_addr,pii));
+			m_app_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii);
 			if(m_pic_use_vpic) {
 				app_data_addr	= app_data_addr +
 								(m_app_search_size < 512 ? m_app_search_size : 512);
@@ -851,19 +993,19 @@ void  MemoryManager::schedule_app_search_instructions(
 			(m_app_dyn_ins_info[0], true);
   	getCore()->getPerformanceModel()->queueInstruction(
 																		m_app_search_ins[0], true);
-		m_app_dyn_ins_info.erase(m_app_dyn_ins_info.begin());
-		m_app_search_ins.erase(m_app_search_ins.begin());
+		m_app_dyn_ins_info.pop_front();
+		m_app_search_ins.pop_front();
 		int words_scheduled = 0;
 		while(words_scheduled < words_per_search) {
 			if(!is_strcmp) {
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_app_maskcomp_ins[0], true);
-				m_app_maskcomp_ins.erase(m_app_maskcomp_ins.begin());
+				m_app_maskcomp_ins.pop_front();
 				mask_cmp_count += 1;
 			}
   		getCore()->getPerformanceModel()->queueInstruction(
 															m_app_maskcomp_ins[0], true);
-			m_app_maskcomp_ins.erase(m_app_maskcomp_ins.begin());
+			m_app_maskcomp_ins.pop_front();
 			mask_cmp_count += 1;
 			++words_scheduled;
 		}
@@ -875,275 +1017,70 @@ void  MemoryManager::schedule_app_search_instructions(
 }
 //End- pic-apps
 
-//CAP: Instruction Stash of stores for cache programming 
-//TBD: Que:What sizes to store in - what is the usual store protocol used for one Cache Line? 
-//TBD: Ans:Assumed a single cache line access 
-//TBD: Que:Conversion of ASCII to binary
-//TBD: Ans:Byte* usage
-//TBD: Que:How to extract and pass the right address to the store 
-//TBD: Ans: Done 
-//TBD: Que:How to read one line of that cap_file and initiate a store with the right operand
-//TBD: Ans:Using memcpy and temp_data_buf
-void  MemoryManager::create_cache_program_instructions(Byte* cap_file) {
-
-	unsigned int cur_subarray = 0;
-  unsigned int cur_cache_line = 0;
-  int i = 38;
-
-  if (DEBUG_ENABLED)  printf("the char version of %d is %c",i,(char)i);
-
-  UInt32 address;
-  IntPtr addr = (IntPtr)(address);
-
-  UInt32 block_size = getCacheBlockSize();
-  UInt32 subarray_size = CACHE_LINES_PER_SUBARRAY * getCacheBlockSize();
-  UInt32 m_log_blocksize = floorLog2(getCacheBlockSize());
-  UInt32 cache_subblocks = block_size/8;
-  Byte* temp_data_buf = new Byte;
-  
-  int cur_byte_pos;
-
-  //printf("CAP: create inst - Cache pgm file ptr :0x%p, content: %d", cap_file, *(cap_file+3));
-
-  if (DEBUG_ENABLED)  printf("\n CAP: Num_subarrays :%d, Cache lines/SA :%d, Blk size :%d\n",NUM_SUBARRAYS, CACHE_LINES_PER_SUBARRAY, block_size);
-
-  if(m_cap_ins.size() == 0) {
-    while(cur_subarray < NUM_SUBARRAYS) {
-      cur_cache_line = 0;
-      while(cur_cache_line < CACHE_LINES_PER_SUBARRAY) {
-        int sub_block = 0;
-       // while(sub_block < cache_subblocks) 
-          while(sub_block < block_size) {
-          // to prevent collision of this address, setting its 31st bit 
-          address = (1<<31) | (cur_subarray<<(8+m_log_blocksize)) | (cur_cache_line<<m_log_blocksize) | sub_block;  
-          cur_byte_pos = (cur_subarray * subarray_size) + (cur_cache_line * block_size) + sub_block;
-          memcpy(temp_data_buf, cap_file + cur_byte_pos, 1); 
-          if(*temp_data_buf == 199) *temp_data_buf = 0;
-          if (DEBUG_ENABLED)  printf("create_cache_program_instructions writing!!! addr: 0x%x  data: %d\n", address, *temp_data_buf);
-          addr = (IntPtr)(address);
-          //printf("Address: 0x%x, Value: %d\n", address, (unsigned long)*temp_data_buf);
-          OperandList store_list;
-          store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-          store_list.push_back(Operand(Operand::REG, (unsigned long)(*temp_data_buf), Operand::READ, "", true));
-          Instruction *store_inst = new GenericInstruction(store_list);
-          store_inst->setAddress(m_mbench_dest_addr); //TODO: To check where inst addr is used
-          store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-          store_inst->setAtomic(false);
-          store_inst->setDisassembly("");
-          std::vector<const MicroOp *> *store_uops 
-                                  = new std::vector<const MicroOp*>();
-          MicroOp *currentSMicroOp = new MicroOp();
-          currentSMicroOp->setInstructionPointer(Memory::make_access(m_mbench_dest_addr));
-          currentSMicroOp->makeStore(
-            0
-            , 0
-            , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-            , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-            , 1
-           );
-          currentSMicroOp->setOperandSize(64); 
-          currentSMicroOp->setInstruction(store_inst);
-          currentSMicroOp->setFirst(true);
-          currentSMicroOp->setLast(true);
-          store_uops->push_back(currentSMicroOp);
-          store_inst->setMicroOps(store_uops);
-          m_cap_ins.push_back(store_inst);
-          sub_block++;
-
-          //CAP: Dynamic Instructions Info creation
-          DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
-			                                true, //False if instruction will not be executed because of predication
-			                                SubsecondTime::Zero(), addr, 8, Operand::WRITE, 0, 
-			                                HitWhere::UNKNOWN);
-		      m_cap_dyn_ins_info.push_back(sinfo);
-          // TODO: FIXME: What the hell is this?
-
-          struct CAPInsInfo cii;
-          cii.addr	= addr;
-          cii.op		= CacheCntlr::CAP_NONE;	
-          cii.cap_data_buf = new Byte;
-          memcpy(cii.cap_data_buf, temp_data_buf, 1);  // copy 1 byte of data
-          capInsInfoMap[addr] 	= cii;
-       } 
-       cur_cache_line++;
-      }
-      cur_subarray++;
-    }  
-  }
-}  
-
-//NOTE: Representing Byte value of 0 with $ - symbol/char representation of 36. 
-//NOTE: ASSUMPTION: The first section of the rep ste file has the start state mask and 
-//the second section has the reporting STE mask. The following function reads the file
-//this way.
-void  MemoryManager::create_cap_rep_ste_instructions(Byte* ste_file) {
-  UInt32 cur_subarray = 0;
-
-  UInt32 address;
-  IntPtr addr = (IntPtr)(address);
-
-  UInt32 block_size = getCacheBlockSize();
-  UInt32 subarray_size = CACHE_LINES_PER_SUBARRAY * getCacheBlockSize();
-  UInt32 m_log_blocksize = floorLog2(getCacheBlockSize());
-  Byte* temp_data_buf = new Byte;
-  UInt32 cur_byte_pos;
-
-  if (DEBUG_ENABLED)  printf("CAP: create_cap_rep_ste_instructions. Now reading start STE info\n");
-
-  if(m_cap_ins.size() == 0) {
-    while(cur_subarray < NUM_SUBARRAYS) {
-
-        UInt32 sub_block = 0;
-        while(sub_block < block_size) {  
-          cur_byte_pos = cur_subarray * block_size + sub_block;
-          address = cur_byte_pos;
-          memcpy(temp_data_buf, ste_file + cur_byte_pos, 1);
-         
-          // below is a global hack, since the ASCII of 0 is NULL, which does not exist as a char
-          if(*temp_data_buf == 199) 
-            *temp_data_buf = 0; 
-/*
-          if(*temp_data_buf == 36) *temp_data_buf = 0;  //Refer to the NOTE
-          else if(*temp_data_buf == 32) *temp_data_buf = 32;
-          else if(*temp_data_buf == 42) *temp_data_buf = 16;
-          else if(*temp_data_buf == 33) *temp_data_buf = 8;
-          else if(*temp_data_buf == 61) *temp_data_buf = 4;
-          else if(*temp_data_buf == 38) *temp_data_buf = 2;
-*/
-
-
-          if (DEBUG_ENABLED)  printf("create_cap_rep_ste_instructions writing!!! addr: %d  data: %d\n", address, *temp_data_buf);
-          addr = (IntPtr)(address);
-          //printf("Address: 0x%x, Value: %d\n", address, (unsigned long)*temp_data_buf);
-          OperandList store_list;
-          store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-          store_list.push_back(Operand(Operand::REG, (unsigned long)(*temp_data_buf), Operand::READ, "", true));
-          Instruction *store_inst = new GenericInstruction(store_list);
-          store_inst->setAddress(m_mbench_dest_addr); //TODO: To check where inst addr is used
-          store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-          store_inst->setAtomic(false);
-          store_inst->setDisassembly("");
-          std::vector<const MicroOp *> *store_uops 
-                                  = new std::vector<const MicroOp*>();
-          MicroOp *currentSMicroOp = new MicroOp();
-          currentSMicroOp->setInstructionPointer(Memory::make_access(m_mbench_dest_addr));
-          currentSMicroOp->makeStore(
-            0
-            , 0
-            , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-            , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-            , 1
-           );
-          currentSMicroOp->setOperandSize(64); 
-          currentSMicroOp->setInstruction(store_inst);
-          currentSMicroOp->setFirst(true);
-          currentSMicroOp->setLast(true);
-          store_uops->push_back(currentSMicroOp);
-          store_inst->setMicroOps(store_uops);
-          m_cap_ins.push_back(store_inst);
-          sub_block++;
-
-          //CAP: Dynamic Instructions Info creation
-          DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
-			                                true, //False if instruction will not be executed because of predication
-			                                SubsecondTime::Zero(), addr, 8, Operand::WRITE, 0, 
-			                                HitWhere::UNKNOWN);
-		      m_cap_dyn_ins_info.push_back(sinfo);
-          // TODO: FIXME: What the hell is this?
-
-          struct CAPInsInfo cii;
-          cii.addr	= addr;
-          cii.op		= CacheCntlr::CAP_ST_MASK;	
-          cii.cap_data_buf = new Byte;
-          memcpy(cii.cap_data_buf, temp_data_buf, 1);  // copy 1 byte of data
-          capInsInfoMap[addr] 	= cii;
-       } 
-      cur_subarray++;
-    }  
-
-    // Now reading the reporting STE mask
-    if (DEBUG_ENABLED)  printf ("Finished reading start mask. Now reading reporting STE mask...\n");
-    cur_subarray = 0;
-
-    while(cur_subarray < NUM_SUBARRAYS) {
-
-        int sub_block = 0;
-        while(sub_block < block_size) {  
-        //while(sub_block < 3) {
-          cur_byte_pos = (NUM_SUBARRAYS * block_size) + (cur_subarray * block_size) + sub_block;
-          address = cur_byte_pos;  
-          memcpy(temp_data_buf, ste_file + cur_byte_pos, 1);
-
-          // below is a global hack, since the ASCII of 0 is NULL, which does not exist as a char
-          if(*temp_data_buf == 199) 
-            *temp_data_buf = 0; 
-/*
-          if(*temp_data_buf == 36) *temp_data_buf = 0;  //Refer to the NOTE
-          else if(*temp_data_buf == 32) *temp_data_buf = 32;
-          else if(*temp_data_buf == 42) *temp_data_buf = 16;
-          else if(*temp_data_buf == 33) *temp_data_buf = 8;
-          else if(*temp_data_buf == 61) *temp_data_buf = 4;
-          else if(*temp_data_buf == 38) *temp_data_buf = 2;
-*/
-
-
-          if (DEBUG_ENABLED)  printf("create_cap_rep_ste_instructions writing!!! addr: %d  data: %d\n", address, *temp_data_buf);
-          addr = (IntPtr)(address);
-          //printf("Address: 0x%x, Value: %d\n", address, (unsigned long)*temp_data_buf);
-          OperandList store_list;
-          store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-          store_list.push_back(Operand(Operand::REG, (unsigned long)(*temp_data_buf), Operand::READ, "", true));
-          Instruction *store_inst = new GenericInstruction(store_list);
-          store_inst->setAddress(m_mbench_dest_addr); //TODO: To check where inst addr is used
-          store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-          store_inst->setAtomic(false);
-          store_inst->setDisassembly("");
-          std::vector<const MicroOp *> *store_uops 
-                                  = new std::vector<const MicroOp*>();
-          MicroOp *currentSMicroOp = new MicroOp();
-          currentSMicroOp->setInstructionPointer(Memory::make_access(m_mbench_dest_addr));
-          currentSMicroOp->makeStore(
-            0
-            , 0
-            , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-            , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-            , 1
-           );
-          currentSMicroOp->setOperandSize(64); 
-          currentSMicroOp->setInstruction(store_inst);
-          currentSMicroOp->setFirst(true);
-          currentSMicroOp->setLast(true);
-          store_uops->push_back(currentSMicroOp);
-          store_inst->setMicroOps(store_uops);
-          m_cap_ins.push_back(store_inst);
-          sub_block++;
-
-          //CAP: Dynamic Instructions Info creation
-          DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
-			                                true, //False if instruction will not be executed because of predication
-			                                SubsecondTime::Zero(), addr, 8, Operand::WRITE, 0, 
-			                                HitWhere::UNKNOWN);
-		      m_cap_dyn_ins_info.push_back(sinfo);
-          // TODO: FIXME: What the hell is this?
-
-          struct CAPInsInfo cii;
-          cii.addr	= addr;
-          cii.op		= CacheCntlr::CAP_REP_STE;	
-          cii.cap_data_buf = new Byte;
-          memcpy(cii.cap_data_buf, temp_data_buf, 1);  // copy 1 byte of data
-          capInsInfoMap[addr] 	= cii;
-       } 
-      cur_subarray++;
-    }  
-
+//CAP: A single synthetic store carries a whole programming image (cache, swizzle 
+//switch or STE masks) to the cache controller, which programs it line by line.
+//The image is copied out of the application buffer here, as the app may unmap it
+//before the store reaches the memory subsystem.
+//NOTE: prog.pl writes a Byte value of 0 as 199, since 0 is not a printable char.
+//Images built in the simulator (ANML) are not encoded.
+Byte*  MemoryManager::create_cap_program_instruction(CacheCntlr::cap_ops_t op, Byte* image_file, UInt32 length, bool encoded) {
+  // bits 31 and 29 plus the opcode keep these stores apart from all other CAP/app addresses
+  IntPtr addr = (IntPtr)((1U<<31) | (1U<<29) | (UInt32)op);
+
+  if (DEBUG_ENABLED)  printf("create_cap_program_instruction: op %d, %d bytes at addr 0x%x\n", (int)op, length, (UInt32)addr);
+
+  struct CAPInsInfo cii;
+  cii.addr = addr;
+  cii.op = op;
+  cii.stream_id = 0;
+  cii.cap_data_buf = new Byte[length];
+  cii.cap_data_length = length;
+  for (UInt32 i = 0; i < length; i++)
+    cii.cap_data_buf[i] = (encoded && image_file[i] == 199) ? 0 : image_file[i];
+  apply_cap_partition_mask(op, cii.cap_data_buf, length);
+
+  create_cap_store_instruction(addr, newCapOp(cii));
+  return cii.cap_data_buf;
+}
 
+//CAP: Keep only the STEs owned by this partition in the cache image and in the
+//start and all-input masks. The swizzle switch is left whole: an STE that never becomes active
+//here is never looked up, and its component lives entirely in another partition.
+void  MemoryManager::apply_cap_partition_mask(CacheCntlr::cap_ops_t op, Byte* image, UInt32 length) {
+  if (m_cap_partitions <= 1 || op == CacheCntlr::CAP_SS)
+    return;
+
+  LOG_ASSERT_ERROR(!m_cap_partition_mask.empty(), "CAP: with perf_model/cap/partitions > 1 the swizzle switch must be programmed first");
+
+  UInt32 ste_bytes = m_cap_params.steBytesPerSubarray();
+  if (op == CacheCntlr::CAP_PROGRAM) {
+    for (UInt32 i = 0; i < length; i++) {
+      UInt32 line = i / ste_bytes;
+      image[i] &= m_cap_partition_mask[(line / m_cap_params.lines_per_subarray) * ste_bytes + i % ste_bytes];
+    }
   }
-  if (DEBUG_ENABLED)  {
-     printf("\nCAP: After RepSTE CAPInsInfoMap Display\n");
-     showCapInsInfoMap();
+  else if (op == CacheCntlr::CAP_REP_STE) {
+    // start mask, reporting mask, optional all-input mask; the reporting mask is left whole
+    UInt32 mask_bytes = m_cap_partition_mask.size();
+    for (UInt32 i = 0; i < length; i++) {
+      if (i / mask_bytes != 1)
+        image[i] &= m_cap_partition_mask[i % mask_bytes];
+    }
   }
 }
 
+//CAP: The synthetic store carrying one CAP op, tagged with its op table entry
+void  MemoryManager::create_cap_store_instruction(IntPtr addr, UInt32 accel_op) {
+  m_cap_ins.push_back(m_synthetic_ins.getStore(m_mbench_dest_addr, -1, 1));
+
+  //CAP: Dynamic Instructions Info creation
+  DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
+                                true, //False if instruction will not be executed because of predication
+                                SubsecondTime::Zero(), addr, 8, Operand::WRITE, 0, 
+                                HitWhere::UNKNOWN, accel_op);
+  m_cap_dyn_ins_info.push_back(sinfo);
+}
+
 void  MemoryManager::schedule_cap_instructions() {
   int num_prg = m_cap_ins.size();
   if (DEBUG_ENABLED)  printf("\n schedule_cap_instructions: The num of cap inst is %d", m_cap_ins.size());
@@ -1151,203 +1088,34 @@ void  MemoryManager::schedule_cap_instructions() {
     if (DEBUG_ENABLED)  printf("\n MemoryManager::schedule_cap_instructions Store Inst No %d", num_prg);
     getCore()->getPerformanceModel()->pushDynamicInstructionInfo(m_cap_dyn_ins_info[0], false, true);
     getCore()->getPerformanceModel()->queueInstruction(m_cap_ins[0], false, true);
-   	m_cap_dyn_ins_info.erase(m_cap_dyn_ins_info.begin());
-    m_cap_ins.erase(m_cap_ins.begin());
+   	m_cap_dyn_ins_info.pop_front();
+    m_cap_ins.pop_front();
     --num_prg;
   } 
   //assert(count == m_cap_ins.size());
 }  
 
-void MemoryManager::showCapInsInfoMap() {
-   for (CAPInsInfoMap::iterator it = capInsInfoMap.begin(); it!=capInsInfoMap.end(); it++)
-   {
-      printf("address: 0x%x, data: %d op_type: %d\n", 
-            (UInt64)(it->first), (UInt32)(*((it->second).cap_data_buf)), (UInt32)((it->second).op));
-   }
-}
-
-void  MemoryManager::create_cap_ss_instructions(Byte* ss_file) {
-  UInt32 cur_ste = 0;
-  UInt32 ste_num;
-  Byte* temp_data_buf = new Byte;
-  UInt32 address;
-  IntPtr addr = (IntPtr)(address);
-
-  if (DEBUG_ENABLED)  printf("Inside create_cap_ss_instructions: SWIZZLE_SWITCH_X: %d, SWIZZLE_SWITCH_Y: %d\n", 
-        SWIZZLE_SWITCH_X, SWIZZLE_SWITCH_Y);
-
-  if(m_cap_ins.size() == 0) {
-    while(cur_ste < SWIZZLE_SWITCH_X) {
-        UInt32 sub_block = 0;
-        while(sub_block < SWIZZLE_SWITCH_Y) {
-          // set bits 31 and 30 to prevent collision of these instruction with other inst
-          address =  (UInt32)(cur_ste*SWIZZLE_SWITCH_Y + sub_block);
-          memcpy(temp_data_buf, ss_file + address, 1); 
-
-          address =  address | (1<<31) | (1<<30);
-
-          // below is a global hack, since the ASCII of 0 is NULL, which does not exist as a char
-          if(*temp_data_buf == 199) *temp_data_buf = 0;
-
-/*
-          //Hack for COLOR  
-          if(*temp_data_buf == 36) *temp_data_buf = 0;  //Refer to the NOTE
-          else if(*temp_data_buf == 32) *temp_data_buf = 32;
-          else if(*temp_data_buf == 42) *temp_data_buf = 16;
-          else if(*temp_data_buf == 33) *temp_data_buf = 8;
-          else if(*temp_data_buf == 61) *temp_data_buf = 4;
-          else if(*temp_data_buf == 38) *temp_data_buf = 2;
-*/
-
-
-
-          addr = (IntPtr)(address);        
-          if (DEBUG_ENABLED)  printf("\n create_cap_ss_instructions STE no: 0x%x, Value: %d\n", address, *temp_data_buf);
-
-          OperandList store_list;
-          store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-          store_list.push_back(Operand(Operand::REG, (UInt32)(*temp_data_buf), Operand::READ, "", true));
-
-          Instruction *store_inst = new GenericInstruction(store_list);
-          store_inst->setAddress(m_mbench_dest_addr);
-          store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-          store_inst->setAtomic(false);
-          store_inst->setDisassembly("");
-
-          std::vector<const MicroOp *> *store_uops = new std::vector<const MicroOp*>();
-          MicroOp *currentSMicroOp = new MicroOp();
-          currentSMicroOp->setInstructionPointer(Memory::make_access(m_mbench_dest_addr));
-          currentSMicroOp->makeStore(
-            0
-            , 0
-            , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-            , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-            , 1
-           );
-          currentSMicroOp->setOperandSize(64); 
-          currentSMicroOp->setInstruction(store_inst);
-          currentSMicroOp->setFirst(true);
-          currentSMicroOp->setLast(true);
-
-          store_uops->push_back(currentSMicroOp);
-          store_inst->setMicroOps(store_uops);
-
-          m_cap_ins.push_back(store_inst);
-          sub_block++;
-
-          //CAP: Dynamic Instructions Info creation
-          DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
-			                                true, //False if instruction will not be executed because of predication
-			                                SubsecondTime::Zero(), addr, 64, Operand::WRITE, 0, 
-			                                HitWhere::UNKNOWN);
-          m_cap_dyn_ins_info.push_back(sinfo);
-
-          struct CAPInsInfo cii;
-          cii.addr  = addr;
-          cii.op    = CacheCntlr::CAP_SS;	
-          cii.cap_data_buf = new Byte;
-          memcpy(cii.cap_data_buf, temp_data_buf, 1);  // copy 1 byte of data
-          if (DEBUG_ENABLED)  printf("\n CAP: SS data = %d", *(cii.cap_data_buf));
-          capInsInfoMap[address] 	= cii;
-       } 
-       cur_ste++;
-      }
-  }
-
-  if (DEBUG_ENABLED)  {
-     printf("\nCAP: After SS CAPInsInfoMap Display\n");
-     showCapInsInfoMap();
-  }
-
-}  
-
-void  MemoryManager::create_cap_match_instructions(Byte* match_file) {
-  UInt32 address1 = 0, address = 0; 
-  IntPtr addr = (IntPtr)(address);
-  Byte* temp_data_buf = new Byte;
-  UInt32 byte_pos = 0;
-  int patternEnded = 0;
-
-  if (DEBUG_ENABLED)  printf("Inside create_cap_match_instructions: \n");
-
-  if(m_cap_ins.size() == 0) {
-     while ((char)(*(match_file+byte_pos)) != '\n')  { // detect end of input pattern this way.
-      EXECUTE:
-          // set bit 30 of address to uniquely identify inst and prevent inst collision
-          address1 = (1<<30) | address;
-          if (DEBUG_ENABLED)  printf("\n CAP: create_cap_match_instructions address: 0x%x, Input char: (char)%c, (int)%d\n", address, (char)(*(match_file+byte_pos)), (UInt32)(*(match_file+byte_pos)));
-
-          memcpy(temp_data_buf, match_file+byte_pos, 1);
-
-          OperandList store_list;
-          store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-          store_list.push_back(Operand(Operand::REG, (UInt32)(*temp_data_buf), Operand::READ, "", true));
-
-          Instruction *store_inst = new GenericInstruction(store_list);
-          store_inst->setAddress(m_mbench_dest_addr);
-          store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-          store_inst->setAtomic(false);
-          store_inst->setDisassembly("");
-
-          std::vector<const MicroOp *> *store_uops = new std::vector<const MicroOp*>();
-          MicroOp *currentSMicroOp = new MicroOp();
-          currentSMicroOp->setInstructionPointer(Memory::make_access(m_mbench_dest_addr));
-          currentSMicroOp->makeStore(
-            0
-            , 0
-            , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-            , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-            , 1
-           );
-          currentSMicroOp->setOperandSize(64); 
-          currentSMicroOp->setInstruction(store_inst);
-          currentSMicroOp->setFirst(true);
-          currentSMicroOp->setLast(true);
-
-          store_uops->push_back(currentSMicroOp);
-          store_inst->setMicroOps(store_uops);
-
-          m_cap_ins.push_back(store_inst);
-          addr = (IntPtr)(address1);
-
-          //CAP: Dynamic Instructions Info creation
-          DynamicInstructionInfo sinfo = DynamicInstructionInfo::createMemoryInfo(m_mbench_dest_addr,//ins address 
-			                                true, //False if instruction will not be executed because of predication
-			                                SubsecondTime::Zero(), addr, 64, Operand::WRITE, 0, 
-			                                HitWhere::UNKNOWN);
-          m_cap_dyn_ins_info.push_back(sinfo);
-
-
-          struct CAPInsInfo cii;
-          cii.addr  = addr;
-          cii.op    = patternEnded ? CacheCntlr::CAP_END : CacheCntlr::CAP_MATCH;	
-          cii.cap_data_buf = new Byte;
-          memcpy(cii.cap_data_buf, temp_data_buf, 1);  // copy 1 byte of data
-          if (DEBUG_ENABLED)  printf("\n CAP: Character at address %d is %c",addr,*(cii.cap_data_buf));
-          capInsInfoMap[address1] 	= cii;
-
-        address++;
-        byte_pos++; 
-
-        if (patternEnded) { 
-           patternEnded = 2;
-           break;
-        }
-     }
-
-     if (DEBUG_ENABLED)  printf("\n CAP: Came out of loop %d", patternEnded);
-
-     if (patternEnded != 2) {   // to tag the end of input pattern stream
-         patternEnded = 1;
-         goto EXECUTE;
-     }
-  } 
-
-  if (DEBUG_ENABLED)  {
-     printf("\nCAP: After Match CAPInsInfoMap Display\n");
-     showCapInsInfoMap();
-  }
-
+//CAP: One synthetic store per chunk of the input stream (CAP_MATCH), or the
+//end-of-stream or end-of-input marker (CAP_STREAM_END/CAP_END, no data). Chunk addresses have bit 30 set and a
+//line-aligned sequence number below it, so a store never straddles two lines
+//and the key is unique among the chunks still in flight.
+void  MemoryManager::create_cap_match_instruction(CacheCntlr::cap_ops_t op, Byte* match_file, UInt32 length, UInt32 stream_id) {
+  UInt32 log_block_size = floorLog2(getCacheBlockSize());
+  UInt32 seq_mask = (1U << (30 - log_block_size)) - 1;
+  IntPtr addr = (IntPtr)((1U<<30) | ((m_cap_match_seq++ & seq_mask) << log_block_size));
+
+  if (DEBUG_ENABLED)  printf("create_cap_match_instruction: op %d, stream %d, %d bytes at addr 0x%x\n", (int)op, stream_id, length, (UInt32)addr);
+
+  struct CAPInsInfo cii;
+  cii.addr = addr;
+  cii.op = op;
+  cii.stream_id = stream_id;
+  cii.cap_data_buf = length ? new Byte[length] : NULL;
+  cii.cap_data_length = length;
+  if (length)
+    memcpy(cii.cap_data_buf, match_file, length);
+
+  create_cap_store_instruction(addr, newCapOp(cii));
 }
 
 
@@ -1362,29 +1130,8 @@ void MemoryManager::create_schedule_dummy_instructions() {
       while(i <= 2*m_min_dummy_inst+35) { 
        if(!dummy_inst) {
            if (DEBUG_ENABLED)  printf("\n CAP: making first dummy inst");  
-           OperandList dummy_list;
-           dummy_list.push_back(Operand(Operand::REG, dummy_reg, Operand::READ, "", true));
-           dummy_inst 	= new GenericInstruction(dummy_list);
-           dummy_inst->setAddress(80);;
-           dummy_inst->setSize(4);
-           dummy_inst->setAtomic(false);
-           dummy_inst->setDisassembly("");
-           std::vector<const MicroOp *> *cmp_uops = new std::vector<const MicroOp*>();;
-           MicroOp *currentMicroOp 	= new MicroOp();
-           currentMicroOp->makeExecute(
-             0, 0
-             , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-             , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-             , false	//not conditional branch
-           );
-           currentMicroOp->setMemBarrier(true);
-           currentMicroOp->addSourceRegister((xed_reg_enum_t)dummy_reg, "");
-           currentMicroOp->setOperandSize(64); 
-           currentMicroOp->setInstruction(dummy_inst);
-           currentMicroOp->setFirst(true);
-           currentMicroOp->setLast(true);
-           cmp_uops->push_back(currentMicroOp);
-           dummy_inst->setMicroOps(cmp_uops);
+           dummy_inst = m_synthetic_ins.getExecute(80, XED_ICLASS_MOVQ,
+                           dummy_reg, -1, -1, true /* memory barrier */);
        }
        assert(dummy_inst);
        if (DEBUG_ENABLED)  printf("\n On insertion of dummy inst %d",i);
@@ -1401,7 +1148,16 @@ IntPtr MemoryManager::microbench_target_ins_cnt() {
 	IntPtr num_iterations			= m_microbench_totalsize / m_microbench_loopsize;
 	IntPtr ins_per_iteration	= 0;
 	num_iterations	= num_iterations * Sim()->getCfg()->getInt("general/microbench_outer_loops");
-	if(m_pic_on) {
+	if(m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+		//Replay the op mix on a copy, the loops ahead pick the same ops
+		std::vector<MicrobenchKernelOp> ops = m_mbench_kernel.ops;
+		IntPtr total_ins = 0;
+		for(IntPtr iteration = 0; iteration < num_iterations; ++iteration)
+			total_ins += microbench_kernel_ins_per_iteration(
+										ops[next_microbench_kernel_op(ops, m_mbench_kernel.total_weight)]);
+		return total_ins;
+	}
+	else if(m_pic_on) {
 		if(m_pic_use_vpic) {
 			if( m_microbench_type == PIC_IS_MICROBENCH_COPY) //always 1
 				ins_per_iteration = 1;
@@ -1470,7 +1226,34 @@ IntPtr MemoryManager::microbench_target_ins_cnt() {
 }
 void MemoryManager::create_microbench_instructions() {
 	if(Sim()->getInstrumentationMode() == InstMode::CACHE_ONLY) {
-		if(m_microbench_type != PIC_IS_MICROBENCH_BMM) {	
+		if(m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+			//Both operand arrays, line by line at the kernel stride
+			IntPtr lines 	= m_mbench_kernel.footprint / m_mbench_kernel.stride;
+			printf("\nWARMUP: Touching %lu lines of %s operands at (%lu, %lu)\n", 
+							lines, m_mbench_kernel.name.c_str(), m_mbench_src_addr, m_mbench_dest_addr);
+			for(IntPtr line = 0; line < lines; ++line) {
+  			m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
+    	   Core::NONE, Core::READ,
+    	   m_mbench_src_addr + line * m_mbench_kernel.stride, 0, NULL, 8,
+    	   false, false);
+  			m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
+    	   Core::NONE, Core::READ,
+    	   m_mbench_dest_addr + line * m_mbench_kernel.stride, 0, NULL, 8,
+    	   false, false);
+			}
+			//and bmm's matrix, if the mix has bmm
+			for(UInt32 i = 0; i < m_mbench_kernel.ops.size(); ++i) {
+				if(m_mbench_kernel.ops[i].op != CacheCntlr::PIC_CLMULT)
+					continue;
+				for(IntPtr offset = 0; offset < 512; offset += 64)
+  				m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
+    	     Core::NONE, Core::READ,
+    	     m_mbench_kernel.matrix_addr + offset, 0, NULL, 8,
+    	     false, false);
+				break;
+			}
+		}
+		else if(m_microbench_type != PIC_IS_MICROBENCH_BMM) {	
 			IntPtr begin = m_mbench_src_addr;
 			IntPtr begin1 	= m_mbench_src_addr + (m_microbench_totalsize);
 			IntPtr end 	= m_mbench_src_addr + (2*m_microbench_totalsize); //src, dest
@@ -1562,6 +1345,11 @@ void MemoryManager::create_microbench_instructions() {
 				create_microbench_pic_fastbit_instructions();
 				schedule_microbench_fastbit_instructions();
 			}
+			else if( m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+				create_microbench_pic_kernel_instructions(m_mbench_kernel.ops[
+					next_microbench_kernel_op(m_mbench_kernel.ops, m_mbench_kernel.total_weight)]);
+				schedule_microbench_kernel_instructions();
+			}
 		}
 		else {
 			if( m_microbench_type == PIC_IS_MICROBENCH_COPY) {
@@ -1588,11 +1376,18 @@ void MemoryManager::create_microbench_instructions() {
 				create_microbench_fastbit_instructions();
 				schedule_microbench_fastbit_instructions();
 			}
+			else if( m_microbench_type == PIC_IS_MICROBENCH_KERNEL) {
+				create_microbench_kernel_instructions(m_mbench_kernel.ops[
+					next_microbench_kernel_op(m_mbench_kernel.ops, m_mbench_kernel.total_weight)]);
+				schedule_microbench_kernel_instructions();
+			}
 		}
 		--m_microbench_loops;
 		if((m_microbench_outer_loops > 1) && !m_microbench_loops) {
 			m_mbench_src_addr		= 8388608;		//need to be same across runs
 			m_mbench_dest_addr	= m_mbench_src_addr + m_microbench_totalsize;
+			if(m_microbench_type == PIC_IS_MICROBENCH_KERNEL)
+				m_mbench_dest_addr	= m_mbench_src_addr + m_mbench_kernel.operand_distance;
 			if(m_microbench_type == PIC_IS_MICROBENCH_BMM) {
 				m_mbench_src2_addr	= m_mbench_src_addr 	+ m_microbench_totalsize;
 				m_mbench_dest_addr	= m_mbench_src2_addr 	+ m_microbench_totalsize;		
@@ -1616,7 +1411,7 @@ void MemoryManager::schedule_microbench_copy_instructions() {
 																			(m_mbench_dest_dyn_ins_info[0], true);
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[count], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
 			--num_pics;
 			++count;
 		}
@@ -1631,7 +1426,7 @@ void MemoryManager::schedule_microbench_copy_instructions() {
 			while(counter) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_src_dyn_ins_info[0], true);
-				m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+				m_mbench_src_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_src_ins[num_loads_cnt], true);
 				--counter;
@@ -1641,7 +1436,7 @@ void MemoryManager::schedule_microbench_copy_instructions() {
 			while(counter) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_stores_cnt], true);
 				--counter;
@@ -1654,7 +1449,7 @@ void MemoryManager::schedule_microbench_copy_instructions() {
 			while(counter){
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_src_dyn_ins_info[0], true);
-				m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+				m_mbench_src_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_src_ins[num_loads_cnt], true);
 				--counter;
@@ -1664,7 +1459,7 @@ void MemoryManager::schedule_microbench_copy_instructions() {
 			while(counter){
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_stores_cnt], true);
 				--counter;
@@ -1689,7 +1484,7 @@ void MemoryManager::schedule_microbench_comp_instructions() {
 																			(m_mbench_src_dyn_ins_info[0], true);
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_src_ins[count], true);
-			m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+			m_mbench_src_dyn_ins_info.pop_front();
 			--num_pics;
 			++count;
 		}
@@ -1704,13 +1499,13 @@ void MemoryManager::schedule_microbench_comp_instructions() {
 			while(counter) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_src_dyn_ins_info[0], true);
-				m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+				m_mbench_src_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_src_ins[num_loads_cnt], true);
 
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_loads_cnt], true);
 				--counter;
@@ -1732,12 +1527,12 @@ void MemoryManager::schedule_microbench_comp_instructions() {
 			while(counter){
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_src_dyn_ins_info[0], true);
-				m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+				m_mbench_src_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_src_ins[num_loads_cnt], true);
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_loads_cnt], true);
 				--counter;
@@ -1771,7 +1566,7 @@ void MemoryManager::schedule_microbench_search_instructions() {
 																			(m_mbench_src_dyn_ins_info[0], true);
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_src_ins[count], true);
-			m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+			m_mbench_src_dyn_ins_info.pop_front();
 			--num_pics;
 			++count;
 		}
@@ -1784,7 +1579,7 @@ void MemoryManager::schedule_microbench_search_instructions() {
 		//Single load for key
   	getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 															(m_mbench_src_dyn_ins_info[0], true);
-		m_mbench_src_dyn_ins_info.erase(m_mbench_src_dyn_ins_info.begin());
+		m_mbench_src_dyn_ins_info.pop_front();
   	getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_src_ins[num_loads_cnt], true);
 		while(loads_7batches) {
@@ -1793,7 +1588,7 @@ void MemoryManager::schedule_microbench_search_instructions() {
 
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_loads_cnt], true);
 				--counter;
@@ -1815,7 +1610,7 @@ void MemoryManager::schedule_microbench_search_instructions() {
 			while(counter){
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																		(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_mbench_dest_ins[num_loads_cnt], true);
 				--counter;
@@ -1849,7 +1644,7 @@ void MemoryManager::schedule_microbench_fastbit_instructions() {
 																			(m_mbench_dest_dyn_ins_info[0], true);
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[0], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
 			--pic_vec_lgcl_ins;
 		}
 		assert(m_mbench_dest_dyn_ins_info.size() == 0);
@@ -1951,7 +1746,7 @@ void MemoryManager::create_microbench_pic_fastbit_instructions() {
 		pii.op						= CacheCntlr::PIC_COPY;	
 		pii.is_vpic				= true;
 		pii.count					= ((count==1) && last_op_size)? (last_op_size/64) : count_per_vec_op;
-		picInsInfoMap[load1_address] 	= pii;
+		m_mbench_dest_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 		if((count == 1) && last_op_size) {
 			load1_address += last_op_size;
 			load2_address += last_op_size;
@@ -1989,20 +1784,20 @@ void MemoryManager::create_microbench_fastbit_instructions() {
 	if(m_mbench_dest_ins.size() == 0) {
 		int count = 0;
 		while(count < unwind_factor) {
-			int load_reg1	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int load_reg1	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			Instruction *load1 = create_single_load(vec_ins_addr_begin, load_reg1); 
 			m_mbench_dest_ins.push_back(load1);
 			m_mbench_regs.push_back(load_reg1);
 
-			int load_reg2	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int load_reg2	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			Instruction *load2 = create_single_load(vec_ins_addr_begin+16, load_reg2); 
 			m_mbench_dest_ins.push_back(load2);
 			m_mbench_regs.push_back(load_reg2);
 
-			int res_reg	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int res_reg	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			Instruction *cmp = 
 			create_single_cmp(vec_ins_addr_begin+32,load_reg1, load_reg2, res_reg);
 			m_mbench_dest_ins.push_back(cmp);
@@ -2061,7 +1856,7 @@ void MemoryManager::schedule_microbench_bmm_instructions() {
 			//Schedule load
   		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																			(m_mbench_dest_dyn_ins_info[0], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[count], true);
 			++count;
@@ -2077,17 +1872,17 @@ void MemoryManager::schedule_microbench_bmm_instructions() {
 			++count;
   		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																			(m_mbench_dest_dyn_ins_info[0], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[count], true);
 			++count;
   		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																			(m_mbench_dest_dyn_ins_info[0], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
 			//Schedule pic_mult
   		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																			(m_mbench_dest_dyn_ins_info[0], true);
-			m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+			m_mbench_dest_dyn_ins_info.pop_front();
   		getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[count], true);
 			++count;
@@ -2115,7 +1910,7 @@ void MemoryManager::schedule_microbench_bmm_instructions() {
 			while(count < vec_row_load_per_batch) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																			(m_mbench_dest_dyn_ins_info[0], true);
-				m_mbench_dest_dyn_ins_info.erase(m_mbench_dest_dyn_ins_info.begin());
+				m_mbench_dest_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 																			m_mbench_dest_ins[ins_count], true);
 				++ins_count;
@@ -2163,100 +1958,17 @@ void MemoryManager::schedule_microbench_bmm_instructions() {
 
 Instruction*  MemoryManager::create_single_load(
 	IntPtr ins_addr, int reg) {
-	OperandList load_list;
-	load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  load_list.push_back(Operand(Operand::REG, reg, Operand::WRITE, 
-																														"", true));
-  Instruction *load_inst = new GenericInstruction(load_list);
-  load_inst->setAddress(ins_addr);
-  load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  load_inst->setAtomic(false);
-  load_inst->setDisassembly("");
-  std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-  MicroOp *currentLMicroOp = new MicroOp();
-  currentLMicroOp->makeLoad(
-  	0
-    , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-    , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    , 32 //memop_load_size[0]
-   );
-  currentLMicroOp->addDestinationRegister((xed_reg_enum_t)reg, ""); 
-  currentLMicroOp->setOperandSize(64); 
-  currentLMicroOp->setInstruction(load_inst);
-  currentLMicroOp->setFirst(true);
-  currentLMicroOp->setLast(true);
-  load_uops->push_back(currentLMicroOp);
-  load_inst->setMicroOps(load_uops);
-	return load_inst;
+	return m_synthetic_ins.getLoad(ins_addr, reg, 32);
 }
 
 Instruction* MemoryManager::create_single_cmp(IntPtr ins_addr, 
 														int reg1, int reg2, int reg3) {
-	OperandList comp_list;
-	comp_list.push_back(Operand(Operand::REG, reg1, Operand::READ,
-																											"", true));
-	comp_list.push_back(Operand(Operand::REG, reg2, Operand::READ,
-																											"", true));
-  comp_list.push_back(Operand(Operand::REG, reg3, Operand::WRITE, 
-																											"", true));
-  Instruction *comp_inst 	= new GenericInstruction(comp_list);
-	comp_inst->setAddress(ins_addr);
-	comp_inst->setSize(4);
-	comp_inst->setAtomic(false);
-	comp_inst->setDisassembly("");
-	std::vector<const MicroOp *> *cmp_uops
-										= new std::vector<const MicroOp*>();;
-  MicroOp *currentMicroOp 	= new MicroOp();
-  currentMicroOp->makeExecute(
-  	0, 0
-    , XED_ICLASS_CMP //TODO: xed_decoded_inst_get_iclass(ins)
-    , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    , false	//not conditional branch
-   );
-  currentMicroOp->addSourceRegister((xed_reg_enum_t)reg1, "");
-  currentMicroOp->addSourceRegister((xed_reg_enum_t)reg2, "");
-  currentMicroOp->addDestinationRegister((xed_reg_enum_t)reg3, "");
-  currentMicroOp->setOperandSize(64); 
-  currentMicroOp->setInstruction(comp_inst);
-  currentMicroOp->setFirst(true);
-  currentMicroOp->setLast(true);
-  cmp_uops->push_back(currentMicroOp);
-  comp_inst->setMicroOps(cmp_uops);
-	return comp_inst;
+	return m_synthetic_ins.getExecute(ins_addr, XED_ICLASS_CMP, reg1, reg2, reg3);
 }
 
 Instruction* MemoryManager::create_single_store(IntPtr ins_addr, 
 														int reg, bool is_pic) {
-	OperandList store_list;
-  store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-	if(!is_pic)
-  	store_list.push_back(Operand(Operand::REG, reg, Operand::READ, 
-																												"", true));
-  Instruction *store_inst = new GenericInstruction(store_list);
-  store_inst->setAddress(ins_addr);
-  store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  store_inst->setAtomic(false);
-  store_inst->setDisassembly("");
-	std::vector<const MicroOp *> *store_uops 
-															= new std::vector<const MicroOp*>();;
-  MicroOp *currentSMicroOp = new MicroOp();
-  currentSMicroOp->makeStore(
-  	0
-		,0
-    , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-    , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    , 32 //memop_load_size[0]
-   );
-	if(!is_pic)
-  	currentSMicroOp->addSourceRegister((xed_reg_enum_t)reg, "");
-  currentSMicroOp->setOperandSize(64); 
-  currentSMicroOp->setInstruction(store_inst);
-  currentSMicroOp->setFirst(true);
-  currentSMicroOp->setLast(true);
-  store_uops->push_back(currentSMicroOp);
-  store_inst->setMicroOps(store_uops);
-	return store_inst;
+	return m_synthetic_ins.getStore(ins_addr, is_pic ? -1 : reg, 32);
 }
 
 void  MemoryManager::create_microbench_pic_bmm_instructions() {
@@ -2275,155 +1987,32 @@ void  MemoryManager::create_microbench_pic_bmm_instructions() {
 	if(m_mbench_dest_ins.size() == 0) {
 		while(total_columns) {		//For every columns
 			//First load
-			OperandList load_list;
-			int reg	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int reg	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			m_mbench_regs.push_back(reg);
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list.push_back(Operand(Operand::REG, reg, Operand::WRITE, 
-																														"", true));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		load_inst->setAddress(m_mbench_src_inst_addr);
-  		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst->setAtomic(false);
-  		load_inst->setDisassembly("");
-  		std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-  		MicroOp *currentLMicroOp = new MicroOp();
-  		currentLMicroOp->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentLMicroOp->addDestinationRegister((xed_reg_enum_t)reg, ""); 
-  		currentLMicroOp->setOperandSize(64); 
-  		currentLMicroOp->setInstruction(load_inst);
-  		currentLMicroOp->setFirst(true);
-  		currentLMicroOp->setLast(true);
-  		load_uops->push_back(currentLMicroOp);
-  		load_inst->setMicroOps(load_uops);
-			m_mbench_dest_ins.push_back(load_inst);
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, reg, m_microbench_opsize));
 			//Next scatter
-			int store_reg	= m_mbench_regs[0];
+			int store_reg;
 			if(m_microbench_opsize < 256) {
-				OperandList scat_list;
-				int scat_reg	= m_mbench_regs[0];
-				m_mbench_regs.erase(m_mbench_regs.begin());
+				int scat_reg	= m_mbench_regs.front();
+				m_mbench_regs.pop_front();
 				m_mbench_regs.push_back(scat_reg);
-				scat_list.push_back(Operand(Operand::REG, reg, Operand::READ,
-																														"", true));
-  			scat_list.push_back(Operand(Operand::REG, scat_reg, Operand::WRITE, 
-																														"", true));
-  			Instruction *scat_inst 	= new GenericInstruction(scat_list);
-				scat_inst->setAddress(m_mbench_src_inst_addr+16);
-				scat_inst->setSize(4);
-				scat_inst->setAtomic(false);
-				scat_inst->setDisassembly("");
-				std::vector<const MicroOp *> *scat_uops
-															= new std::vector<const MicroOp*>();;
-  			MicroOp *currentMicroOp 	= new MicroOp();
-  			currentMicroOp->makeExecute(
-  				0, 0
-  		  	, XED_ICLASS_CMP //TODO: xed_decoded_inst_get_iclass(ins)
-  		  	, "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  	, false	//not conditional branch
-  		 	);
-  			currentMicroOp->addSourceRegister((xed_reg_enum_t)reg, "");
-  			currentMicroOp->addDestinationRegister((xed_reg_enum_t)scat_reg, "");
-  			currentMicroOp->setOperandSize(64); 
-  			currentMicroOp->setInstruction(scat_inst);
-  			currentMicroOp->setFirst(true);
-  			currentMicroOp->setLast(true);
-  			scat_uops->push_back(currentMicroOp);
-  			scat_inst->setMicroOps(scat_uops);
-				m_mbench_dest_ins.push_back(scat_inst);
+				m_mbench_dest_ins.push_back(
+					m_synthetic_ins.getExecute(m_mbench_src_inst_addr+16, XED_ICLASS_CMP,
+						reg, -1, scat_reg));
 				store_reg	= scat_reg;
 			}
 			else
 				store_reg = reg;
 			//Next 2-stores
-			OperandList store_list1;
-			OperandList store_list2;
-  		store_list1.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		store_list1.push_back(Operand(Operand::REG, store_reg, Operand::READ, 
-																														 "", true));
-  		store_list2.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		store_list2.push_back(Operand(Operand::REG, store_reg, Operand::READ, 
-																														 "", true));
-  		Instruction *store_inst1 = new GenericInstruction(store_list1);
-  		Instruction *store_inst2 = new GenericInstruction(store_list2);
-  		store_inst1->setAddress(m_mbench_src_inst_addr+32);
-  		store_inst1->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		store_inst1->setAtomic(false);
-  		store_inst1->setDisassembly("");
-  		store_inst2->setAddress(m_mbench_src_inst_addr+48);
-  		store_inst2->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		store_inst2->setAtomic(false);
-  		store_inst2->setDisassembly("");
-			std::vector<const MicroOp *> *store_uops1 
-															= new std::vector<const MicroOp*>();;
-  		MicroOp *currentS1MicroOp = new MicroOp();
-			std::vector<const MicroOp *> *store_uops2
-															= new std::vector<const MicroOp*>();;
-  		MicroOp *currentS2MicroOp = new MicroOp();
-  		currentS1MicroOp->makeStore(
-  			0
-				,0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , 32 //memop_load_size[0]
-  		 );
-  		currentS2MicroOp->makeStore(
-  			0
-				,0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , 32 //memop_load_size[0]
-  		 );
-  		currentS1MicroOp->addSourceRegister((xed_reg_enum_t)store_reg, "");
-  		currentS1MicroOp->setOperandSize(64); 
-  		currentS1MicroOp->setInstruction(store_inst1);
-  		currentS1MicroOp->setFirst(true);
-  		currentS1MicroOp->setLast(true);
-  		store_uops1->push_back(currentS1MicroOp);
-  		store_inst1->setMicroOps(store_uops1);
-  		currentS2MicroOp->addSourceRegister((xed_reg_enum_t)store_reg, "");
-  		currentS2MicroOp->setOperandSize(64); 
-  		currentS2MicroOp->setInstruction(store_inst2);
-  		currentS2MicroOp->setFirst(true);
-  		currentS2MicroOp->setLast(true);
-  		store_uops2->push_back(currentS2MicroOp);
-  		store_inst2->setMicroOps(store_uops2);
-			m_mbench_dest_ins.push_back(store_inst1);
-			m_mbench_dest_ins.push_back(store_inst2);
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_src_inst_addr+32, store_reg, 32));
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_src_inst_addr+48, store_reg, 32));
 			//Next pic_clmult
-			OperandList store_list;
-   		store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		Instruction *store_inst = new GenericInstruction(store_list);
-   		store_inst->setAddress(m_mbench_src_inst_addr+64);
-   		store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-   		store_inst->setAtomic(false);
-   		store_inst->setDisassembly("");
-			std::vector<const MicroOp *> *store_uops 
-															= new std::vector<const MicroOp*>();;
-   		MicroOp *currentSMicroOp = new MicroOp();
-   		currentSMicroOp->setInstructionPointer(
-				Memory::make_access(m_mbench_src_inst_addr+64));
-    	currentSMicroOp->makeStore(
-    		0
-				,0
-      	, XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-      	, "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-      	, 8 //memop_load_size[0]
-     	);
-    	currentSMicroOp->setOperandSize(64); 
-    	currentSMicroOp->setInstruction(store_inst);
-    	currentSMicroOp->setFirst(true);
-    	currentSMicroOp->setLast(true);
-   		store_uops->push_back(currentSMicroOp);
-   		store_inst->setMicroOps(store_uops);
-			m_mbench_dest_ins.push_back(store_inst);
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_src_inst_addr+64, -1, 8));
 
 			//Asume result in cache
 			--total_columns;
@@ -2465,8 +2054,7 @@ void  MemoryManager::create_microbench_pic_bmm_instructions() {
 		pii.op						= CacheCntlr::PIC_CLMULT;	
 		pii.is_vpic				= true;
 		pii.count					= m_microbench_opsize; //will be calc later
-    picInsInfoVec.push_back(std::make_pair(m_mbench_dest_addr,pii));
-		//picInsInfoMap[m_mbench_dest_addr] 	= pii;
+		sinfo.memory_info.accel_op = newPicOp(pii);
 
 		m_mbench_src_addr 		+= (m_microbench_opsize/8); //Next column
 		m_mbench_dest_addr	 	+= (m_microbench_opsize/8);	//Next row
@@ -2484,7 +2072,7 @@ void  MemoryManager::create_microbench_pic_bmm_instructions() {
 	//printf("\nAddresses(%lx/%lx, %lx->%lx: (%lu, %lu)", 
 	//m_mbench_src_addr, m_mbench_spare_addr,
 	//m_mbench_src2_addr, m_mbench_dest_addr,
-	//m_mbench_dest_dyn_ins_info.size(), picInsInfoVec.size());
+	//m_mbench_dest_dyn_ins_info.size());
 }
 
 void MemoryManager::create_microbench_bmm_instructions() {
@@ -2528,16 +2116,16 @@ void MemoryManager::create_microbench_bmm_instructions() {
 	IntPtr res_store_ins_addr = clmult_ins_addr + (clmult_per_batch*16);
 
 	printf("\nBMM-Addr(%lu, %lu, %lu, %lu)", row_load_ins_addr, col_load_ins_addr, clmult_ins_addr, res_store_ins_addr);
-	std::vector<int> row_regs;
-	std::vector<int> col_regs;
+	std::deque<int> row_regs;
+	std::deque<int> col_regs;
 
 	if(m_mbench_dest_ins.size() == 0) {
 		int total_vec_row_batches = vec_row_batches;
 		while(total_vec_row_batches) {		//For every *batch* of rows
 			int count = 0;
 			while(count < vec_row_load_per_batch) {
-				int row_reg	= m_mbench_regs[0];
-				m_mbench_regs.erase(m_mbench_regs.begin());
+				int row_reg	= m_mbench_regs.front();
+				m_mbench_regs.pop_front();
 				Instruction *row_load = 
 					create_single_load(
 					(row_load_ins_addr+(count*16)), row_reg); 
@@ -2551,8 +2139,8 @@ void MemoryManager::create_microbench_bmm_instructions() {
 				count = 0;
 				//Loads first
 				while(count < vec_col_load_per_batch) {
-					int col_reg	= m_mbench_regs[0];
-					m_mbench_regs.erase(m_mbench_regs.begin());
+					int col_reg	= m_mbench_regs.front();
+					m_mbench_regs.pop_front();
 					Instruction *col_load = 
 					create_single_load
 						(col_load_ins_addr+(count*16), col_reg); 					
@@ -2565,8 +2153,8 @@ void MemoryManager::create_microbench_bmm_instructions() {
 				unsigned int row_reg_i = 0;
 				unsigned int col_reg_i = 0;
 				while(count < clmult_per_batch) {		//Perform all clmults
-					int res_reg	= m_mbench_regs[0];
-					m_mbench_regs.erase(m_mbench_regs.begin());
+					int res_reg	= m_mbench_regs.front();
+					m_mbench_regs.pop_front();
 					assert(row_reg_i < row_regs.size());
 					assert(col_reg_i < col_regs.size());
 					Instruction *clmult = 
@@ -2585,8 +2173,8 @@ void MemoryManager::create_microbench_bmm_instructions() {
 				}
 				int col_reg_size = col_regs.size();
 				while(col_reg_size) {
-					m_mbench_regs.push_back(col_regs[0]);
-					col_regs.erase(col_regs.begin());
+					m_mbench_regs.push_back(col_regs.front());
+					col_regs.pop_front();
 					--col_reg_size;
 				}
 				assert(col_regs.size() == 0);
@@ -2595,8 +2183,8 @@ void MemoryManager::create_microbench_bmm_instructions() {
 			//Write the results now : 2 vec stores
 			count = 0;
 			while(count < vec_store_per_batch) {
-				int reg	= m_mbench_regs[0];
-				m_mbench_regs.erase(m_mbench_regs.begin());
+				int reg	= m_mbench_regs.front();
+				m_mbench_regs.pop_front();
 				Instruction *store = 
 					create_single_store(
 					(res_store_ins_addr+(count*16)), reg); 
@@ -2606,8 +2194,8 @@ void MemoryManager::create_microbench_bmm_instructions() {
 			}
 			int row_reg_size = row_regs.size();
 			while(row_reg_size) {
-				m_mbench_regs.push_back(row_regs[0]);
-				row_regs.erase(row_regs.begin());
+				m_mbench_regs.push_back(row_regs.front());
+				row_regs.pop_front();
 				--row_reg_size;
 			}
 			assert(row_regs.size() == 0);
@@ -2683,31 +2271,8 @@ void MemoryManager::create_microbench_pic_search_instructions() {
 		total_pairs	= m_microbench_loopsize/64;
 	if(m_mbench_src_ins.size() == 0) {
 		while(total_pairs) {
-			OperandList load_list;
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		load_inst->setAddress(m_mbench_src_inst_addr);
-  		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst->setAtomic(false);
-  		load_inst->setDisassembly("");
-	
-  		std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-  		MicroOp *currentLMicroOp = new MicroOp();
-  		currentLMicroOp->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , 8
-  		 );
-    	currentLMicroOp->setOperandSize(64); 
-    	currentLMicroOp->setInstruction(load_inst);
-    	currentLMicroOp->setFirst(true);
-    	currentLMicroOp->setLast(true);
-
-   		load_uops->push_back(currentLMicroOp);
-   		load_inst->setMicroOps(load_uops);
-			m_mbench_src_ins.push_back(load_inst);
+			m_mbench_src_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, -1, 8));
 			--total_pairs;
 		}
 	}
@@ -2737,7 +2302,7 @@ void MemoryManager::create_microbench_pic_search_instructions() {
 			pii.is_vpic	= false;
 			pii.count		= 0;
 		}
-		picInsInfoMap[m_mbench_dest_addr] 	= pii;
+		m_mbench_src_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 		if(m_pic_use_vpic) {
 			m_mbench_dest_addr	= m_mbench_dest_addr +
 							(m_microbench_loopsize < 512 ? m_microbench_loopsize : 512);
@@ -2758,31 +2323,8 @@ void MemoryManager::create_microbench_pic_comp_instructions() {
 		total_pairs	= m_microbench_loopsize/64;
 	if(m_mbench_src_ins.size() == 0) {
 		while(total_pairs) {
-			OperandList load_list;
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		load_inst->setAddress(m_mbench_src_inst_addr);
-  		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst->setAtomic(false);
-  		load_inst->setDisassembly("");
-	
-  		std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-  		MicroOp *currentLMicroOp = new MicroOp();
-  		currentLMicroOp->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , 8
-  		 );
-    	currentLMicroOp->setOperandSize(64); 
-    	currentLMicroOp->setInstruction(load_inst);
-    	currentLMicroOp->setFirst(true);
-    	currentLMicroOp->setLast(true);
-
-   		load_uops->push_back(currentLMicroOp);
-   		load_inst->setMicroOps(load_uops);
-			m_mbench_src_ins.push_back(load_inst);
+			m_mbench_src_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, -1, 8));
 			--total_pairs;
 		}
 	}
@@ -2812,7 +2354,7 @@ void MemoryManager::create_microbench_pic_comp_instructions() {
 			pii.is_vpic	= false;
 			pii.count		= 0;
 		}
-		picInsInfoMap[m_mbench_src_addr] 	= pii;
+		m_mbench_src_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 		if(m_pic_use_vpic) {
 			m_mbench_src_addr 	= m_mbench_src_addr + 
 							(m_microbench_loopsize < 512 ? m_microbench_loopsize : 512);
@@ -2834,35 +2376,8 @@ void MemoryManager::create_microbench_pic_copy_instructions() {
 		total_pairs	= m_microbench_loopsize/64;
 	if(m_mbench_dest_ins.size() == 0) {
 		while(total_pairs) {
-			OperandList store_list;
-   		store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		Instruction *store_inst = new GenericInstruction(store_list);
-   		store_inst->setAddress(m_mbench_dest_inst_addr);
-   		store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-   		store_inst->setAtomic(false);
-   		store_inst->setDisassembly("");
-	
-			std::vector<const MicroOp *> *store_uops 
-															= new std::vector<const MicroOp*>();;
-   		MicroOp *currentSMicroOp = new MicroOp();
-   		currentSMicroOp->setInstructionPointer(
-				Memory::make_access(m_mbench_dest_inst_addr));
-    	currentSMicroOp->makeStore(
-    		0
-				,0
-      	, XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-      	, "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-      	, 8 //memop_load_size[0]
-     	);
-
-    	currentSMicroOp->setOperandSize(64); 
-    	currentSMicroOp->setInstruction(store_inst);
-    	currentSMicroOp->setFirst(true);
-    	currentSMicroOp->setLast(true);
-
-   		store_uops->push_back(currentSMicroOp);
-   		store_inst->setMicroOps(store_uops);
-			m_mbench_dest_ins.push_back(store_inst);
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_dest_inst_addr, -1, 8));
 			--total_pairs;
 		}
 	}
@@ -2892,7 +2407,7 @@ void MemoryManager::create_microbench_pic_copy_instructions() {
 			pii.is_vpic	= false;
 			pii.count		= 0;
 		}
-		picInsInfoMap[m_mbench_dest_addr] 	= pii;
+		m_mbench_dest_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 
 		if(m_pic_use_vpic) {
 			m_mbench_src_addr += m_microbench_loopsize;
@@ -2909,96 +2424,20 @@ void MemoryManager::create_microbench_search_instructions() {
 	int total_pairs	= m_microbench_loopsize/m_microbench_opsize;
 	//Create
 	if(m_mbench_dest_ins.size() == 0) {
-		int reg1	= m_mbench_regs[0];
-		m_mbench_regs.erase(m_mbench_regs.begin());
-		OperandList load_list1;
-		load_list1.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  	load_list1.push_back(Operand(Operand::REG, reg1, Operand::WRITE, 
-																													"", true));
-  	Instruction *load_inst1 = new GenericInstruction(load_list1);
-		load_inst1->setAddress(m_mbench_src_inst_addr);
-  	load_inst1->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  	load_inst1->setAtomic(false);
-  	load_inst1->setDisassembly("");
-  	std::vector<const MicroOp *> *load_uops1 
-														= new std::vector<const MicroOp*>();
-  	MicroOp *currentLMicroOp1 = new MicroOp();
-  	currentLMicroOp1->makeLoad(
-  		0
-  	  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  	  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  	  , m_microbench_opsize //memop_load_size[0]
-  	 );
-  	currentLMicroOp1->addDestinationRegister((xed_reg_enum_t)reg1, ""); 
-  	currentLMicroOp1->setOperandSize(64); 
-  	currentLMicroOp1->setInstruction(load_inst1);
-  	currentLMicroOp1->setFirst(true);
-  	currentLMicroOp1->setLast(true);
-  	load_uops1->push_back(currentLMicroOp1);
-  	load_inst1->setMicroOps(load_uops1);
-		m_mbench_src_ins.push_back(load_inst1);
+		int reg1	= m_mbench_regs.front();
+		m_mbench_regs.pop_front();
+		m_mbench_src_ins.push_back(
+			m_synthetic_ins.getLoad(m_mbench_src_inst_addr, reg1, m_microbench_opsize));
 
 		while(total_pairs) {
-			OperandList load_list2;
-			OperandList comp_list;
-			int reg2	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int reg2	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			m_mbench_regs.push_back(reg2);
-			load_list2.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list2.push_back(Operand(Operand::REG, reg2, Operand::WRITE, 
-																														"", true));
-			comp_list.push_back(Operand(Operand::REG, reg1, Operand::READ,
-																														"", true));
-			comp_list.push_back(Operand(Operand::REG, reg2, Operand::READ,
-																														"", true));
-  		comp_list.push_back(Operand(Operand::REG, reg1, Operand::WRITE, 
-																														"", true));
-  		Instruction *load_inst2 = new GenericInstruction(load_list2);
-  		Instruction *comp_inst 	= new GenericInstruction(comp_list);
-			load_inst2->setAddress(m_mbench_dest_inst_addr);
-			comp_inst->setAddress(m_mbench_comp_inst_addr);
-  		load_inst2->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst2->setAtomic(false);
-  		load_inst2->setDisassembly("");
-			comp_inst->setSize(4);
-			comp_inst->setAtomic(false);
-			comp_inst->setDisassembly("");
-			//Create uops for these instructions..
-			std::vector<const MicroOp *> *load_uops2 
-															= new std::vector<const MicroOp*>();;
-			std::vector<const MicroOp *> *cmp_uops
-															= new std::vector<const MicroOp*>();;
-  		MicroOp *currentLMicroOp2 = new MicroOp();
-  		MicroOp *currentMicroOp 	= new MicroOp();
-  		currentLMicroOp2->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentMicroOp->makeExecute(
-  			0, 0
-  		  , XED_ICLASS_CMP //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , false	//not conditional branch
-  		 );
-			currentLMicroOp2->addDestinationRegister((xed_reg_enum_t)reg2, ""); 
-  		currentLMicroOp2->setOperandSize(64); 
-  		currentLMicroOp2->setInstruction(load_inst2);
-  		currentLMicroOp2->setFirst(true);
-  		currentLMicroOp2->setLast(true);
-  		load_uops2->push_back(currentLMicroOp2);
-  		load_inst2->setMicroOps(load_uops2);
-  		currentMicroOp->addSourceRegister((xed_reg_enum_t)reg1, "");
-  		currentMicroOp->addSourceRegister((xed_reg_enum_t)reg2, "");
-  		currentMicroOp->setOperandSize(64); 
-  		currentMicroOp->setInstruction(comp_inst);
-  		currentMicroOp->setFirst(true);
-  		currentMicroOp->setLast(true);
-  		cmp_uops->push_back(currentMicroOp);
-  		comp_inst->setMicroOps(cmp_uops);
-			m_mbench_dest_ins.push_back(load_inst2);
-			m_mbench_comp_ins.push_back(comp_inst);
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_dest_inst_addr, reg2, m_microbench_opsize));
+			m_mbench_comp_ins.push_back(
+				m_synthetic_ins.getExecute(m_mbench_comp_inst_addr, XED_ICLASS_CMP,
+					reg1, reg2, -1));
 			--total_pairs;
 		}
 	}
@@ -3027,106 +2466,21 @@ void MemoryManager::create_microbench_comp_instructions() {
 	//Create
 	if(m_mbench_src_ins.size() == 0) {
 		while(total_pairs) {
-			OperandList load_list1;
-			OperandList load_list2;
-			OperandList comp_list;
-			int reg1	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int reg1	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			m_mbench_regs.push_back(reg1);
 
-			int reg2	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int reg2	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			m_mbench_regs.push_back(reg2);
 
-			load_list1.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list1.push_back(Operand(Operand::REG, reg1, Operand::WRITE, 
-																														"", true));
-			load_list2.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list2.push_back(Operand(Operand::REG, reg2, Operand::WRITE, 
-																														"", true));
-
-			comp_list.push_back(Operand(Operand::REG, reg1, Operand::READ,
-																														"", true));
-			comp_list.push_back(Operand(Operand::REG, reg2, Operand::READ,
-																														"", true));
-  		comp_list.push_back(Operand(Operand::REG, reg1, Operand::WRITE, 
-																														"", true));
-
-  		Instruction *load_inst1 = new GenericInstruction(load_list1);
-  		Instruction *load_inst2 = new GenericInstruction(load_list2);
-  		Instruction *comp_inst 	= new GenericInstruction(comp_list);
-  		
-			load_inst1->setAddress(m_mbench_src_inst_addr);
-			load_inst2->setAddress(m_mbench_dest_inst_addr);
-			comp_inst->setAddress(m_mbench_comp_inst_addr);
-
-  		load_inst1->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst2->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-			comp_inst->setSize(4);
-  		load_inst1->setAtomic(false);
-  		load_inst2->setAtomic(false);
-			comp_inst->setAtomic(false);
-  		load_inst1->setDisassembly("");
-  		load_inst2->setDisassembly("");
-			comp_inst->setDisassembly("");
-
-			//Create uops for these instructions..
-  		std::vector<const MicroOp *> *load_uops1 
-															= new std::vector<const MicroOp*>();
-			std::vector<const MicroOp *> *load_uops2 
-															= new std::vector<const MicroOp*>();;
-			std::vector<const MicroOp *> *cmp_uops
-															= new std::vector<const MicroOp*>();;
-
-  		MicroOp *currentLMicroOp1 = new MicroOp();
-  		MicroOp *currentLMicroOp2 = new MicroOp();
-  		MicroOp *currentMicroOp 	= new MicroOp();
-  		currentLMicroOp1->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentLMicroOp2->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentMicroOp->makeExecute(
-  			0, 0
-  		  , XED_ICLASS_CMP //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , false	//not conditional branch
-  		 );
-  		currentLMicroOp1->addDestinationRegister((xed_reg_enum_t)reg1, ""); 
-  		currentLMicroOp1->setOperandSize(64); 
-  		currentLMicroOp1->setInstruction(load_inst1);
-  		currentLMicroOp1->setFirst(true);
-  		currentLMicroOp1->setLast(true);
-  		load_uops1->push_back(currentLMicroOp1);
-  		load_inst1->setMicroOps(load_uops1);
-  		
-			currentLMicroOp2->addDestinationRegister((xed_reg_enum_t)reg2, ""); 
-  		currentLMicroOp2->setOperandSize(64); 
-  		currentLMicroOp2->setInstruction(load_inst2);
-  		currentLMicroOp2->setFirst(true);
-  		currentLMicroOp2->setLast(true);
-  		load_uops2->push_back(currentLMicroOp2);
-  		load_inst2->setMicroOps(load_uops2);
-
-  		currentMicroOp->addSourceRegister((xed_reg_enum_t)reg1, "");
-  		currentMicroOp->addSourceRegister((xed_reg_enum_t)reg2, "");
-  		currentMicroOp->setOperandSize(64); 
-  		currentMicroOp->setInstruction(comp_inst);
-  		currentMicroOp->setFirst(true);
-  		currentMicroOp->setLast(true);
-  		cmp_uops->push_back(currentMicroOp);
-  		comp_inst->setMicroOps(cmp_uops);
-
-			m_mbench_src_ins.push_back(load_inst1);
-			m_mbench_dest_ins.push_back(load_inst2);
-			m_mbench_comp_ins.push_back(comp_inst);
+			m_mbench_src_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, reg1, m_microbench_opsize));
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_dest_inst_addr, reg2, m_microbench_opsize));
+			m_mbench_comp_ins.push_back(
+				m_synthetic_ins.getExecute(m_mbench_comp_inst_addr, XED_ICLASS_CMP,
+					reg1, reg2, -1));
 			--total_pairs;
 		}
 	}
@@ -3155,63 +2509,13 @@ void MemoryManager::create_microbench_copy_instructions() {
 	//Create
 	if(m_mbench_src_ins.size() == 0) {
 		while(total_pairs) {
-			OperandList load_list;
-			OperandList store_list;
-			int reg	= m_mbench_regs[0];
-			m_mbench_regs.erase(m_mbench_regs.begin());
+			int reg	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
 			m_mbench_regs.push_back(reg);
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-  		load_list.push_back(Operand(Operand::REG, reg, Operand::WRITE, 
-																														"", true));
-  		store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		store_list.push_back(Operand(Operand::REG, reg, Operand::READ, 
-																														 "", true));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		Instruction *store_inst = new GenericInstruction(store_list);
-  		load_inst->setAddress(m_mbench_src_inst_addr);
-  		store_inst->setAddress(m_mbench_dest_inst_addr);
-  		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  		load_inst->setAtomic(false);
-  		load_inst->setDisassembly("");
-  		store_inst->setAtomic(false);
-  		store_inst->setDisassembly("");
-			//Create uops for these instructions..
-  		std::vector<const MicroOp *> *load_uops 
-															= new std::vector<const MicroOp*>();
-			std::vector<const MicroOp *> *store_uops 
-															= new std::vector<const MicroOp*>();;
-  		MicroOp *currentLMicroOp = new MicroOp();
-  		MicroOp *currentSMicroOp = new MicroOp();
-  		currentLMicroOp->makeLoad(
-  			0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentSMicroOp->makeStore(
-  			0
-				,0
-  		  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-  		  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-  		  , m_microbench_opsize //memop_load_size[0]
-  		 );
-  		currentLMicroOp->addDestinationRegister((xed_reg_enum_t)reg, ""); 
-  		currentSMicroOp->addSourceRegister((xed_reg_enum_t)reg, "");
-  		currentLMicroOp->setOperandSize(64); 
-  		currentLMicroOp->setInstruction(load_inst);
-  		currentLMicroOp->setFirst(true);
-  		currentLMicroOp->setLast(true);
-  		load_uops->push_back(currentLMicroOp);
-  		load_inst->setMicroOps(load_uops);
-  		currentSMicroOp->setOperandSize(64); 
-  		currentSMicroOp->setInstruction(store_inst);
-  		currentSMicroOp->setFirst(true);
-  		currentSMicroOp->setLast(true);
-  		store_uops->push_back(currentSMicroOp);
-  		store_inst->setMicroOps(store_uops);
-			m_mbench_src_ins.push_back(load_inst);
-			m_mbench_dest_ins.push_back(store_inst);
+			m_mbench_src_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, reg, m_microbench_opsize));
+			m_mbench_dest_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_dest_inst_addr, reg, m_microbench_opsize));
 			--total_pairs;
 		}
 	}
@@ -3235,16 +2539,367 @@ void MemoryManager::create_microbench_copy_instructions() {
 	}
 }
 
-//#ifdef PIC_ENABLE_CHECKPOINT
-UInt64 MemoryManager::getCheckpointInstructionsCount() {
-	if(m_pic_on) {
-		if(m_pic_use_vpic)
-			return m_num_checkpoints; //a instruction per checkpoint
+//Kernel spec, [general/microbench_kernel]. Every key has a default, the
+//operand arrays default to two adjacent general/microbench_totalsize arrays.
+//op is a mix of name[:weight] entries separated by spaces or '+', e.g.
+//"copy:3 bmm", a missing weight is 1.
+void MemoryManager::init_microbench_kernel() {
+	String section = "general/microbench_kernel/";
+	config::Config *cfg = Sim()->getCfg();
+	m_mbench_kernel.name = cfg->hasKey(section + "op") ? 
+											cfg->getString(section + "op") : "copy";
+	m_mbench_kernel.total_weight = 0;
+	String spec = m_mbench_kernel.name;
+	for(size_t pos = 0, end; pos < spec.size(); pos = end + 1) {
+		end = spec.find_first_of(" \t,+", pos);
+		if(end == String::npos)
+			end = spec.size();
+		if(end == pos)
+			continue;
+		String entry = spec.substr(pos, end - pos);
+		size_t colon = entry.find(':');
+		MicrobenchKernelOp kop;
+		kop.name		= entry.substr(0, colon);
+		kop.weight	= (colon == String::npos) ? 1 
+									: strtoul(entry.substr(colon + 1).c_str(), NULL, 10);
+		kop.logic		= CacheCntlr::PIC_LOGIC_OR;
+		kop.opsize	= m_microbench_opsize;
+		kop.credit	= 0;
+		kop.ops			= 0;
+		if(kop.name == "copy")
+			kop.op = CacheCntlr::PIC_COPY;
+		else if(kop.name == "cmp")
+			kop.op = CacheCntlr::PIC_CMP;
+		else if(kop.name == "search")
+			kop.op = CacheCntlr::PIC_SEARCH;
+		else if(kop.name == "and" || kop.name == "or" || kop.name == "xor") {
+			kop.op = CacheCntlr::PIC_LOGICAL;
+			kop.logic = (kop.name == "and") ? CacheCntlr::PIC_LOGIC_AND 
+								: (kop.name == "xor") ? CacheCntlr::PIC_LOGIC_XOR
+								: CacheCntlr::PIC_LOGIC_OR;
+		}
+		//FastBit bitmap index merge: dest |= source, the baseline on AVX2
+		//vectors as the FASTBIT microbenchmark
+		else if(kop.name == "fastbit") {
+			kop.op			= CacheCntlr::PIC_LOGICAL;
+			kop.opsize	= 32;
+		}
+		//Bit matrix multiply, each line of 8 64 bit rows times a 64x64 bit
+		//matrix with carry-less multiplies
+		else if(kop.name == "bmm") {
+			kop.op			= CacheCntlr::PIC_CLMULT;
+			kop.opsize	= 32;
+		}
 		else
-			return m_num_checkpoints * (CHKPT_PAGE_SIZE/64);
+			LOG_PRINT_ERROR("PIC: unknown microbenchmark kernel op %s", kop.name.c_str());
+		LOG_ASSERT_ERROR(kop.weight > 0, "PIC: microbenchmark kernel op %s has weight 0", 
+			entry.c_str());
+		for(UInt32 i = 0; i < m_mbench_kernel.ops.size(); ++i)
+			LOG_ASSERT_ERROR(m_mbench_kernel.ops[i].name != kop.name,
+				"PIC: microbenchmark kernel op %s is in the mix twice", kop.name.c_str());
+		m_mbench_kernel.ops.push_back(kop);
+		m_mbench_kernel.total_weight += kop.weight;
 	}
-	else
-		return m_num_checkpoints * 2 * (CHKPT_PAGE_SIZE/m_chkpt_opsize);
+	LOG_ASSERT_ERROR(m_mbench_kernel.ops.size(), "PIC: microbenchmark kernel op mix is empty");
+
+	m_mbench_kernel.footprint = cfg->hasKey(section + "footprint") ? 
+											cfg->getInt(section + "footprint") 
+											: cfg->getInt("general/microbench_totalsize");
+	m_mbench_kernel.stride = cfg->hasKey(section + "stride") ? 
+											cfg->getInt(section + "stride") : 64;
+	m_mbench_kernel.operand_distance = cfg->hasKey(section + "operand_distance") ? 
+											cfg->getInt(section + "operand_distance") : m_mbench_kernel.footprint;
+	m_mbench_kernel.vector_length = cfg->hasKey(section + "vector_length") ? 
+											cfg->getInt(section + "vector_length") : 1;
+
+	LOG_ASSERT_ERROR(m_mbench_kernel.stride >= 64 && (m_mbench_kernel.stride % 64) == 0,
+		"PIC: microbenchmark kernel stride %lu is not a multiple of the line size", m_mbench_kernel.stride);
+	LOG_ASSERT_ERROR(m_mbench_kernel.vector_length >= 1 
+		&& (m_mbench_kernel.vector_length == 1 || m_mbench_kernel.stride == 64),
+		"PIC: vector PIC ops cover consecutive lines, vector_length %u needs stride 64", 
+		m_mbench_kernel.vector_length);
+	LOG_ASSERT_ERROR(m_microbench_opsize > 0 && m_microbench_opsize <= 64 
+		&& (64 % m_microbench_opsize) == 0,
+		"PIC: general/microbench_opsize %lu does not divide a line", m_microbench_opsize);
+	LOG_ASSERT_ERROR(m_mbench_kernel.operand_distance >= m_mbench_kernel.footprint,
+		"PIC: microbenchmark kernel operands overlap, operand_distance %lu < footprint %lu",
+		m_mbench_kernel.operand_distance, m_mbench_kernel.footprint);
+
+	//One loop is one vector worth of lines of each operand
+	m_microbench_loopsize		= m_mbench_kernel.vector_length * m_mbench_kernel.stride;
+	m_microbench_totalsize	= m_mbench_kernel.footprint;
+	LOG_ASSERT_ERROR(m_microbench_totalsize >= m_microbench_loopsize 
+		&& (m_microbench_totalsize % m_microbench_loopsize) == 0,
+		"PIC: microbenchmark kernel footprint %lu is not a multiple of %u lines at stride %lu",
+		m_microbench_totalsize, m_mbench_kernel.vector_length, m_mbench_kernel.stride);
+
+	m_mbench_kernel_ops = 0;
+	registerStatsMetric("microbench", m_core_id_master, "kernel-ops", &m_mbench_kernel_ops);
+	for(UInt32 i = 0; i < m_mbench_kernel.ops.size(); ++i)
+		registerStatsMetric("microbench", m_core_id_master, 
+			"kernel-ops-" + m_mbench_kernel.ops[i].name, &m_mbench_kernel.ops[i].ops);
+	printf("\nKERNEL(%s): footprint=%lu, stride=%lu, distance=%lu, vector=%u, opsize=%lu",
+		m_mbench_kernel.name.c_str(), m_mbench_kernel.footprint, m_mbench_kernel.stride,
+		m_mbench_kernel.operand_distance, m_mbench_kernel.vector_length, m_microbench_opsize);
+}
+
+//Smooth weighted round-robin: every op gains its weight, the richest runs
+//and pays the total. Each period of total_weight loops runs every op
+//weight times, spread out rather than in bursts.
+UInt32 MemoryManager::next_microbench_kernel_op(
+				std::vector<MicrobenchKernelOp>& ops, UInt32 total_weight) {
+	UInt32 next = 0;
+	for(UInt32 i = 0; i < ops.size(); ++i) {
+		ops[i].credit += ops[i].weight;
+		if(ops[i].credit > ops[next].credit)
+			next = i;
+	}
+	ops[next].credit -= total_weight;
+	return next;
+}
+
+//bmm per line: 2 row loads, 16 matrix loads, 8x64 clmults and 2 stores
+#define PIC_MBENCH_BMM_INS_PER_LINE (2 + 16 + 8 * 64 + 2)
+
+IntPtr MemoryManager::microbench_kernel_ins_per_iteration(const MicrobenchKernelOp& kop) {
+	//A PIC loop is a single vector op, or a single scalar op on one line.
+	//bmm takes one clmult op per line.
+	if(m_pic_on)
+		return (kop.op == CacheCntlr::PIC_CLMULT) ? m_mbench_kernel.vector_length : 1;
+	IntPtr words = 64 / kop.opsize;
+	IntPtr ins_per_line;
+	switch(kop.op) {
+		case CacheCntlr::PIC_COPY:			ins_per_line = 2 * words; break;	//ld, st
+		case CacheCntlr::PIC_CMP:				ins_per_line = 3 * words; break;	//ld, ld, cmp
+		case CacheCntlr::PIC_SEARCH:		ins_per_line = 2 * words; break;	//ld, cmp
+		case CacheCntlr::PIC_CLMULT:		ins_per_line = PIC_MBENCH_BMM_INS_PER_LINE; break;
+		default:												ins_per_line = 4 * words; break;	//ld, ld, op, st
+	}
+	//search loads its key once per loop
+	return m_mbench_kernel.vector_length * ins_per_line 
+					+ (kop.op == CacheCntlr::PIC_SEARCH ? 1 : 0);
+}
+
+void MemoryManager::create_microbench_pic_kernel_instructions(MicrobenchKernelOp& kop) {
+	UInt32 vector_length = m_mbench_kernel.vector_length;
+	struct PicInsInfo pii;
+	if(kop.op == CacheCntlr::PIC_CLMULT) {
+		//One clmult op per line: the row line times the 8 matrix lines, the
+		//result row line written to the destination line
+		for(UInt32 line = 0; line < vector_length; ++line) {
+			m_mbench_kernel_ins.push_back(m_synthetic_ins.getStore(m_mbench_dest_inst_addr, -1, 8));
+			DynamicInstructionInfo info = DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_dest_inst_addr, true, SubsecondTime::Zero(), m_mbench_dest_addr, 64, 
+				Operand::WRITE, 0, HitWhere::UNKNOWN);
+			pii.op						= CacheCntlr::PIC_CLMULT;
+			pii.logic					= kop.logic;
+			pii.other_source	= m_mbench_kernel.matrix_addr;	//column data
+			pii.other_source2	= m_mbench_src_addr;						//row data
+			pii.is_vpic				= true;
+			pii.count					= 64;														//matrix dimension
+			info.memory_info.accel_op = newPicOp(pii, m_microbench_run);
+			m_mbench_dest_dyn_ins_info.push_back(info);
+			m_mbench_src_addr		+= m_mbench_kernel.stride;
+			m_mbench_dest_addr	+= m_mbench_kernel.stride;
+		}
+		kop.ops							+= vector_length;
+		m_mbench_kernel_ops	+= vector_length;
+		return;
+	}
+
+	bool is_vpic	= (vector_length > 1) || (kop.op == CacheCntlr::PIC_LOGICAL);
+	bool is_write	= (kop.op == CacheCntlr::PIC_COPY) 
+								|| (kop.op == CacheCntlr::PIC_LOGICAL);
+	//The tagged access is the destination line, except for cmp which, as the
+	//other cmp microbenchmark, tags the source line
+	bool tag_src	= (kop.op == CacheCntlr::PIC_CMP);
+	IntPtr ins_addr = is_write ? m_mbench_dest_inst_addr : m_mbench_src_inst_addr;
+
+	m_mbench_kernel_ins.push_back(m_synthetic_ins.getStore(ins_addr, -1, 8));
+	DynamicInstructionInfo info = DynamicInstructionInfo::createMemoryInfo(
+		ins_addr, true, SubsecondTime::Zero(), 
+		tag_src ? m_mbench_src_addr : m_mbench_dest_addr, 64, 
+		is_write ? Operand::WRITE : Operand::READ, 0, HitWhere::UNKNOWN);
+
+	pii.op						= kop.op;
+	pii.logic					= kop.logic;
+	pii.other_source	= tag_src ? m_mbench_dest_addr : m_mbench_src_addr;
+	pii.other_source2	= 0;
+	pii.is_vpic				= is_vpic;
+	pii.count					= is_vpic ? vector_length : 0;
+	info.memory_info.accel_op = newPicOp(pii, m_microbench_run);
+	m_mbench_dest_dyn_ins_info.push_back(info);
+
+	//search keeps matching the same key line against the next data lines
+	if(kop.op != CacheCntlr::PIC_SEARCH)
+		m_mbench_src_addr		+= m_microbench_loopsize;
+	m_mbench_dest_addr	+= m_microbench_loopsize;
+	kop.ops							+= vector_length;
+	m_mbench_kernel_ops	+= vector_length;
+}
+
+//bmm baseline, as the BMM microbenchmark a clmult is modelled as a cmp. Per
+//line: the 8 rows in two 32 byte loads, then per 32 byte load of 4 matrix
+//columns a clmult of every row with each, and the result line in two stores.
+void MemoryManager::create_microbench_bmm_kernel_instructions() {
+	for(UInt32 line = 0; line < m_mbench_kernel.vector_length; ++line) {
+		int row_regs[2], res_regs[2];
+		for(int half = 0; half < 2; ++half) {
+			row_regs[half]	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, row_regs[half], 32));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_src_inst_addr, true, SubsecondTime::Zero(), m_mbench_src_addr + half * 32, 32, 
+				Operand::READ, 0, HitWhere::UNKNOWN));
+		}
+		for(int half = 0; half < 2; ++half) {
+			res_regs[half]	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
+		}
+
+		for(IntPtr offset = 0; offset < 512; offset += 32) {
+			int col_reg	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
+			m_mbench_regs.push_back(col_reg);
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_comp_inst_addr, col_reg, 32));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_comp_inst_addr, true, SubsecondTime::Zero(), 
+				m_mbench_kernel.matrix_addr + offset, 32, Operand::READ, 0, HitWhere::UNKNOWN));
+			for(int row = 0; row < 8; ++row)
+				for(int column = 0; column < 4; ++column)
+					m_mbench_kernel_ins.push_back(create_single_cmp(m_mbench_comp_inst_addr+16, 
+						row_regs[row / 4], col_reg, res_regs[row / 4]));
+		}
+
+		for(int half = 0; half < 2; ++half) {
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_dest_inst_addr, res_regs[half], 32));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_dest_inst_addr, true, SubsecondTime::Zero(), m_mbench_dest_addr + half * 32, 32, 
+				Operand::WRITE, 0, HitWhere::UNKNOWN));
+			m_mbench_regs.push_back(row_regs[half]);
+			m_mbench_regs.push_back(res_regs[half]);
+		}
+		m_mbench_src_addr		+= m_mbench_kernel.stride;
+		m_mbench_dest_addr	+= m_mbench_kernel.stride;
+	}
+}
+
+void MemoryManager::create_microbench_kernel_instructions(MicrobenchKernelOp& kop) {
+	if(kop.op == CacheCntlr::PIC_CLMULT) {
+		create_microbench_bmm_kernel_instructions();
+		kop.ops							+= m_mbench_kernel.vector_length;
+		m_mbench_kernel_ops	+= m_mbench_kernel.vector_length;
+		return;
+	}
+
+	IntPtr opsize		= kop.opsize;
+	IntPtr key_addr	= m_mbench_src_addr;
+	int key_reg = -1;
+	if(kop.op == CacheCntlr::PIC_SEARCH) {
+		key_reg	= m_mbench_regs.front();
+		m_mbench_regs.pop_front();
+		m_mbench_kernel_ins.push_back(
+			m_synthetic_ins.getLoad(m_mbench_src_inst_addr, key_reg, opsize));
+		m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+			m_mbench_src_inst_addr, true, SubsecondTime::Zero(), key_addr, opsize, 
+			Operand::READ, 0, HitWhere::UNKNOWN));
+	}
+
+	for(UInt32 line = 0; line < m_mbench_kernel.vector_length; ++line) {
+		for(IntPtr offset = 0; offset < 64; offset += opsize) {
+			IntPtr src	= m_mbench_src_addr + offset;
+			IntPtr dest	= m_mbench_dest_addr + offset;
+			int reg1	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
+			m_mbench_regs.push_back(reg1);
+
+			if(kop.op == CacheCntlr::PIC_SEARCH) {
+				m_mbench_kernel_ins.push_back(
+					m_synthetic_ins.getLoad(m_mbench_dest_inst_addr, reg1, opsize));
+				m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+					m_mbench_dest_inst_addr, true, SubsecondTime::Zero(), dest, opsize, 
+					Operand::READ, 0, HitWhere::UNKNOWN));
+				m_mbench_kernel_ins.push_back(
+					m_synthetic_ins.getExecute(m_mbench_comp_inst_addr, XED_ICLASS_CMP,
+						key_reg, reg1, -1));
+				continue;
+			}
+
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_src_inst_addr, reg1, opsize));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_src_inst_addr, true, SubsecondTime::Zero(), src, opsize, 
+				Operand::READ, 0, HitWhere::UNKNOWN));
+			if(kop.op == CacheCntlr::PIC_COPY) {
+				m_mbench_kernel_ins.push_back(
+					m_synthetic_ins.getStore(m_mbench_dest_inst_addr, reg1, opsize));
+				m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+					m_mbench_dest_inst_addr, true, SubsecondTime::Zero(), dest, opsize, 
+					Operand::WRITE, 0, HitWhere::UNKNOWN));
+				continue;
+			}
+
+			int reg2	= m_mbench_regs.front();
+			m_mbench_regs.pop_front();
+			m_mbench_regs.push_back(reg2);
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getLoad(m_mbench_dest_inst_addr, reg2, opsize));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_dest_inst_addr, true, SubsecondTime::Zero(), dest, opsize, 
+				Operand::READ, 0, HitWhere::UNKNOWN));
+			if(kop.op == CacheCntlr::PIC_CMP) {
+				m_mbench_kernel_ins.push_back(
+					m_synthetic_ins.getExecute(m_mbench_comp_inst_addr, XED_ICLASS_CMP,
+						reg1, reg2, -1));
+				continue;
+			}
+
+			//dest = dest OP source
+			xed_iclass_enum_t iclass = (kop.logic == CacheCntlr::PIC_LOGIC_AND) ? XED_ICLASS_AND
+											: (kop.logic == CacheCntlr::PIC_LOGIC_XOR) ? XED_ICLASS_XOR
+											: XED_ICLASS_OR;
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getExecute(m_mbench_comp_inst_addr, iclass, reg1, reg2, reg2));
+			m_mbench_kernel_ins.push_back(
+				m_synthetic_ins.getStore(m_mbench_comp_inst_addr+16, reg2, opsize));
+			m_mbench_dest_dyn_ins_info.push_back(DynamicInstructionInfo::createMemoryInfo(
+				m_mbench_comp_inst_addr+16, true, SubsecondTime::Zero(), dest, opsize, 
+				Operand::WRITE, 0, HitWhere::UNKNOWN));
+		}
+		if(kop.op != CacheCntlr::PIC_SEARCH)
+			m_mbench_src_addr		+= m_mbench_kernel.stride;
+		m_mbench_dest_addr	+= m_mbench_kernel.stride;
+	}
+	if(key_reg >= 0)
+		m_mbench_regs.push_back(key_reg);
+	kop.ops							+= m_mbench_kernel.vector_length;
+	m_mbench_kernel_ops	+= m_mbench_kernel.vector_length;
+}
+
+//Program order: every load/store takes the next dynamic info
+void MemoryManager::schedule_microbench_kernel_instructions() {
+	while(m_mbench_kernel_ins.size()) {
+		Instruction *ins = m_mbench_kernel_ins.front();
+		const MicroOp *uop = ins->getMicroOps()->front();
+		if(uop->isLoad() || uop->isStore()) {
+			assert(m_mbench_dest_dyn_ins_info.size());
+  		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
+																		(m_mbench_dest_dyn_ins_info.front(), true);
+			m_mbench_dest_dyn_ins_info.pop_front();
+		}
+  	getCore()->getPerformanceModel()->queueInstruction(ins, true);
+		m_mbench_kernel_ins.pop_front();
+	}
+	assert(m_mbench_dest_dyn_ins_info.size() == 0);
+}
+
+//#ifdef PIC_ENABLE_CHECKPOINT
+UInt64 MemoryManager::getCheckpointInstructionsCount() {
+	//Checkpoints copy written lines only, count what they queued
+	return m_chkpt_ins_cnt;
 }
 
 void
@@ -3254,7 +2909,6 @@ MemoryManager::startCheckpointing() {
 			getCore()->getPerformanceModel()->getElapsedTime();
 	m_last_chkpt_ins_cnt =
 			getCore()->getPerformanceModel()->getInstructionCount();
-	m_last_checkpoint_page_addr 	= 0;
   //printf("[CHKPNT]: START\n");
 }
 
@@ -3282,10 +2936,19 @@ MemoryManager::startNewInterval() {
 	return false;
 }
 
-bool
-MemoryManager::needs_checkpointing(IntPtr page_address) {
-	return ((m_checkpointed_pages.find(page_address)
-								== m_checkpointed_pages.end() ));
+void
+MemoryManager::markCheckpointDirty(IntPtr address) {
+	IntPtr page_address	= address - (address % CHKPT_PAGE_SIZE);
+	if(!m_chkpt_last_dirty_mask || (page_address != m_chkpt_last_dirty_page)) {
+		//Checkpoint copies are not checkpointed
+		if((m_no_checkpointed_pages.find(page_address)
+								!= m_no_checkpointed_pages.end()))
+			return;
+		m_chkpt_last_dirty_page	= page_address;
+		m_chkpt_last_dirty_mask	= &m_chkpt_dirty_lines[page_address];
+	}
+	*m_chkpt_last_dirty_mask |= 
+		chkpt_line_mask_t(1) << ((address % CHKPT_PAGE_SIZE) / 64);
 }
 
 void
@@ -3310,21 +2973,10 @@ MemoryManager::inspect_page_access(IntPtr address) {
 			m_last_chkpt_ins_cnt =
 				getCore()->getPerformanceModel()->getInstructionCount() 
 				- getCheckpointInstructionsCount() ;
-			m_checkpointed_pages.clear();
   		//printf("[CHKPNT]: NEW_I\n");
 			m_num_intervals++;
-		}
-		//Was this page accessed before?
-		if(needs_checkpointing(page_address)) {
-			//Need to issue loads/stores
-			m_checkpointed_pages.insert(page_address);
-
-			//Take a checkpoint
-			take_checkpoint(page_address);
-			m_num_checkpoints++;
-
-			//TODO: Remove this
-			//stopCheckpointing();
+			//Copy what the last interval wrote, the caches marked the lines
+			take_checkpoint();
 		}
 	}
 }
@@ -3333,35 +2985,8 @@ void MemoryManager::create_vpic_checkpoint_instructions(int num_pairs,
 	assert((m_chkpt_l_dyn_ins_info.size() == 0) && 
 									(m_chkpt_s_dyn_ins_info.size() == 0));
 	if(m_chkpt_stores.size() == 0) {
-		OperandList store_list;
-  	store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  	Instruction *store_inst = new GenericInstruction(store_list);
-  	store_inst->setAddress(m_chkpt_store_inst_addr);
-  	store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-  	store_inst->setAtomic(false);
-  	store_inst->setDisassembly("");
-	
-		std::vector<const MicroOp *> *store_uops 
-														= new std::vector<const MicroOp*>();;
-  	MicroOp *currentSMicroOp = new MicroOp();
-  	currentSMicroOp->setInstructionPointer(
-			Memory::make_access(m_chkpt_store_inst_addr));
-  	currentSMicroOp->makeStore(
-  		0
-			,0
-    	, XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-    	, "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    	, 8 //memop_load_size[0]
-   	);
-
-  	currentSMicroOp->setOperandSize(64); 
-  	currentSMicroOp->setInstruction(store_inst);
-  	currentSMicroOp->setFirst(true);
-  	currentSMicroOp->setLast(true);
-
-  	store_uops->push_back(currentSMicroOp);
-  	store_inst->setMicroOps(store_uops);
-		m_chkpt_stores.push_back(store_inst);
+		m_chkpt_stores.push_back(
+			m_synthetic_ins.getStore(m_chkpt_store_inst_addr, -1, 8));
 	}
 	//Just before the instruction is looked in handleInstruction.. 
 	//they do this
@@ -3380,7 +3005,7 @@ void MemoryManager::create_vpic_checkpoint_instructions(int num_pairs,
 	pii.other_source2	= 0;
 	pii.is_vpic				= true;
 	pii.count					= num_pairs;
-	picInsInfoMap[s_address] = pii;
+	m_chkpt_s_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 }
 void MemoryManager::create_pic_checkpoint_instructions(int num_pairs, 
 	IntPtr l_address, IntPtr s_address) {
@@ -3389,35 +3014,8 @@ void MemoryManager::create_pic_checkpoint_instructions(int num_pairs,
 	int total_pairs	= num_pairs;
 	if(m_chkpt_stores.size() == 0) {
 		while(total_pairs) {
-			OperandList store_list;
-   		store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-  		Instruction *store_inst = new GenericInstruction(store_list);
-   		store_inst->setAddress(m_chkpt_store_inst_addr);
-   		store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-   		store_inst->setAtomic(false);
-   		store_inst->setDisassembly("");
-	
-			std::vector<const MicroOp *> *store_uops 
-															= new std::vector<const MicroOp*>();;
-   		MicroOp *currentSMicroOp = new MicroOp();
-   		currentSMicroOp->setInstructionPointer(
-				Memory::make_access(m_chkpt_store_inst_addr));
-    	currentSMicroOp->makeStore(
-    		0
-				,0
-      	, XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-      	, "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-      	, 8 //memop_load_size[0]
-     	);
-
-    	currentSMicroOp->setOperandSize(64); 
-    	currentSMicroOp->setInstruction(store_inst);
-    	currentSMicroOp->setFirst(true);
-    	currentSMicroOp->setLast(true);
-
-   		store_uops->push_back(currentSMicroOp);
-   		store_inst->setMicroOps(store_uops);
-			m_chkpt_stores.push_back(store_inst);
+			m_chkpt_stores.push_back(
+				m_synthetic_ins.getStore(m_chkpt_store_inst_addr, -1, 8));
 			--total_pairs;
 		}
 	}
@@ -3439,7 +3037,7 @@ void MemoryManager::create_pic_checkpoint_instructions(int num_pairs,
 		pii.other_source2	= 0;
 		pii.is_vpic								= false;
 		pii.count									= 0;
-		picInsInfoMap[s_address] 	= pii;
+		m_chkpt_s_dyn_ins_info.back().memory_info.accel_op = newPicOp(pii, m_microbench_run);
 		
 		l_address += 64;
 		s_address += 64;
@@ -3449,80 +3047,21 @@ void MemoryManager::create_pic_checkpoint_instructions(int num_pairs,
 
 void MemoryManager::create_checkpoint_instructions(int num_pairs, 
 	IntPtr l_address, IntPtr s_address) {
-	int total_pairs	= num_pairs;
+	//A copy is at most a page, the static loads/stores are reused across copies
+	int total_pairs	= CHKPT_PAGE_SIZE/m_chkpt_opsize;
+	assert(num_pairs <= total_pairs);
 	assert((m_chkpt_l_dyn_ins_info.size() == 0) && 
 									(m_chkpt_s_dyn_ins_info.size() == 0));
 	if(m_chkpt_loads.size() == 0) {
 		while(total_pairs) {
-			OperandList load_list;
-			OperandList store_list;
-
-			int reg	= m_chkpt_regs[0];
-			m_chkpt_regs.erase(m_chkpt_regs.begin());
+			int reg	= m_chkpt_regs.front();
+			m_chkpt_regs.pop_front();
 			m_chkpt_regs.push_back(reg);
 
-			load_list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
-   		load_list.push_back(Operand(Operand::REG, reg, Operand::WRITE, 
-																																	"", true));
-   		store_list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-   		store_list.push_back(Operand(Operand::REG, reg, Operand::READ, 
-																																	"", true));
-  		Instruction *load_inst = new GenericInstruction(load_list);
-  		Instruction *store_inst = new GenericInstruction(store_list);
-   		load_inst->setAddress(m_chkpt_load_inst_addr);
-   		store_inst->setAddress(m_chkpt_store_inst_addr);
-   		load_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-   		store_inst->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
-   		load_inst->setAtomic(false);
-   		load_inst->setDisassembly("");
-   		store_inst->setAtomic(false);
-   		store_inst->setDisassembly("");
-			//Create uops for these instructions..
-   		std::vector<const MicroOp *> *load_uops 
-																= new std::vector<const MicroOp*>();
-			std::vector<const MicroOp *> *store_uops 
-																= new std::vector<const MicroOp*>();;
-    	MicroOp *currentLMicroOp = new MicroOp();
-   		MicroOp *currentSMicroOp = new MicroOp();
-   		//currentLMicroOp->setInstructionPointer(
-					//Memory::make_access(m_chkpt_load_inst_addr));
-   		//currentSMicroOp->setInstructionPointer(
-					//Memory::make_access(m_chkpt_store_inst_addr));
-    	currentLMicroOp->makeLoad(
-    		0
-    	  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-    	  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    	  , m_chkpt_opsize //memop_load_size[0]
-    	 );
-    	currentSMicroOp->makeStore(
-    		0
-				,0
-    	  , XED_ICLASS_MOVQ //TODO: xed_decoded_inst_get_iclass(ins)
-    	  , "" //xed_iclass_enum_t2str(xed_decoded_inst_get_iclass(ins))
-    	  , m_chkpt_opsize //memop_load_size[0]
-    	 );
-    	currentLMicroOp->addDestinationRegister((xed_reg_enum_t)reg, ""); 
-																//String(xed_reg_enum_t2str(reg)
-    	currentSMicroOp->addSourceRegister((xed_reg_enum_t)reg, "");
-    	//currentMicroOp->addAddressRegister(reg, 
-			//String(xed_reg_enum_t2str(reg))); //used in rob timer, ignore for now
-			//xed_decoded_inst_get_operand_width, 8/16/32/64
-    	currentLMicroOp->setOperandSize(64); 
-    	currentLMicroOp->setInstruction(load_inst);
-    	currentLMicroOp->setFirst(true);
-    	currentLMicroOp->setLast(true);
-   		load_uops->push_back(currentLMicroOp);
-   		load_inst->setMicroOps(load_uops);
-
-    	currentSMicroOp->setOperandSize(64); 
-    	currentSMicroOp->setInstruction(store_inst);
-    	currentSMicroOp->setFirst(true);
-    	currentSMicroOp->setLast(true);
-   		store_uops->push_back(currentSMicroOp);
-   		store_inst->setMicroOps(store_uops);
-
-			m_chkpt_loads.push_back(load_inst);
-			m_chkpt_stores.push_back(store_inst);
+			m_chkpt_loads.push_back(
+				m_synthetic_ins.getLoad(m_chkpt_load_inst_addr, reg, m_chkpt_opsize));
+			m_chkpt_stores.push_back(
+				m_synthetic_ins.getStore(m_chkpt_store_inst_addr, reg, m_chkpt_opsize));
 			--total_pairs;
 		}
 	}
@@ -3547,64 +3086,86 @@ void MemoryManager::create_checkpoint_instructions(int num_pairs,
 	}
 }
 
-void MemoryManager::take_checkpoint(IntPtr page_address) {
-  UInt32 cache_block_size = getCacheBlockSize();
-  IntPtr begin_addr = page_address;
-  IntPtr end_addr = page_address + CHKPT_PAGE_SIZE;
-  IntPtr begin_addr_aligned = begin_addr - (begin_addr % cache_block_size);
-  IntPtr end_addr_aligned = end_addr - (end_addr % cache_block_size);
-	IntPtr checkpoint_addr_aligned;
-	//Where to checkpoint???
-	if(m_last_checkpoint_page_addr == 0) {
-		//offset by 2GB
-		checkpoint_addr_aligned = begin_addr_aligned + 
-													(CHKPT_PAGE_SIZE * 524288);
+//Copy the lines written since the last checkpoint. A page checkpoints to a
+//fixed page, so the copy overwrites only the stale lines of its last copy.
+void MemoryManager::take_checkpoint() {
+	UInt64 interval_bytes	= m_chkpt_bytes;
+	for(std::map<IntPtr, chkpt_line_mask_t>::iterator it = m_chkpt_dirty_lines.begin();
+			it != m_chkpt_dirty_lines.end(); ++it) {
+		if(it->second) {
+			checkpoint_page(it->first, it->second);
+			m_num_checkpoints++;
+		}
 	}
-	else {
-		checkpoint_addr_aligned = m_last_checkpoint_page_addr + CHKPT_PAGE_SIZE;
- 	}
+	m_chkpt_dirty_lines.clear();
+	m_chkpt_last_dirty_mask	= NULL;
+
+	interval_bytes	= m_chkpt_bytes - interval_bytes;
+	if(interval_bytes > m_chkpt_interval_bytes_max)
+		m_chkpt_interval_bytes_max = interval_bytes;
+  //printf("[CHKPNT]: %lu bytes\n", interval_bytes);
+}
+
+//One copy per run of consecutive written lines: a vector PIC copy, a PIC
+//copy per line or loads/stores
+void MemoryManager::checkpoint_page(IntPtr page_address, chkpt_line_mask_t dirty) {
+	IntPtr checkpoint_address = page_address + CHKPT_DEST_OFFSET;
 	//Your destination should never be an app page
-	assert((m_app_pages.find(checkpoint_addr_aligned)
+	assert((m_app_pages.find(checkpoint_address)
 								== m_app_pages.end()));
-
-	m_last_checkpoint_page_addr = checkpoint_addr_aligned;
-	m_no_checkpointed_pages.insert(m_last_checkpoint_page_addr);
-	
-  //printf("[CHKPNT]: Taking{%lu: %lu}\n",
-		//begin_addr_aligned, checkpoint_addr_aligned); 
-	assert(begin_addr == begin_addr_aligned);
-	assert(end_addr == end_addr_aligned);
-	if(m_pic_on) {
-		if(m_pic_use_vpic) {
-			create_vpic_checkpoint_instructions(CHKPT_PAGE_SIZE/64, 
-																		begin_addr_aligned, 
-																		checkpoint_addr_aligned);
+	m_no_checkpointed_pages.insert(checkpoint_address);
+
+	UInt32 line = 0;
+	while(dirty) {
+		UInt32 skip = __builtin_ctzll(dirty);
+		dirty >>= skip;
+		line	+= skip;
+		UInt32 run	= (~dirty) ? __builtin_ctzll(~dirty) : 64;
+		dirty	= (run < 64) ? (dirty >> run) : 0;
+
+		IntPtr l_address	= page_address + line * 64;
+		IntPtr s_address	= checkpoint_address + line * 64;
+  	//printf("[CHKPNT]: Taking{%lu: %lu} x %u\n", l_address, s_address, run); 
+		if(m_pic_on) {
+			if(m_pic_use_vpic)
+				create_vpic_checkpoint_instructions(run, l_address, s_address);
+			else
+				create_pic_checkpoint_instructions(run, l_address, s_address);
 		}
 		else {
-			create_pic_checkpoint_instructions(CHKPT_PAGE_SIZE/64, 
-																		begin_addr_aligned, 
-																		checkpoint_addr_aligned);
+			create_checkpoint_instructions(run * 64 / m_chkpt_opsize, 
+																		l_address, s_address);
 		}
+		m_chkpt_ins_cnt	+= schedule_checkpoint_instructions();
+		m_chkpt_lines	+= run;
+		m_chkpt_bytes	+= run * 64;
+		line	+= run;
+	}
+}
+
+//Queue the instructions of one checkpoint copy, returns how many
+UInt64 MemoryManager::schedule_checkpoint_instructions() {
+	UInt64 queued = 0;
+	if(m_pic_on) {
 		unsigned int num_chkpt_pics 	= m_chkpt_stores.size();
+		queued	= num_chkpt_pics;
 		while(num_chkpt_pics) {
   		getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																						(m_chkpt_s_dyn_ins_info[0], true);
   		getCore()->getPerformanceModel()->queueInstruction(
 																						m_chkpt_stores[0], true);
-			m_chkpt_stores.erase(m_chkpt_stores.begin());
-			m_chkpt_s_dyn_ins_info.erase(m_chkpt_s_dyn_ins_info.begin());
+			m_chkpt_stores.pop_front();
+			m_chkpt_s_dyn_ins_info.pop_front();
 			--num_chkpt_pics;
 		}
 		assert(m_chkpt_stores.size() == 0);
 		assert(m_chkpt_s_dyn_ins_info.size() == 0);
 	}
 	else {
-		create_checkpoint_instructions(CHKPT_PAGE_SIZE/m_chkpt_opsize, 
-																		begin_addr_aligned, 
-																		checkpoint_addr_aligned);
-		unsigned int loads_8batches		= (m_chkpt_loads.size()/8);
-		assert(m_chkpt_loads.size() == m_chkpt_l_dyn_ins_info.size());
-		assert(m_chkpt_loads.size() == m_chkpt_s_dyn_ins_info.size());
+		unsigned int loads_8batches		= (m_chkpt_l_dyn_ins_info.size()/8);
+		assert(m_chkpt_loads.size() >= m_chkpt_l_dyn_ins_info.size());
+		assert(m_chkpt_l_dyn_ins_info.size() == m_chkpt_s_dyn_ins_info.size());
+		queued	= 2 * m_chkpt_l_dyn_ins_info.size();
 	
 		unsigned int num_chkpt_loads_cnt = 0;	
 		unsigned int num_chkpt_stores_cnt = 0;	
@@ -3615,7 +3176,7 @@ void MemoryManager::take_checkpoint(IntPtr page_address) {
 			while(counter) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																						(m_chkpt_l_dyn_ins_info[0], true);
-				m_chkpt_l_dyn_ins_info.erase(m_chkpt_l_dyn_ins_info.begin());
+				m_chkpt_l_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_chkpt_loads[num_chkpt_loads_cnt], true);
 				--counter;
@@ -3625,7 +3186,7 @@ void MemoryManager::take_checkpoint(IntPtr page_address) {
 			while(counter) {
   			getCore()->getPerformanceModel()->pushDynamicInstructionInfo
 																						(m_chkpt_s_dyn_ins_info[0], true);
-				m_chkpt_s_dyn_ins_info.erase(m_chkpt_s_dyn_ins_info.begin());
+				m_chkpt_s_dyn_ins_info.pop_front();
   			getCore()->getPerformanceModel()->queueInstruction(
 															m_chkpt_stores[num_chkpt_stores_cnt], true);
 				--counter;
@@ -3641,7 +3202,7 @@ void MemoryManager::take_checkpoint(IntPtr page_address) {
 																						(m_chkpt_l_dyn_ins_info[0], true);
   			getCore()->getPerformanceModel()->queueInstruction(
 																m_chkpt_loads[num_chkpt_loads_cnt], true);
-				m_chkpt_l_dyn_ins_info.erase(m_chkpt_l_dyn_ins_info.begin());
+				m_chkpt_l_dyn_ins_info.pop_front();
 				++num_chkpt_loads_cnt;
 			}
 			//stores next
@@ -3650,23 +3211,16 @@ void MemoryManager::take_checkpoint(IntPtr page_address) {
 																						(m_chkpt_s_dyn_ins_info[0], true);
   			getCore()->getPerformanceModel()->queueInstruction(
 																m_chkpt_stores[num_chkpt_stores_cnt], true);
-				m_chkpt_s_dyn_ins_info.erase(m_chkpt_s_dyn_ins_info.begin());
+				m_chkpt_s_dyn_ins_info.pop_front();
 				++num_chkpt_stores_cnt;
 			}
 		}
 		assert(m_chkpt_l_dyn_ins_info.size() == 0);
 		assert(m_chkpt_s_dyn_ins_info.size() == 0);
 	}
-
-  	/*m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
-         Core::NONE, Core::READ,
-         curr_addr_aligned, 0, NULL, 8,
-         true, true);
-  	m_cache_cntlrs[MemComponent::L1_DCACHE]->processMemOpFromCore(
-         Core::NONE, Core::WRITE,
-         checkpoint_addr_aligned, 0, NULL, 8,
-         true, true);*/
+	return queued;
 }
+
 //#endif
 
 MemoryManager::~MemoryManager()
@@ -3706,6 +3260,8 @@ MemoryManager::~MemoryManager()
       delete m_dram_cntlr;
    if (m_dram_directory_cntlr)
       delete m_dram_directory_cntlr;
+
+   delete [] m_access_buf;
 }
 
 HitWhere::where_t
@@ -3715,89 +3271,72 @@ MemoryManager::coreInitiateMemoryAccess(
       Core::mem_op_t mem_op_type,
       IntPtr address, UInt32 offset,
       Byte* data_buf, UInt32 data_length,
-      Core::MemModeled modeled)
+      Core::MemModeled modeled, UInt32 accel_op)
 {
-   data_buf = new Byte[data_length];
+   // Accesses are split at line boundaries by the core, so one line of scratch
+   // holds the data of any of them without allocating on every access
+   LOG_ASSERT_ERROR(data_length <= getCacheBlockSize(), "Access of %d bytes crosses a cache line", data_length);
+   data_buf = m_access_buf;
    LOG_ASSERT_ERROR(mem_component <= m_last_level_cache,
       "Error: invalid mem_component (%d) for coreInitiateMemoryAccess", mem_component);
 
    if (mem_component == MemComponent::L1_ICACHE && m_itlb)
       accessTLB(m_itlb, address, true, modeled);
-   else if (mem_component == MemComponent::L1_DCACHE && m_dtlb) {
+   else if (mem_component == MemComponent::L1_DCACHE && m_dtlb)
       accessTLB(m_dtlb, address, false, modeled);
-			if(m_pic_on && m_microbench_run) {
-				if(picInsInfoMap.find(address) != picInsInfoMap.end()) {
-					struct PicInsInfo pii = picInsInfoMap[address];
-      		accessTLB(m_dtlb, pii.other_source, false, modeled);
-				}
-			}
-	 }
 
-   if (DEBUG_ENABLED)  printf("\n Inside coreInitiateMemoryAccess for %s: ADDR(%x), offset: %d, data: %c, data_length(%d) OP(%d)\n", MemComponentString(mem_component), address, offset, (char)(*data_buf), data_length, mem_op_type);
-  
-   //CAP: Forward CAP operation to Cache Ctlr 
-   //showCapInsInfoMap();
-   if(m_cap_on) {
-      if (DEBUG_ENABLED)  printf("\n Going to display CAPINSFINFO for %s\n", MemComponentString(mem_component));
-     
-      UInt32 log_block_size = floorLog2(getCacheBlockSize());
-      IntPtr capAddr = (IntPtr)((UInt64)(address) | offset);
-     
-      if(capInsInfoMap.find(capAddr) != capInsInfoMap.end()) {
-         struct CAPInsInfo cii = capInsInfoMap[capAddr];
-         capInsInfoMap.erase(capAddr);
-
-         if(cii.op == CacheCntlr::CAP_SS) {
-            // Unset the 31st and 30th bits set for CAP_SS identification
-            UInt32 maskBits = ~((1<<31) | (1<<30));
-            capAddr = (IntPtr)((UInt32)(capAddr) & maskBits);
-
-            memcpy(data_buf, cii.cap_data_buf, 1);
-            return m_cache_cntlrs[mem_component]->processCAPSOpFromCore(cii.op, capAddr, data_buf, data_length);  // assumed data_length for ss=1
-         }
-         else if (cii.op == CacheCntlr::CAP_MATCH) {
-            // Unset the 30th bit set for CAP_MATCH identification
-            UInt32 maskBits = ~(1<<30);
-            capAddr = (IntPtr)((UInt32)(capAddr) & maskBits);
+   CAP_TRACE("mem", "coreInitiateMemoryAccess %s addr 0x%lx offset %lu length %lu op %lu", MemComponentString(mem_component), (UInt64)address, (UInt64)offset, (UInt64)data_length, (UInt64)mem_op_type);
 
-            memcpy(data_buf, cii.cap_data_buf, 1);
-             if (DEBUG_ENABLED)  printf("\n CAP_MATCH: Inside coreInitiateMemoryAccess for %s: CAP_ADDR(%x), offset: %d, data: %d, data_length(%d) OP(%d)\n", MemComponentString(mem_component), capAddr,  offset, (UInt32)(*data_buf), data_length, mem_op_type);
+   //CAP/PIC: Only the synthetic accesses carry an op, everything else goes straight to the cache
+   AcceleratorOp aop;
+   if (accel_op)
+      aop = takeAcceleratorOp(accel_op);
 
-            return m_cache_cntlrs[mem_component]->processCAPSOpFromCore(cii.op, capAddr, data_buf, data_length);  // assumed data_length = 1
-         }
-         else if (cii.op == CacheCntlr::CAP_END) {
-            printf("End of input pattern! \n");
-
-            UInt32 numFSMmatches = m_cache_cntlrs[mem_component]->getNumFSMmatches();
-
-            if (numFSMmatches)
-               printf("HURRAY! %d matches found from input stream for current FSM!\n", numFSMmatches);
-            else
-               printf("No matches found for current FSM. Maybe later?\n");
-            
-            printf("Exiting!!!\n");             
-            exit(0);
-         }
-         else if  (cii.op == CacheCntlr::CAP_REP_STE) {
-            capAddr = (IntPtr)((UInt32)(capAddr) - NUM_SUBARRAYS*m_cache_block_size);
-            memcpy(data_buf, cii.cap_data_buf, 1);
+   //CAP: Forward CAP operation to Cache Ctlr 
+   if (accel_op && aop.is_cap) {
+      struct CAPInsInfo& cii = aop.cap;
+      IntPtr capAddr = cii.addr;
+
+      if(cii.op == CacheCntlr::CAP_PROGRAM || cii.op == CacheCntlr::CAP_SS || cii.op == CacheCntlr::CAP_REP_STE) {
+         // Bulk programming: the whole image travels with the op
+         HitWhere::where_t hit_where = m_cache_cntlrs[m_cap_component]->processCAPSOpFromCore(cii.op, capAddr, cii.cap_data_buf, cii.cap_data_length);
+         delete [] cii.cap_data_buf;
+         return hit_where;
+      }
+      else if (cii.op == CacheCntlr::CAP_MATCH) {
+         // One chunk of an input stream, matched symbol by symbol
+         CAP_TRACE("cap", "match chunk addr 0x%lx stream %lu length %lu", (UInt64)capAddr, (UInt64)cii.stream_id, (UInt64)cii.cap_data_length);
+         HitWhere::where_t hit_where = m_cache_cntlrs[m_cap_component]->processCAPSOpFromCore(cii.op, capAddr, cii.cap_data_buf, cii.cap_data_length, cii.stream_id);
+         delete [] cii.cap_data_buf;
+         return hit_where;
+      }
+      else if (cii.op == CacheCntlr::CAP_STREAM_END) {
+         return m_cache_cntlrs[m_cap_component]->processCAPSOpFromCore(cii.op, capAddr, NULL, 0, cii.stream_id);
+      }
+      else if (cii.op == CacheCntlr::CAP_END) {
+         printf("End of input pattern! \n");
 
-            return m_cache_cntlrs[mem_component]->processCAPSOpFromCore(cii.op, capAddr, data_buf, data_length);  // assumed data_length = 1
-         }
-         else if  (cii.op == CacheCntlr::CAP_ST_MASK) {
-            memcpy(data_buf, cii.cap_data_buf, 1);
+         m_cache_cntlrs[m_cap_component]->drainCapReports();
+         UInt64 numFSMmatches = m_cache_cntlrs[m_cap_component]->getNumFSMmatches();
+         UInt32 numStreams = m_cache_cntlrs[m_cap_component]->getNumCapStreams();
 
-            return m_cache_cntlrs[mem_component]->processCAPSOpFromCore(cii.op, capAddr, data_buf, data_length);  // assumed data_length = 1
-         }
-         else {
-            memcpy(data_buf, cii.cap_data_buf, 1);
-            if (DEBUG_ENABLED)  printf("CAP_NONE: coreInitiateMemoryAccess: reading!!! addr: %d  data: %d\n", (UInt32)(capAddr), *data_buf);
-            // Unset the 31st bit set for CAP_NONE identification
-            UInt32 maskBits = ~(1<<31);
-            address = (IntPtr)((UInt32)(address) & maskBits);
+         if (numFSMmatches)
+            printf("HURRAY! %lu matches found from %d input stream(s) for current FSM!\n", numFSMmatches, numStreams);
+         else
+            printf("No matches found for current FSM. Maybe later?\n");
+
+         if (m_cap_partitions > 1) {
+            // Merge the reports of all partitions, the last one to finish prints the total
+            ScopedLock sl(s_cap_merge_lock);
+            s_cap_merged_matches += numFSMmatches;
+            if (++s_cap_partitions_done == m_cap_partitions)
+               printf("CAP: %lu matches merged from %d partitions\n", s_cap_merged_matches, m_cap_partitions);
          }
+         
+         return HitWhere::L1_OWN;
       }
-   }  
+      delete [] cii.cap_data_buf;
+   }
  
    
 		//#ifdef PIC_ENABLE_CHECKPOINT
@@ -3813,60 +3352,11 @@ MemoryManager::coreInitiateMemoryAccess(
 		}
 		//#endif
 
-		if(m_pic_on) {
-			//Check if this is a PIC OPERATION
-			if(picInsInfoVec.size()) {
-				IntPtr pic_addr = (((picInsInfoVec[0].first) /64) * 64);
-				if((pic_addr == address)) {
-					struct PicInsInfo pii =  picInsInfoVec[0].second;
-					picInsInfoVec.erase(picInsInfoVec.begin());
-					if(!pii.is_vpic) {
-						assert(pii.count == 0);
-   					return m_cache_cntlrs[mem_component]->processPicSOpFromCore(
-						pii.op, pii.other_source, address);
-					}
-					else {
-						assert(pii.count != 0);
-						if(pii.other_source2) {
-							if(pii.op == CacheCntlr::PIC_CLMULT)
-return m_cache_cntlrs[mem_component]->processPicVOpFromCoreCLMULT
-(pii.op, pii.other_source, pii.other_source2, address, m_microbench_opsize);
-							else if(pii.op == CacheCntlr::PIC_LOGICAL)
-return m_cache_cntlrs[mem_component]->processPicVOpFromCoreLOGICAL(CacheCntlr::PIC_LOGICAL, 1024, 1088, 1152, 1);
-						}
-						else
-   						return m_cache_cntlrs[mem_component]->processPicVOpFromCore(
-							pii.op, pii.other_source, address, pii.count);
-					}
-				}
-			}
-			if(picInsInfoMap.find(address) != picInsInfoMap.end()) {
-				struct PicInsInfo pii = picInsInfoMap[address];
-				picInsInfoMap.erase(address);
-				if(!pii.is_vpic) {
-					assert(pii.count == 0);
-   				return m_cache_cntlrs[mem_component]->processPicSOpFromCore(
-					pii.op, pii.other_source, address);
-				}
-				else {
-					assert(pii.count != 0);
-					//TODO: For checkpointing I want the second source to come first
-					if(m_microbench_run) {
-						if(pii.other_source2) {
-							assert(0);
-						}
-						else {
-   						return m_cache_cntlrs[mem_component]->processPicVOpFromCore(
-								pii.op, address, pii.other_source,
-								pii.count);
-							}
-					}
-					else
-   					return m_cache_cntlrs[mem_component]->processPicVOpFromCore(
-							pii.op, pii.other_source, address, 
-							pii.count);
-				}
-			}
+		//PIC: This is a PIC OPERATION
+		if(accel_op && !aop.is_cap) {
+			if(m_microbench_run && mem_component == MemComponent::L1_DCACHE && m_dtlb)
+      	accessTLB(m_dtlb, aop.pic.other_source, false, modeled);
+			return processPicOp(aop.pic, mem_component, address);
 		}
 
 //   if((mem_component == MemComponent::L1_DCACHE) || (mem_component == MemComponent::L2_CACHE))      mem_component = MemComponent::LAST_LEVEL_CACHE;
@@ -3880,6 +3370,84 @@ return m_cache_cntlrs[mem_component]->processPicVOpFromCoreLOGICAL(CacheCntlr::P
          modeled == Core::MEM_MODELED_NONE ? false : true);
 }
 
+//CAP/PIC: Synthetic accelerator op table. Slots are recycled, so the table
+//only grows to the number of ops in flight at once.
+UInt32
+MemoryManager::newAcceleratorOp(const AcceleratorOp& aop)
+{
+   ScopedLock sl(m_accel_ops_lock);
+   UInt32 index;
+   if (m_accel_ops_free.size()) {
+      index = m_accel_ops_free.back();
+      m_accel_ops_free.pop_back();
+      m_accel_ops[index] = aop;
+   }
+   else {
+      index = m_accel_ops.size();
+      m_accel_ops.push_back(aop);
+   }
+   return index + 1;
+}
+
+UInt32
+MemoryManager::newCapOp(const struct CAPInsInfo& cii)
+{
+   AcceleratorOp aop;
+   aop.is_cap = true;
+   aop.cap = cii;
+   return newAcceleratorOp(aop);
+}
+
+UInt32
+MemoryManager::newPicOp(const struct PicInsInfo& pii, bool address_first)
+{
+   AcceleratorOp aop;
+   aop.is_cap = false;
+   aop.pic = pii;
+   aop.pic.address_first = address_first;
+   return newAcceleratorOp(aop);
+}
+
+MemoryManager::AcceleratorOp
+MemoryManager::takeAcceleratorOp(UInt32 accel_op)
+{
+   ScopedLock sl(m_accel_ops_lock);
+   LOG_ASSERT_ERROR(accel_op > 0 && accel_op <= m_accel_ops.size(), "CAP/PIC: invalid accelerator op tag %u", accel_op);
+   m_accel_ops_free.push_back(accel_op - 1);
+   return m_accel_ops[accel_op - 1];
+}
+
+HitWhere::where_t
+MemoryManager::processPicOp(const struct PicInsInfo& pii,
+      MemComponent::component_t mem_component, IntPtr address)
+{
+	if(!pii.is_vpic) {
+		assert(pii.count == 0);
+		return m_cache_cntlrs[mem_component]->processPicSOpFromCore(
+			pii.op, pii.other_source, address);
+	}
+
+	assert(pii.count != 0);
+	if(pii.other_source2) {
+		if(pii.op == CacheCntlr::PIC_CLMULT)
+			return m_cache_cntlrs[mem_component]->processPicVOpFromCoreCLMULT
+				(pii.op, pii.other_source, pii.other_source2, address, pii.count);	//count: matrix dimension
+		LOG_ASSERT_ERROR(pii.op == CacheCntlr::PIC_LOGICAL && !pii.address_first,
+			"PIC: unsupported three operand PIC op %d", pii.op);
+		return m_cache_cntlrs[mem_component]->processPicVOpFromCoreLOGICAL(CacheCntlr::PIC_LOGICAL, 1024, 1088, 1152, 1);
+	}
+	//dest = dest OP source, in place
+	if(pii.op == CacheCntlr::PIC_LOGICAL)
+		return m_cache_cntlrs[mem_component]->processPicVOpFromCoreLOGICAL(
+			pii.op, pii.other_source, address, address, pii.count, pii.logic);
+	//TODO: For checkpointing I want the second source to come first
+	if(pii.address_first)
+		return m_cache_cntlrs[mem_component]->processPicVOpFromCore(
+			pii.op, address, pii.other_source, pii.count);
+	return m_cache_cntlrs[mem_component]->processPicVOpFromCore(
+		pii.op, pii.other_source, address, pii.count);
+}
+
 void
 MemoryManager::handleMsgFromNetwork(NetPacket& packet)
 {
@@ -4030,6 +3598,39 @@ MYLOG("bcast msg");
    delete [] msg_buf;
 }
 
+// PIC: The SIM_PIC_* op and logic encodings of sim_api.h are the
+// CacheCntlr::pic_ops_t and pic_logic_ops_t values. Operands are explicit,
+// so no accelerator op table entry is involved.
+HitWhere::where_t
+MemoryManager::coreInitiatePicOperation(UInt32 pic_op, UInt32 logic, UInt32 count,
+      IntPtr src, IntPtr dst)
+{
+   LOG_ASSERT_ERROR(m_pic_on, "PIC: PIC instruction issued with PIC disabled");
+   LOG_ASSERT_ERROR(pic_op < CacheCntlr::NUM_PIC_OPS && pic_op != CacheCntlr::PIC_CLMULT,
+      "PIC: unsupported PIC op %u", pic_op);
+   LOG_ASSERT_ERROR(logic < CacheCntlr::NUM_PIC_LOGIC_OPS, "PIC: unsupported PIC logic op %u", logic);
+
+   IntPtr block_mask = ~(IntPtr)(getCacheBlockSize() - 1);
+   src &= block_mask;
+   dst &= block_mask;
+
+   if (m_dtlb) {
+      accessTLB(m_dtlb, src, false, Core::MEM_MODELED_RETURN);
+      accessTLB(m_dtlb, dst, false, Core::MEM_MODELED_RETURN);
+   }
+
+   CAP_TRACE("pic", "coreInitiatePicOperation op %lu logic %lu count %lu src 0x%lx dst 0x%lx", (UInt64)pic_op, (UInt64)logic, (UInt64)count, (UInt64)src, (UInt64)dst);
+
+   CacheCntlr* l1 = m_cache_cntlrs[MemComponent::L1_DCACHE];
+   if (pic_op == CacheCntlr::PIC_LOGICAL)
+      return l1->processPicVOpFromCoreLOGICAL(CacheCntlr::PIC_LOGICAL,
+            src, dst, dst, count ? count : 1, (CacheCntlr::pic_logic_ops_t)logic);
+   else if (count == 0)
+      return l1->processPicSOpFromCore((CacheCntlr::pic_ops_t)pic_op, src, dst);
+   else
+      return l1->processPicVOpFromCore((CacheCntlr::pic_ops_t)pic_op, src, dst, count);
+}
+
 void
 MemoryManager::accessTLB(TLB * tlb, IntPtr address, bool isIfetch, Core::MemModeled modeled)
 {
@@ -13,8 +13,10 @@
 #include "shmem_perf_model.h"
 #include "shared_cache_block_info.h"
 #include "subsecond_time.h"
+#include "synthetic_instruction_factory.h"
 
 #include <map>
+#include <deque>
 #include "hooks_manager.h"
 
 class DramCache;
@@ -26,6 +28,7 @@ class ShmemPerf;
 #define PIC_IS_MICROBENCH_LOGICAL 3	//AND/OR etc
 #define PIC_IS_MICROBENCH_BMM 4	//use mutiple CLMULT
 #define PIC_IS_MICROBENCH_FASTBIT 5	//fastbit modelling
+#define PIC_IS_MICROBENCH_KERNEL 6	//declarative kernel, [general/microbench_kernel]
 
 namespace ParametricDramDirectoryMSI
 {
@@ -51,6 +54,9 @@ namespace ParametricDramDirectoryMSI
 
          Instruction *dummy_inst;
 
+         // CAP/PIC: Static instructions of all synthetic streams queued by this core
+         SyntheticInstructionFactory m_synthetic_ins;
+
          bool m_tlb_miss_parallel;
 
          core_id_t m_core_id_master;
@@ -62,6 +68,8 @@ namespace ParametricDramDirectoryMSI
          Semaphore* m_network_thread_sem;
 
          UInt32 m_cache_block_size;
+         // Scratch line for the data of core accesses, the caller's buffer is never touched
+         Byte* m_access_buf;
          MemComponent::component_t m_last_level_cache;
          bool m_enabled;
 
@@ -75,36 +83,49 @@ namespace ParametricDramDirectoryMSI
 
          //CAP: CAP Mode Enable Ops
          bool m_cap_on;
+         UInt32 m_cap_stream_chunk_size;   // input bytes carried by one CAP_MATCH op
+         UInt32 m_cap_match_seq;           // sequence number for CAP_MATCH/CAP_STREAM_END/CAP_END op addresses
+         CapParameters m_cap_params;       // CAP geometry, from [perf_model/cap]
+         MemComponent::component_t m_cap_component;  // cache level the CAP ops run in
+         UInt32 m_cap_partitions;          // CAP units the automaton is split over
+         UInt32 m_cap_partition;           // partition matched by this core's CAP unit
+         bool m_cap_participates;          // false for cores sharing a CAP unit with a lower core, or beyond the partitions
+         std::vector<Byte> m_cap_partition_mask;  // STEs owned by m_cap_partition, empty when not partitioned
+         static Lock s_cap_merge_lock;
+         static UInt32 s_cap_partitions_done;
+         static UInt64 s_cap_merged_matches;
          struct CAPInsInfo {
 						CacheCntlr::cap_ops_t op;
 						IntPtr addr;	
                         Byte* cap_data_buf;
+                        UInt32 cap_data_length;
+                        UInt32 stream_id;   // input stream of a CAP_MATCH op
 					};
 
-         //CAP 
-         typedef std::unordered_map<IntPtr, struct CAPInsInfo> CAPInsInfoMap;
-					CAPInsInfoMap capInsInfoMap;
-
          //CAP: Do we need a pic_ops_t equivalent/or a struct called PicInsInfo?
          //CAP: Begin- CAP-apps
 
           //CAP: Initializing CAP 
           void init_cacheprogram(Byte* cap_file);
           void init_ssprogram(Byte* ss_pgm_file);
-          void init_pattern_match(Byte* match_file);
+          void init_pattern_match(Byte* match_file, UInt64 length, UInt32 stream_id);
+          void init_pattern_end();
+          void init_stream_end(UInt32 stream_id);
           void init_rep_ste_program(Byte* ste_file);
+          void init_anml(const String& anml_file);
 
 
-          void create_cache_program_instructions(Byte* cap_file);
-          void create_cap_ss_instructions(Byte* ss_file);
-          void create_cap_match_instructions(Byte* match_file);
-          void create_cap_rep_ste_instructions(Byte* ste_file);
+          Byte* create_cap_program_instruction(CacheCntlr::cap_ops_t op, Byte* image_file, UInt32 length, bool encoded = true);
+          void compute_cap_partition(const Byte* ss_image);
+          void apply_cap_partition_mask(CacheCntlr::cap_ops_t op, Byte* image, UInt32 length);
+          void create_cap_match_instruction(CacheCntlr::cap_ops_t op, Byte* match_file, UInt32 length, UInt32 stream_id);
+          void create_cap_store_instruction(IntPtr addr, UInt32 accel_op);
           void schedule_cap_instructions();
           void create_schedule_dummy_instructions();
 
-          std::vector< Instruction *> m_cap_ins;
+          std::deque< Instruction *> m_cap_ins;
           //CAP: TODO Do you need this? Why was it there in PIC?
-          std::vector<DynamicInstructionInfo> m_cap_dyn_ins_info;
+          std::deque< DynamicInstructionInfo> m_cap_dyn_ins_info;
 
 					//#ifdef PIC_ENABLE_CHECKPOINT
       			static const UInt32 CHKPT_PAGE_SHIFT = 12; // 4KB
@@ -115,30 +136,41 @@ namespace ParametricDramDirectoryMSI
       			IntPtr m_chkpt_opsize;
 						IntPtr m_chkpt_interval;
 
+						//A page checkpoints to the same offset of a page 2GB away, so every
+						//line shares its set (and PIC bank) with its checkpoint copy
+      			static const IntPtr CHKPT_DEST_OFFSET = CHKPT_PAGE_SIZE * 524288;
+						//One bit per line of a page, written lines since the last checkpoint
+						typedef UInt64 chkpt_line_mask_t;
+
 						std::set<IntPtr> m_app_pages;
-						std::set<IntPtr> m_checkpointed_pages;
+						std::map<IntPtr, chkpt_line_mask_t> m_chkpt_dirty_lines;
+						IntPtr m_chkpt_last_dirty_page;		//write path shortcut, 
+						chkpt_line_mask_t *m_chkpt_last_dirty_mask;	//stores hit one page in a row
 						std::set<IntPtr> m_no_checkpointed_pages;
 						bool m_is_checkpointing;
-						IntPtr m_last_checkpoint_page_addr;
       			SubsecondTime m_last_checkpoint_time;
-						std::vector< Instruction *> m_chkpt_loads;
-						std::vector< Instruction *> m_chkpt_stores;
-						std::vector< DynamicInstructionInfo> m_chkpt_l_dyn_ins_info;
-						std::vector< DynamicInstructionInfo> m_chkpt_s_dyn_ins_info;
+						std::deque< Instruction *> m_chkpt_loads;
+						std::deque< Instruction *> m_chkpt_stores;
+						std::deque< DynamicInstructionInfo> m_chkpt_l_dyn_ins_info;
+						std::deque< DynamicInstructionInfo> m_chkpt_s_dyn_ins_info;
 						IntPtr m_chkpt_load_inst_addr, m_chkpt_store_inst_addr;
-						std::vector<int> m_chkpt_regs;
+						std::deque<int> m_chkpt_regs;
 
 						bool startNewInterval();
       			void stopCheckpointing() { m_is_checkpointing = false; }
 						//we don't want to checkpoint in warmup
 						void startCheckpointing(); 
 						bool isCheckpointing () const {return m_is_checkpointing; }
-						bool needs_checkpointing(IntPtr address);
 						void inspect_page_access(IntPtr address);
-						void take_checkpoint(IntPtr address);
+						void markCheckpointDirty(IntPtr address);
+						void take_checkpoint();
+						void checkpoint_page(IntPtr page_address, chkpt_line_mask_t dirty);
 						void create_checkpoint_instructions(int num_pairs, 
 							IntPtr l_address, IntPtr s_address);
+						UInt64 schedule_checkpoint_instructions();
 						UInt64 m_num_checkpoints, m_num_intervals;
+						UInt64 m_chkpt_lines, m_chkpt_bytes, m_chkpt_interval_bytes_max;
+						UInt64 m_chkpt_ins_cnt;	//synthetic instructions queued by checkpoints
 
       			IntPtr m_last_chkpt_ins_cnt;
 						IntPtr getCheckpointInstructionsCount();
@@ -154,9 +186,27 @@ namespace ParametricDramDirectoryMSI
 						IntPtr other_source2;	
 						bool is_vpic; //is this a vector pic instruction
 						UInt32 count;	
+						bool address_first; //vector op takes the tagged access address as first source
+						CacheCntlr::pic_logic_ops_t logic; //bitwise op of a two operand PIC_LOGICAL
 					};
-   				typedef std::unordered_map<IntPtr, struct PicInsInfo> PicInsInfoMap;
-					PicInsInfoMap picInsInfoMap;
+
+					//CAP/PIC: Synthetic accelerator ops in flight. The synthetic access
+					//carries its tag (index + 1) in its DynamicInstructionInfo, so
+					//normal accesses never look anything up.
+					struct AcceleratorOp {
+						bool is_cap;
+						struct CAPInsInfo cap;
+						struct PicInsInfo pic;
+					};
+					std::vector<AcceleratorOp> m_accel_ops;
+					std::vector<UInt32> m_accel_ops_free;
+					Lock m_accel_ops_lock;
+					UInt32 newAcceleratorOp(const AcceleratorOp& aop);
+					UInt32 newCapOp(const struct CAPInsInfo& cii);
+					UInt32 newPicOp(const struct PicInsInfo& pii, bool address_first = false);
+					AcceleratorOp takeAcceleratorOp(UInt32 accel_op);
+					HitWhere::where_t processPicOp(const struct PicInsInfo& pii,
+						MemComponent::component_t mem_component, IntPtr address);
 					void create_pic_checkpoint_instructions(int num_pairs, 
 						IntPtr l_address, IntPtr s_address);
 					void create_vpic_checkpoint_instructions(int num_pairs, 
@@ -205,15 +255,48 @@ namespace ParametricDramDirectoryMSI
 						void create_microbench_pic_fastbit_instructions();
 						void schedule_microbench_fastbit_instructions();
 
-						std::vector< Instruction *> m_mbench_src_ins;
-						std::vector< Instruction *> m_mbench_dest_ins;
-						std::vector< Instruction *> m_mbench_comp_ins;
-						std::vector< DynamicInstructionInfo> m_mbench_src_dyn_ins_info;
-						std::vector< DynamicInstructionInfo> m_mbench_dest_dyn_ins_info;
+						//Declarative kernel: a weighted mix of ops over two operand
+						//arrays, both as a baseline load/compute/store stream and as
+						//PIC ops. Each loop runs one op of the mix.
+						struct MicrobenchKernelOp {
+							String name;										//copy, cmp, search, and, or, xor, fastbit, bmm
+							CacheCntlr::pic_ops_t op;
+							CacheCntlr::pic_logic_ops_t logic;	//bitwise op of PIC_LOGICAL
+							IntPtr opsize;									//bytes per baseline load/store
+							UInt32 weight;									//loops of this op per period of the mix
+							SInt64 credit;									//weighted round-robin state
+							UInt64 ops;											//lines of each operand processed
+						};
+						struct MicrobenchKernel {
+							String name;										//the op mix as given, e.g. "copy:3 bmm"
+							std::vector<MicrobenchKernelOp> ops;
+							UInt32 total_weight;
+							IntPtr footprint;								//bytes spanned by each operand array
+							IntPtr stride;									//bytes between consecutive lines of an array
+							IntPtr operand_distance;				//bytes from the source to the destination array
+							UInt32 vector_length;						//lines per PIC op, 1 for scalar PIC ops
+							IntPtr matrix_addr;							//bmm's 64x64 bit matrix, after the destination
+						} m_mbench_kernel;
+						UInt64 m_mbench_kernel_ops;				//lines of each operand processed
+						std::deque< Instruction *> m_mbench_kernel_ins;	//in program order
+						void init_microbench_kernel();
+						static UInt32 next_microbench_kernel_op(
+														std::vector<MicrobenchKernelOp>& ops, UInt32 total_weight);
+						IntPtr microbench_kernel_ins_per_iteration(const MicrobenchKernelOp& kop);
+						void create_microbench_kernel_instructions(MicrobenchKernelOp& kop);
+						void create_microbench_bmm_kernel_instructions();
+						void create_microbench_pic_kernel_instructions(MicrobenchKernelOp& kop);
+						void schedule_microbench_kernel_instructions();
+
+						std::deque< Instruction *> m_mbench_src_ins;
+						std::deque< Instruction *> m_mbench_dest_ins;
+						std::deque< Instruction *> m_mbench_comp_ins;
+						std::deque< DynamicInstructionInfo> m_mbench_src_dyn_ins_info;
+						std::deque< DynamicInstructionInfo> m_mbench_dest_dyn_ins_info;
 						IntPtr m_mbench_src_inst_addr, m_mbench_dest_inst_addr, m_mbench_comp_inst_addr;
 						IntPtr m_mbench_src_addr, m_mbench_dest_addr;
 						IntPtr m_mbench_src2_addr, m_mbench_spare_addr;
-						std::vector<int> m_mbench_regs;
+						std::deque<int> m_mbench_regs;
 
 						bool more_microbench_loops() {
 												return (m_microbench_loops > 1) || (m_microbench_outer_loops > 1);
@@ -229,22 +312,29 @@ namespace ParametricDramDirectoryMSI
 
 					void init_strmatch( UInt64 word_size);
 					void init_wordcount(UInt64 cam_id, UInt64 num_words);
+					void init_pic_write(IntPtr address, Byte* data_buf, UInt64 length);
+					void init_pic_read(IntPtr address, Byte* data_buf, UInt64 length);
+
+					//Result of the functional PIC ops issued by this core, read back with "picres"
+					struct PicResult {
+						UInt64 mask;		//byte equality mask of the last CMP/SEARCH
+						UInt64 hits;		//bit (n % 64) set if CMP/SEARCH n matched the whole line
+						UInt64 ops;			//functional ops executed
+					} m_pic_result;
 
 					void create_app_search_instructions_stash(IntPtr max_search_size, int word_size, int key_count, bool is_strcmp);
 					int create_app_search_instructions(int word_size, int key_count, bool is_strcmp);
 					void schedule_app_search_instructions(int words_per_search, int key_count, bool is_strcmp);
 
-					std::vector< Instruction *> m_app_search_ins;
-					std::vector< Instruction *> m_app_maskcomp_ins;
-					std::vector< DynamicInstructionInfo> m_app_dyn_ins_info;
+					std::deque< Instruction *> m_app_search_ins;
+					std::deque< Instruction *> m_app_maskcomp_ins;
+					std::deque< DynamicInstructionInfo> m_app_dyn_ins_info;
 
-					std::vector< Instruction *> m_app_search_ins_stash;
-					std::vector< Instruction *> m_app_maskcomp_ins_stash;
-					std::vector< DynamicInstructionInfo> m_app_dyn_ins_info_stash;
+					std::deque< Instruction *> m_app_search_ins_stash;
+					std::deque< Instruction *> m_app_maskcomp_ins_stash;
+					std::deque< DynamicInstructionInfo> m_app_dyn_ins_info_stash;
 
-					std::vector<int> m_app_regs;
-   				typedef std::vector<std::pair<IntPtr, struct PicInsInfo> >PicInsInfoVec;
-					PicInsInfoVec picInsInfoVec;
+					std::deque<int> m_app_regs;
 					IntPtr m_app_key_addr;
 					IntPtr m_app_data_addr;
 					IntPtr m_app_search_inst_addr;
@@ -260,6 +350,7 @@ namespace ParametricDramDirectoryMSI
          ~MemoryManager();
 
          UInt64 getCacheBlockSize() const { return m_cache_block_size; }
+         bool capParticipates() const { return m_cap_participates; }
 
          Cache* getCache(MemComponent::component_t mem_component) {
               return m_cache_cntlrs[mem_component == MemComponent::LAST_LEVEL_CACHE ? MemComponent::component_t(m_last_level_cache) : mem_component]->getCache();
@@ -281,7 +372,11 @@ namespace ParametricDramDirectoryMSI
                Core::mem_op_t mem_op_type,
                IntPtr address, UInt32 offset,
                Byte* data_buf, UInt32 data_length,
-               Core::MemModeled modeled);
+               Core::MemModeled modeled,
+               UInt32 accel_op = 0);
+         HitWhere::where_t coreInitiatePicOperation(
+               UInt32 pic_op, UInt32 logic, UInt32 count,
+               IntPtr src, IntPtr dst);
 
          void handleMsgFromNetwork(NetPacket& packet);
 
@@ -297,7 +392,13 @@ namespace ParametricDramDirectoryMSI
          void enableModels();
          void disableModels();
 
-         void showCapInsInfoMap();
+
+         //PIC: called by the cache level that executed a PIC op issued by this core
+         void recordPicResult(CacheCntlr::pic_ops_t op, UInt64 mask, bool matched);
+         //PIC: called by the caches on every line write, feeds the dirty-line
+         //bitmaps of incremental checkpoints
+         void markCheckpointDirtyLine(IntPtr address)
+         { if (m_is_checkpointing) markCheckpointDirty(address); }
 
          core_id_t getShmemRequester(const void* pkt_data)
          { return ((PrL1PrL2DramDirectoryMSI::ShmemMsg*) pkt_data)->getRequester(); }
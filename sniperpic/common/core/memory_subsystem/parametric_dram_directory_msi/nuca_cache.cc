@@ -5,6 +5,7 @@
 #include "stats.h"
 #include "queue_model.h"
 #include "shmem_perf.h"
+#include "addr_bank_mapping.h"
 
 NucaCache::NucaCache(MemoryManagerBase* memory_manager, ShmemPerfModel* shmem_perf_model, AddressHomeLookup* home_lookup, UInt32 cache_block_size, ParametricDramDirectoryMSI::CacheParameters& parameters)
    : m_core_id(memory_manager->getCore()->getId())
@@ -33,6 +34,13 @@ NucaCache::NucaCache(MemoryManagerBase* memory_manager, ShmemPerfModel* shmem_pe
       NULL, /* FaultinjectionManager */
       home_lookup
    );
+   m_bank_mapping = new ParametricDramDirectoryMSI::AddrBankMapping("nuca-cache",
+      parameters.num_sets, parameters.associativity, parameters.num_banks,
+      Sim()->getCfg()->hasKey("perf_model/nuca/pic_map_policy")
+         ? ParametricDramDirectoryMSI::parsePicMapPolicy(Sim()->getCfg()->getString("perf_model/nuca/pic_map_policy"))
+         : ParametricDramDirectoryMSI::CacheCntlr::PIC_ALL_WAYS_ONE_BANK,
+      Sim()->getCfg()->getBoolDefault("perf_model/nuca/pic_colocate", false));
+   m_cache->setBankMapping(m_bank_mapping, m_core_id);
 
    if (Sim()->getCfg()->getBool("perf_model/nuca/queue_model/enabled"))
    {
@@ -69,6 +77,11 @@ NucaCache::NucaCache(MemoryManagerBase* memory_manager, ShmemPerfModel* shmem_pe
 				ParametricDramDirectoryMSI::picOpString(start);
     		registerStatsMetric("nuca-cache", m_core_id, 
 					String("pic_ops_")+op_str, &pic_ops[(int)start]);
+    		pic_energy[(int)start] = 0;
+    		m_pic_line_op_energy[(int)start] = ParametricDramDirectoryMSI::
+					getAccelEnergyFJ(String("perf_model/nuca/pic_energy/")+op_str);
+    		registerStatsMetric("nuca-cache", m_core_id, 
+					String("pic_energy_")+op_str, &pic_energy[(int)start]);
 
     	for(ParametricDramDirectoryMSI::CacheCntlr::pic_map_policy_t map_start = 
 			ParametricDramDirectoryMSI::CacheCntlr::PIC_ALL_WAYS_ONE_BANK; 
@@ -89,6 +102,7 @@ NucaCache::NucaCache(MemoryManagerBase* memory_manager, ShmemPerfModel* shmem_pe
 
 NucaCache::~NucaCache()
 {
+   delete m_bank_mapping;
    delete m_cache;
    if (m_queue_model)
       delete m_queue_model;
@@ -257,6 +271,7 @@ void NucaCache::picUpdateCounters(
 	ParametricDramDirectoryMSI::CacheCntlr::pic_ops_t pic_opcode, 
   IntPtr ca_address1,IntPtr ca_address2) {
     pic_ops[(int)pic_opcode]++;
+    pic_energy[(int)pic_opcode] += m_pic_line_op_energy[(int)pic_opcode];
 
 		if(m_microbench_loopsize 
 			&& (pic_opcode == ParametricDramDirectoryMSI::CacheCntlr::PIC_SEARCH)) {
@@ -268,16 +283,17 @@ void NucaCache::picUpdateCounters(
 
 		UInt32 set1, way1;
 		UInt32 set2, way2;
-		m_cache->peekSingleLine(ca_address1, &set1, &way1);
-		m_cache->peekSingleLine(ca_address2, &set2, &way2);
+		__attribute__((unused)) bool present =
+			m_cache->peekSingleLine(ca_address1, &set1, &way1)
+			&& m_cache->peekSingleLine(ca_address2, &set2, &way2);
+		assert(present);
 
     for(ParametricDramDirectoryMSI::CacheCntlr::pic_map_policy_t map_start = 
 			ParametricDramDirectoryMSI::CacheCntlr::PIC_ALL_WAYS_ONE_BANK; 
 			map_start < ParametricDramDirectoryMSI::CacheCntlr::NUM_PIC_MAP_POLICY; 
 			map_start = ParametricDramDirectoryMSI::CacheCntlr::pic_map_policy_t
 			(int(map_start)+1)) {
-			if(inSameBank(MemComponent::NUCA_CACHE, set1, way1, set2, way2, 
-				map_start))
+			if(m_bank_mapping->inSameBank(set1, way1, set2, way2, map_start))
     		pic_ops_in_bank[(int)pic_opcode][(int)map_start]++;
 		}
 }
@@ -27,6 +27,7 @@ class NucaCache
       ComponentBandwidth m_data_array_bandwidth;
 
       Cache* m_cache;
+      ParametricDramDirectoryMSI::AddrBankMapping* m_bank_mapping;
       QueueModel *m_queue_model;
 
       UInt64 m_reads, m_writes, m_read_misses, m_write_misses, m_dirty_evicts;
@@ -60,6 +61,10 @@ class NucaCache
 						ParametricDramDirectoryMSI::CacheCntlr::pic_ops_t pic_opcode, 
   					IntPtr ca_address1, IntPtr ca_address2);
           UInt64 pic_key_writes;
+          UInt64 pic_energy		//fJ, [perf_model/nuca/pic_energy] per line-op
+						[(ParametricDramDirectoryMSI::CacheCntlr::NUM_PIC_OPS)];
+          UInt64 m_pic_line_op_energy
+						[(ParametricDramDirectoryMSI::CacheCntlr::NUM_PIC_OPS)];
 		 //#endif                   			
 };
 
@@ -0,0 +1,131 @@
+#include "synthetic_instruction_factory.h"
+#include "log.h"
+#include "stats.h"
+
+namespace ParametricDramDirectoryMSI
+{
+
+SyntheticInstructionFactory::SyntheticInstructionFactory()
+   : m_num_instructions(0)
+   , m_num_requests(0)
+{
+}
+
+SyntheticInstructionFactory::~SyntheticInstructionFactory()
+{
+   for (std::map<Key, Instruction*>::iterator it = m_instructions.begin(); it != m_instructions.end(); ++it)
+      delete it->second;
+}
+
+void
+SyntheticInstructionFactory::registerStats(core_id_t core_id)
+{
+   registerStatsMetric("mem-manager", core_id, "synthetic-instructions", &m_num_instructions);
+   registerStatsMetric("mem-manager", core_id, "synthetic-requests", &m_num_requests);
+}
+
+bool
+SyntheticInstructionFactory::Key::operator<(const Key& other) const
+{
+   if (ins_addr != other.ins_addr) return ins_addr < other.ins_addr;
+   if (type != other.type) return type < other.type;
+   if (iclass != other.iclass) return iclass < other.iclass;
+   if (mem_size != other.mem_size) return mem_size < other.mem_size;
+   if (src_reg1 != other.src_reg1) return src_reg1 < other.src_reg1;
+   if (src_reg2 != other.src_reg2) return src_reg2 < other.src_reg2;
+   if (dest_reg != other.dest_reg) return dest_reg < other.dest_reg;
+   return mem_barrier < other.mem_barrier;
+}
+
+Instruction*
+SyntheticInstructionFactory::getLoad(IntPtr ins_addr, SInt32 dest_reg, UInt16 mem_size)
+{
+   Key key = { MicroOp::UOP_LOAD, ins_addr, XED_ICLASS_MOVQ, mem_size, -1, -1, dest_reg, false };
+   return get(key);
+}
+
+Instruction*
+SyntheticInstructionFactory::getStore(IntPtr ins_addr, SInt32 src_reg, UInt16 mem_size)
+{
+   Key key = { MicroOp::UOP_STORE, ins_addr, XED_ICLASS_MOVQ, mem_size, src_reg, -1, -1, false };
+   return get(key);
+}
+
+Instruction*
+SyntheticInstructionFactory::getExecute(IntPtr ins_addr, xed_iclass_enum_t iclass,
+   SInt32 src_reg1, SInt32 src_reg2, SInt32 dest_reg, bool mem_barrier)
+{
+   Key key = { MicroOp::UOP_EXECUTE, ins_addr, iclass, 0, src_reg1, src_reg2, dest_reg, mem_barrier };
+   return get(key);
+}
+
+Instruction*
+SyntheticInstructionFactory::get(const Key& key)
+{
+   ++m_num_requests;
+   std::map<Key, Instruction*>::iterator it = m_instructions.find(key);
+   if (it != m_instructions.end())
+      return it->second;
+
+   Instruction* ins = create(key);
+   m_instructions[key] = ins;
+   ++m_num_instructions;
+   return ins;
+}
+
+Instruction*
+SyntheticInstructionFactory::create(const Key& key)
+{
+   OperandList operands;
+   if (key.type == MicroOp::UOP_LOAD)
+      operands.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
+   else if (key.type == MicroOp::UOP_STORE)
+      operands.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
+   if (key.src_reg1 >= 0)
+      operands.push_back(Operand(Operand::REG, key.src_reg1, Operand::READ, "", true));
+   if (key.src_reg2 >= 0)
+      operands.push_back(Operand(Operand::REG, key.src_reg2, Operand::READ, "", true));
+   if (key.dest_reg >= 0)
+      operands.push_back(Operand(Operand::REG, key.dest_reg, Operand::WRITE, "", true));
+
+   Instruction *ins = new GenericInstruction(operands);
+   ins->setAddress(key.ins_addr);
+   ins->setSize(4); //Possible sizes seen (L:1-9, S:1-8)
+   ins->setAtomic(false);
+   ins->setDisassembly("");
+
+   m_micro_ops.push_back(MicroOp());
+   MicroOp *uop = &m_micro_ops.back();
+   uop->setInstructionPointer(Memory::make_access(key.ins_addr));
+   switch (key.type)
+   {
+      case MicroOp::UOP_LOAD:
+         uop->makeLoad(0, key.iclass, "", key.mem_size);
+         break;
+      case MicroOp::UOP_STORE:
+         uop->makeStore(0, 0, key.iclass, "", key.mem_size);
+         break;
+      case MicroOp::UOP_EXECUTE:
+         uop->makeExecute(0, 0, key.iclass, "", false /* not a conditional branch */);
+         break;
+      default:
+         LOG_PRINT_ERROR("Unknown synthetic micro-op type %d", key.type);
+   }
+   if (key.src_reg1 >= 0)
+      uop->addSourceRegister((xed_reg_enum_t)key.src_reg1, "");
+   if (key.src_reg2 >= 0)
+      uop->addSourceRegister((xed_reg_enum_t)key.src_reg2, "");
+   if (key.dest_reg >= 0)
+      uop->addDestinationRegister((xed_reg_enum_t)key.dest_reg, "");
+   uop->setMemBarrier(key.mem_barrier);
+   uop->setOperandSize(64);
+   uop->setInstruction(ins);
+   uop->setFirst(true);
+   uop->setLast(true);
+
+   m_micro_op_lists.push_back(std::vector<const MicroOp*>(1, uop));
+   ins->setMicroOps(&m_micro_op_lists.back());
+   return ins;
+}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "fixed_types.h"
+#include "instruction.h"
+#include "micro_op.h"
+
+#include <map>
+#include <deque>
+#include <vector>
+
+namespace ParametricDramDirectoryMSI
+{
+   // CAP/PIC: Static instructions of the synthetic streams (microbenchmarks,
+   // app searches, checkpoints, CAP stores)
+   //
+   // Each synthetic op is a single micro-op instruction described by its
+   // address, kind, memory size and registers. Identical descriptions return
+   // the same Instruction, so a stream of any length queues a handful of static
+   // instructions, as a real loop would. The factory owns the instructions; the
+   // micro-ops and their lists are pooled in chunks and live as long as it does.
+   //
+   // A register of -1 leaves the operand out: PIC ops carry their operands in
+   // the accelerator op table, not in registers.
+   class SyntheticInstructionFactory
+   {
+      public:
+         SyntheticInstructionFactory();
+         ~SyntheticInstructionFactory();
+
+         Instruction* getLoad(IntPtr ins_addr, SInt32 dest_reg, UInt16 mem_size);
+         Instruction* getStore(IntPtr ins_addr, SInt32 src_reg, UInt16 mem_size);
+         Instruction* getExecute(IntPtr ins_addr, xed_iclass_enum_t iclass,
+            SInt32 src_reg1, SInt32 src_reg2, SInt32 dest_reg, bool mem_barrier = false);
+
+         // mem-manager.synthetic-instructions: static instructions created,
+         // mem-manager.synthetic-requests: synthetic ops built from them
+         void registerStats(core_id_t core_id);
+
+      private:
+         struct Key
+         {
+            MicroOp::uop_type_t type;
+            IntPtr ins_addr;
+            xed_iclass_enum_t iclass;
+            UInt16 mem_size;
+            SInt32 src_reg1, src_reg2, dest_reg;
+            bool mem_barrier;
+
+            bool operator<(const Key& other) const;
+         };
+
+         std::map<Key, Instruction*> m_instructions;
+         std::deque<MicroOp> m_micro_ops;
+         std::deque<std::vector<const MicroOp*> > m_micro_op_lists;
+         UInt64 m_num_instructions;
+         UInt64 m_num_requests;
+
+         Instruction* get(const Key& key);
+         Instruction* create(const Key& key);
+   };
+}
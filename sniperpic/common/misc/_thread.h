@@ -27,6 +27,8 @@ public:
    virtual ~_Thread() { };
 
    virtual void run() = 0;
+   // Wait until the thread function has returned
+   virtual void join() = 0;
 };
 
 #endif // THREAD_H
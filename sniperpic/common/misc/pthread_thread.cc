@@ -29,6 +29,11 @@ void PthreadThread::run()
    pthread_create(&m_thread, &attr, spawnedThreadFunc, &m_data);
 }
 
+void PthreadThread::join()
+{
+   pthread_join(m_thread, NULL);
+}
+
 // Check if pin_thread.cc is included in the build and has
 // Thread::Create defined. If so, PthreadThread is not used.
 __attribute__((weak)) _Thread* _Thread::create(ThreadFunc func, void *param)
@@ -10,6 +10,7 @@ public:
    PthreadThread(ThreadFunc func, void *param);
    ~PthreadThread();
    void run();
+   void join();
 
 private:
    static void *spawnedThreadFunc(void *);
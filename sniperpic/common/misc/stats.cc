@@ -1,6 +1,7 @@
 #include "stats.h"
 #include "simulator.h"
 #include "hooks_manager.h"
+#include "config.hpp"
 #include "utils.h"
 #include "itostr.h"
 
@@ -31,6 +32,7 @@ const char* db_create_stmts[] = {
 const char db_insert_stmt_name[] = "INSERT INTO `names` (nameid, objectname, metricname) VALUES (?, ?, ?);";
 const char db_insert_stmt_prefix[] = "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);";
 const char db_insert_stmt_value[] = "INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?);";
+const char db_insert_stmt_event[] = "INSERT INTO event (event, time, core, thread, value0, value1, description) VALUES (?, ?, ?, ?, ?, ?, ?);";
 
 UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
 {
@@ -44,6 +46,10 @@ StatsManager::StatsManager()
    : m_keyid(0)
    , m_prefixnum(0)
    , m_db(NULL)
+   , m_queue_depth(0)
+   , m_writing(0)
+   , m_writer(NULL)
+   , m_writer_stop(false)
 {
    init();
 
@@ -52,6 +58,22 @@ StatsManager::StatsManager()
 
 StatsManager::~StatsManager()
 {
+   flush();
+
+   if (m_writer)
+   {
+      m_queue_lock.acquire();
+      m_writer_stop = true;
+      m_queue_cond.broadcast();
+      m_queue_lock.release();
+      // Make sure the writer is gone before its snapshots and the database go away
+      m_writer->join();
+      delete m_writer;
+   }
+
+   for(std::vector<StatsSnapshot*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+      delete *it;
+
    for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
       for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
          for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
@@ -62,6 +84,9 @@ StatsManager::~StatsManager()
       sqlite3_finalize(m_stmt_insert_name);
       sqlite3_finalize(m_stmt_insert_prefix);
       sqlite3_finalize(m_stmt_insert_value);
+      sqlite3_finalize(m_stmt_insert_event);
+      // Move everything into the main database file, so it is complete without its -wal file
+      sqlite3_exec(m_db, "PRAGMA wal_checkpoint(TRUNCATE)", NULL, NULL, NULL);
       sqlite3_close(m_db);
    }
 }
@@ -73,10 +98,15 @@ StatsManager::init()
    int ret;
 
    unlink(filename.c_str());
+   // A log left behind by an earlier run would be replayed into the new database
+   unlink((filename + "-wal").c_str());
+   unlink((filename + "-shm").c_str());
    ret = sqlite3_open(filename.c_str(), &m_db);
    LOG_ASSERT_ERROR(ret == SQLITE_OK, "Cannot create DB");
    sqlite3_exec(m_db, "PRAGMA synchronous = OFF", NULL, NULL, NULL);
-   sqlite3_exec(m_db, "PRAGMA journal_mode = MEMORY", NULL, NULL, NULL);
+   // WAL: a commit appends to the log instead of rewriting the journal, and readers
+   // (scripts, tools) do not block the stats writer
+   sqlite3_exec(m_db, "PRAGMA journal_mode = WAL", NULL, NULL, NULL);
    sqlite3_busy_handler(m_db, __busy_handler, this);
 
    for(unsigned int i = 0; i < sizeof(db_create_stmts)/sizeof(db_create_stmts[0]); ++i)
@@ -89,6 +119,7 @@ StatsManager::init()
    sqlite3_prepare(m_db, db_insert_stmt_name, -1, &m_stmt_insert_name, NULL);
    sqlite3_prepare(m_db, db_insert_stmt_prefix, -1, &m_stmt_insert_prefix, NULL);
    sqlite3_prepare(m_db, db_insert_stmt_value, -1, &m_stmt_insert_value, NULL);
+   sqlite3_prepare(m_db, db_insert_stmt_event, -1, &m_stmt_insert_event, NULL);
 
    sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
    for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
@@ -99,6 +130,14 @@ StatsManager::init()
       }
    }
    sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+
+   config::Config *cfg = Sim()->getCfg();
+   m_queue_depth = cfg->hasKey("general/stats_queue_depth") ? cfg->getInt("general/stats_queue_depth") : 4;
+   if (m_queue_depth)
+   {
+      m_writer = _Thread::create(this);
+      m_writer->run();
+   }
 }
 
 int
@@ -133,41 +172,129 @@ StatsManager::recordStats(String prefix)
    // Allow lazily-maintained statistics to be updated
    Sim()->getHooksManager()->callHooks(HookType::HOOK_PRE_STAT_WRITE, (UInt64)prefix.c_str());
 
+   m_queue_lock.acquire();
+   StatsSnapshot *snapshot;
+   if (m_free.empty())
+      snapshot = new StatsSnapshot();
+   else
+   {
+      snapshot = m_free.back();
+      m_free.pop_back();
+   }
+   m_queue_lock.release();
+
+   snapshot->prefixid = ++m_prefixnum;
+   snapshot->prefix = prefix.c_str();
+   snapshot->values.clear();
+   snapshot->values.reserve(m_flat_metrics.size());
+   for(std::vector<std::pair<UInt64, StatsMetricBase*> >::iterator it = m_flat_metrics.begin(); it != m_flat_metrics.end(); ++it)
+   {
+      if (!it->second->isDefault())
+      {
+         StatsValue value = { it->first, it->second->index, it->second->recordMetric() };
+         snapshot->values.push_back(value);
+      }
+   }
+
+   m_queue_lock.acquire();
+   if (m_queue_depth == 0)
+   {
+      m_queue_lock.release();
+      writeSnapshot(snapshot);
+      m_queue_lock.acquire();
+      m_free.push_back(snapshot);
+   }
+   else
+   {
+      // Queue full: write the oldest snapshot here rather than waiting for the writer,
+      // this also keeps things going when the writer thread is not running yet
+      while (m_pending.size() >= m_queue_depth)
+      {
+         StatsSnapshot *oldest = m_pending.front();
+         m_pending.pop_front();
+         m_queue_lock.release();
+         writeSnapshot(oldest);
+         m_queue_lock.acquire();
+         m_free.push_back(oldest);
+      }
+      m_pending.push_back(snapshot);
+      m_queue_cond.broadcast();
+   }
+   m_queue_lock.release();
+}
+
+void
+StatsManager::flush()
+{
+   m_queue_lock.acquire();
+   while (!m_pending.empty())
+   {
+      StatsSnapshot *snapshot = m_pending.front();
+      m_pending.pop_front();
+      m_queue_lock.release();
+      writeSnapshot(snapshot);
+      m_queue_lock.acquire();
+      m_free.push_back(snapshot);
+   }
+   while (m_writing)
+      m_queue_cond.wait(m_queue_lock);
+   m_queue_lock.release();
+}
+
+void
+StatsManager::writeSnapshot(StatsSnapshot *snapshot)
+{
+   ScopedLock sl(m_db_lock);
    int res;
-   int prefixid = ++m_prefixnum;
 
    res = sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
    LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
    sqlite3_reset(m_stmt_insert_prefix);
-   sqlite3_bind_int(m_stmt_insert_prefix, 1, prefixid);
-   sqlite3_bind_text(m_stmt_insert_prefix, 2, prefix.c_str(), -1, SQLITE_TRANSIENT);
+   sqlite3_bind_int64(m_stmt_insert_prefix, 1, snapshot->prefixid);
+   sqlite3_bind_text(m_stmt_insert_prefix, 2, snapshot->prefix.c_str(), -1, SQLITE_STATIC);
    res = sqlite3_step(m_stmt_insert_prefix);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
-   for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
+   sqlite3_bind_int64(m_stmt_insert_value, 1, snapshot->prefixid);
+   for(std::vector<StatsValue>::iterator it = snapshot->values.begin(); it != snapshot->values.end(); ++it)
    {
-      for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
-      {
-         for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
-         {
-            if (!it3->second->isDefault())
-            {
-               sqlite3_reset(m_stmt_insert_value);
-               sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
-               sqlite3_bind_int(m_stmt_insert_value, 2, it2->second.first);   // Metric ID
-               sqlite3_bind_int(m_stmt_insert_value, 3, it3->second->index);  // Core ID
-               sqlite3_bind_int64(m_stmt_insert_value, 4, it3->second->recordMetric());
-               res = sqlite3_step(m_stmt_insert_value);
-               LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
-            }
-         }
-      }
+      sqlite3_reset(m_stmt_insert_value);
+      sqlite3_bind_int64(m_stmt_insert_value, 2, it->nameid);  // Metric ID
+      sqlite3_bind_int(m_stmt_insert_value, 3, it->core);      // Core ID
+      sqlite3_bind_int64(m_stmt_insert_value, 4, it->value);
+      res = sqlite3_step(m_stmt_insert_value);
+      LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
    }
+
    res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
    LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 }
 
+void
+StatsManager::run()
+{
+   m_queue_lock.acquire();
+   while (true)
+   {
+      while (m_pending.empty() && !m_writer_stop)
+         m_queue_cond.wait(m_queue_lock);
+      if (m_pending.empty())
+         break;
+
+      StatsSnapshot *snapshot = m_pending.front();
+      m_pending.pop_front();
+      ++m_writing;
+      m_queue_lock.release();
+      writeSnapshot(snapshot);
+      m_queue_lock.acquire();
+      --m_writing;
+      m_free.push_back(snapshot);
+      m_queue_cond.broadcast();
+   }
+   m_queue_lock.release();
+}
+
 void
 StatsManager::registerMetric(StatsMetricBase *metric)
 {
@@ -183,9 +310,11 @@ StatsManager::registerMetric(StatsMetricBase *metric)
       if (m_db)
       {
          // Metrics name record was already written, but a new metric was registered afterwards: write a new record
+         ScopedLock sl(m_db_lock);
          recordMetricName(m_keyid, _objectName, _metricName);
       }
    }
+   m_flat_metrics.push_back(std::make_pair(m_objects[_objectName][_metricName].first, metric));
 }
 
 StatsMetricBase *
@@ -204,6 +333,7 @@ StatsManager::getMetricObject(String objectName, UInt32 index, String metricName
 void
 StatsManager::logTopology(String component, core_id_t core_id, core_id_t master_id)
 {
+   ScopedLock sl(m_db_lock);
    sqlite3_stmt *stmt;
    sqlite3_prepare(m_db, "INSERT INTO topology (componentname, coreid, masterid) VALUES (?, ?, ?);", -1, &stmt, NULL);
    sqlite3_bind_text(stmt, 1, component.c_str(), -1, SQLITE_TRANSIENT);
@@ -220,18 +350,18 @@ StatsManager::logEvent(event_type_t event, SubsecondTime time, core_id_t core_id
    if (time == SubsecondTime::MaxTime())
       time = Sim()->getClockSkewMinimizationServer()->getGlobalTime();
 
-   sqlite3_stmt *stmt;
-   sqlite3_prepare(m_db, "INSERT INTO event (event, time, core, thread, value0, value1, description) VALUES (?, ?, ?, ?, ?, ?, ?);", -1, &stmt, NULL);
+   ScopedLock sl(m_db_lock);
+   sqlite3_stmt *stmt = m_stmt_insert_event;
+   sqlite3_reset(stmt);
    sqlite3_bind_int(stmt, 1, event);
    sqlite3_bind_int64(stmt, 2, time.getFS());
    sqlite3_bind_int(stmt, 3, core_id);
    sqlite3_bind_int(stmt, 4, thread_id);
    sqlite3_bind_int64(stmt, 5, value0);
    sqlite3_bind_int64(stmt, 6, value1);
-   sqlite3_bind_text(stmt, 7, description ? description : "", -1, SQLITE_STATIC);
+   sqlite3_bind_text(stmt, 7, description ? description : "", -1, SQLITE_TRANSIENT);
    int res = sqlite3_step(stmt);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
-   sqlite3_finalize(stmt);
 }
 
 StatHist &
@@ -2,9 +2,13 @@
 
 #include "simulator.h"
 #include "itostr.h"
+#include "_thread.h"
+#include "lock.h"
+#include "cond.h"
 
 #include <strings.h>
 #include <sqlite3.h>
+#include <deque>
 
 class StatsMetricBase
 {
@@ -55,7 +59,7 @@ class StatsMetricCallback : public StatsMetricBase
 };
 
 
-class StatsManager
+class StatsManager : public Runnable
 {
    public:
       // Event type                 core              thread            arg0           arg1              description
@@ -72,6 +76,8 @@ class StatsManager
       ~StatsManager();
       void init();
       void recordStats(String prefix);
+      // Wait until all snapshots taken by recordStats are in the database
+      void flush();
       void registerMetric(StatsMetricBase *metric);
       StatsMetricBase *getMetricObject(String objectName, UInt32 index, String metricName);
       void logTopology(String component, core_id_t core_id, core_id_t master_id);
@@ -80,6 +86,25 @@ class StatsManager
       void logEvent(event_type_t event, SubsecondTime time, core_id_t core_id, thread_id_t thread_id, UInt64 value0, UInt64 value1, const char * description);
 
    private:
+      // recordStats copies all metric values into a snapshot, which is written out
+      // as a single transaction by a background writer thread. At most m_queue_depth
+      // snapshots are pending; when the queue is full the caller writes the oldest
+      // one itself. It then waits for at most two transactions: the one the writer
+      // is committing (which holds m_db_lock), followed by its own write of the oldest
+      // snapshot. Only a full queue waits at all.
+      struct StatsValue
+      {
+         UInt64 nameid;
+         UInt32 core;
+         UInt64 value;
+      };
+      struct StatsSnapshot
+      {
+         UInt64 prefixid;
+         std::string prefix;
+         std::vector<StatsValue> values;
+      };
+
       UInt64 m_keyid;
       UInt64 m_prefixnum;
 
@@ -87,6 +112,20 @@ class StatsManager
       sqlite3_stmt *m_stmt_insert_name;
       sqlite3_stmt *m_stmt_insert_prefix;
       sqlite3_stmt *m_stmt_insert_value;
+      sqlite3_stmt *m_stmt_insert_event;
+      Lock m_db_lock;                  // Serializes all use of m_db and its statements
+
+      UInt32 m_queue_depth;            // 0: write synchronously from recordStats
+      std::deque<StatsSnapshot*> m_pending;
+      std::vector<StatsSnapshot*> m_free;
+      UInt32 m_writing;                // Snapshots currently being written by the writer thread
+      Lock m_queue_lock;               // Protects m_pending, m_free and the writer state
+      ConditionVariable m_queue_cond;
+      _Thread *m_writer;
+      bool m_writer_stop;
+
+      // All metrics with their name ID, in registration order, so a snapshot is a linear scan
+      std::vector<std::pair<UInt64, StatsMetricBase*> > m_flat_metrics;
 
       // Use std::string here because String (__versa_string) does not provide a hash function for STL containers with gcc < 4.6
       typedef std::unordered_map<UInt64, StatsMetricBase *> StatsIndexList;
@@ -99,6 +138,8 @@ class StatsManager
       int busy_handler(int count);
 
       void recordMetricName(UInt64 keyId, std::string objectName, std::string metricName);
+      void writeSnapshot(StatsSnapshot *snapshot);
+      void run();
 };
 
 template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
@@ -13,6 +13,7 @@ struct DynamicInstructionInfo
       MEMORY_WRITE,
       STRING,
       BRANCH,
+      PIC,
    } type;
 
    IntPtr eip;
@@ -29,6 +30,7 @@ struct DynamicInstructionInfo
          UInt32 size;
          UInt32 num_misses;
          HitWhere::where_t hit_where;
+         UInt32 accel_op; // CAP/PIC: op table tag of a synthetic accelerator access, 0 for normal accesses
       } memory_info;
 
       // STRING
@@ -43,6 +45,18 @@ struct DynamicInstructionInfo
          bool taken;
          IntPtr target;
       } branch_info;
+
+      // PIC
+      struct
+      {
+         UInt32 op;
+         UInt32 logic;
+         UInt32 count;
+         IntPtr src;
+         IntPtr dst;
+         SubsecondTime latency;
+         HitWhere::where_t hit_where;
+      } pic_info;
    //};
 
    // ctors
@@ -56,9 +70,10 @@ struct DynamicInstructionInfo
       type = rhs.type;
       eip = rhs.eip;
       memory_info = rhs.memory_info; // "use bigger one"
+      pic_info = rhs.pic_info;
    }
 
-   static DynamicInstructionInfo createMemoryInfo(IntPtr eip, bool e, SubsecondTime l, IntPtr a, UInt32 s, Operand::Direction dir, UInt32 num_misses, HitWhere::where_t hit_where)
+   static DynamicInstructionInfo createMemoryInfo(IntPtr eip, bool e, SubsecondTime l, IntPtr a, UInt32 s, Operand::Direction dir, UInt32 num_misses, HitWhere::where_t hit_where, UInt32 accel_op = 0)
    {
       DynamicInstructionInfo i;
       i.type = (dir == Operand::READ) ? MEMORY_READ : MEMORY_WRITE;
@@ -69,6 +84,7 @@ struct DynamicInstructionInfo
       i.memory_info.size = s;
       i.memory_info.num_misses = num_misses;
       i.memory_info.hit_where = hit_where;
+      i.memory_info.accel_op = accel_op;
       return i;
    }
 
@@ -90,6 +106,21 @@ struct DynamicInstructionInfo
       i.branch_info.target = target;
       return i;
    }
+
+   static DynamicInstructionInfo createPicInfo(IntPtr eip, UInt32 op, UInt32 logic, UInt32 count, IntPtr src, IntPtr dst)
+   {
+      DynamicInstructionInfo i;
+      i.type = PIC;
+      i.eip = eip;
+      i.pic_info.op = op;
+      i.pic_info.logic = logic;
+      i.pic_info.count = count;
+      i.pic_info.src = src;
+      i.pic_info.dst = dst;
+      i.pic_info.latency = SubsecondTime::Zero();
+      i.pic_info.hit_where = HitWhere::UNKNOWN;
+      return i;
+   }
 };
 
 #endif
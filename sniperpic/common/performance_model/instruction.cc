@@ -5,6 +5,7 @@
 #include "performance_model.h"
 #include "branch_predictor.h"
 #include "config.hpp"
+#include "micro_op.h"
 
 // Instruction
 
@@ -74,6 +75,45 @@ SubsecondTime DynamicInstruction::getCost(Core *core) const
    return m_cost;
 }
 
+// PicInstruction
+
+PicInstruction::PicInstruction()
+   : Instruction(INST_PIC)
+{
+   MicroOp *uop = new MicroOp();
+   uop->makePic();
+   uop->setInstruction(this);
+   uop->setFirst(true);
+   uop->setLast(true);
+
+   std::vector<const MicroOp *> *uops = new std::vector<const MicroOp *>();
+   uops->push_back(uop);
+   setMicroOps(uops);
+}
+
+PicInstruction::~PicInstruction()
+{
+   delete (*getMicroOps())[0];
+   delete getMicroOps();
+}
+
+// Models without micro-ops charge the whole PIC operation to the instruction,
+// the micro-op models put it on the PIC micro-op instead and do not call this
+SubsecondTime PicInstruction::getCost(Core *core) const
+{
+   PerformanceModel *perf = core->getPerformanceModel();
+   DynamicInstructionInfo* i = perf->getDynamicInstructionInfo(*this);
+   if (!i)
+      return PerformanceModel::DyninsninfoNotAvailable();
+
+   LOG_ASSERT_ERROR(i->type == DynamicInstructionInfo::PIC,
+                    "Expected PIC info in PIC instruction.");
+
+   SubsecondTime cost = i->pic_info.latency;
+   perf->popDynamicInstructionInfo();
+   return cost;
+}
+
 // StringInstruction
 
 StringInstruction::StringInstruction(OperandList &ops)
@@ -24,6 +24,7 @@ enum InstructionType
    INST_JMP,
    INST_STRING,
    INST_BRANCH,
+   INST_PIC,
    INST_DYNAMIC_MISC, // All instructions above and including this one are dynamic
    INST_RECV,
    INST_SYNC,
@@ -36,7 +37,7 @@ enum InstructionType
 };
 
 __attribute__ ((unused)) static const char * INSTRUCTION_NAMES [] =
-{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","string", "branch", "dynamic_misc","recv","sync","spawn","tlb_miss","mem_access","delay","unknown"};
+{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","string", "branch", "pic", "dynamic_misc","recv","sync","spawn","tlb_miss","mem_access","delay","unknown"};
 
 class Instruction
 {
@@ -128,6 +129,17 @@ public:
    SubsecondTime getCost(Core *core) const;
 };
 
+// PIC operation issued by the application (SimPic). A single instance per core
+// is queued for every operation, the operands come with a DynamicInstructionInfo::PIC.
+class PicInstruction : public Instruction
+{
+public:
+   PicInstruction();
+   ~PicInstruction();
+
+   SubsecondTime getCost(Core *core) const;
+};
+
 // for operations not associated with the binary -- such as processing
 // a packet
 class DynamicInstruction : public Instruction
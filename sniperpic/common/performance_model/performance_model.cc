@@ -73,13 +73,19 @@ PerformanceModel::PerformanceModel(Core *core)
    , m_elapsed_time(Sim()->getDvfsManager()->getCoreDomain(core->getId()))
    , m_idle_elapsed_time(Sim()->getDvfsManager()->getCoreDomain(core->getId()))
    #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-   , m_instruction_queue(132000 /*256*/) // Reduce from default size to keep memory issue time more or less synchronized
+   , m_instruction_queue(getQueueSize("perf_model/core/instruction_queue_size", 256)) // Reduce from default size to keep memory issue time more or less synchronized
    #else
-   , m_instruction_queue(132000 /*1024*/) // Need a bit more space for when the dyninsninfo items aren't coming in yet, or for a boatload of TLBMissInstructions
+   , m_instruction_queue(getQueueSize("perf_model/core/instruction_queue_size", 1024)) // Need a bit more space for when the dyninsninfo items aren't coming in yet, or for a boatload of TLBMissInstructions
    #endif
-   , m_dynamic_info_queue(132000/*640*/) // Required for REPZ CMPSB instructions with max counts of 256 (256 * 2 memory accesses + space for other dynamic instructions)
+   , m_dynamic_info_queue(getQueueSize("perf_model/core/dynamic_info_queue_size", 640)) // Required for REPZ CMPSB instructions with max counts of 256 (256 * 2 memory accesses + space for other dynamic instructions)
+   , m_queue_overflow_size(getQueueSize("perf_model/core/queue_overflow_size", 1048576))
+   , m_iterating(false)
+   , m_queue_drains(0)
+   , m_queue_spills(0)
+   , m_queue_spill_max(0)
    , m_current_ins_index(0)
    , m_min_dummy_inst(0)
+   , m_pic_instruction(NULL)
 {
    m_bp = BranchPredictor::create(core->getId());
 
@@ -104,6 +110,10 @@ PerformanceModel::PerformanceModel(Core *core)
    registerStatsMetric("performance_model", core->getId(), "cpiSyncDvfsTransition", &m_cpiSyncDvfsTransition);
 
    registerStatsMetric("performance_model", core->getId(), "cpiRecv", &m_cpiRecv);
+
+   registerStatsMetric("performance_model", core->getId(), "queue_drains", &m_queue_drains);
+   registerStatsMetric("performance_model", core->getId(), "queue_spills", &m_queue_spills);
+   registerStatsMetric("performance_model", core->getId(), "queue_spill_max", &m_queue_spill_max);
    
    m_min_dummy_inst = Sim()->getCfg()->getIntArray("perf_model/core/interval_timer/dispatch_width", core->getId());
  
@@ -149,12 +159,22 @@ void PerformanceModel::processAppMagic(UInt64 argument) {
 	}
 }
 
+UInt32 PerformanceModel::getQueueSize(String key, UInt32 default_size)
+{
+   config::Config *cfg = Sim()->getCfg();
+   UInt32 size = cfg->hasKey(key) ? cfg->getInt(key) : default_size;
+   LOG_ASSERT_ERROR(size > 0, "%s must be at least 1", key.c_str());
+   return size;
+}
+
 PerformanceModel::~PerformanceModel()
 {
    delete m_bp;
    delete m_fastforward_model;
    if (m_instruction_tracer)
       delete m_instruction_tracer;
+   if (m_pic_instruction)
+      delete m_pic_instruction;
 }
 
 void PerformanceModel::enable()
@@ -227,11 +247,7 @@ void PerformanceModel::queueDynamicInstruction(Instruction *i)
       }
       else
       {
-         #ifdef ENABLE_PERF_MODEL_OWN_THREAD
-            m_instruction_queue.push_wait(i);
-         #else
-            m_instruction_queue.push(i);
-         #endif
+         pushInstruction(i);
       }
    }
 }
@@ -242,14 +258,57 @@ void PerformanceModel::queueInstruction(Instruction *ins, bool is_pic_ins, bool
 	 if(!m_ignore_functional_model || is_pic_ins || is_cap_ins) {
    if (DEBUG_ENABLED)   printf("\n CAP: Inside PerformanceModel::queueInstruction: IF condition");
 
-   	#ifdef ENABLE_PERF_MODEL_OWN_THREAD
-      m_instruction_queue.push_wait(ins);
-   	#else
-      m_instruction_queue.push(ins);
-   	#endif
+      pushInstruction(ins);
 	}
 }
 
+void PerformanceModel::pushInstruction(Instruction *ins)
+{
+   #ifdef ENABLE_PERF_MODEL_OWN_THREAD
+      m_instruction_queue.push_wait(ins);
+   #else
+      if (m_instruction_queue.full() && !m_iterating)
+      {
+         ++m_queue_drains;
+         drainQueues();
+      }
+      if (m_instruction_queue.full() || !m_instruction_overflow.empty())
+      {
+         LOG_ASSERT_ERROR(m_instruction_overflow.size() < m_queue_overflow_size,
+            "Instruction queue overflow reached perf_model/core/queue_overflow_size(%u) entries that could not be modeled yet", m_queue_overflow_size);
+         m_instruction_overflow.push_back(ins);
+         ++m_queue_spills;
+         m_queue_spill_max = std::max(m_queue_spill_max, (UInt64)m_instruction_overflow.size());
+      }
+      else
+         m_instruction_queue.push(ins);
+   #endif
+}
+
+void PerformanceModel::popInstruction()
+{
+   m_instruction_queue.pop();
+   #ifndef ENABLE_PERF_MODEL_OWN_THREAD
+      if (!m_instruction_overflow.empty())
+      {
+         m_instruction_queue.push(m_instruction_overflow.front());
+         m_instruction_overflow.pop_front();
+      }
+   #endif
+}
+
+// PIC: Called from the magic instruction, before the magic instruction itself is
+// queued, so the PIC instruction and its info are in program order
+void PerformanceModel::queuePicInstruction(UInt32 op, UInt32 logic, UInt32 count, IntPtr src, IntPtr dst)
+{
+   if (!m_pic_instruction)
+      m_pic_instruction = new PicInstruction();
+
+   DynamicInstructionInfo info = DynamicInstructionInfo::createPicInfo(m_pic_instruction->getAddress(), op, logic, count, src, dst);
+   pushDynamicInstructionInfo(info, true);
+   queueInstruction(m_pic_instruction, true);
+}
+
 void PerformanceModel::handleIdleInstruction(Instruction *instruction)
 {
    // If fast-forwarding without detailed synchronization, our fast-forwarding IPC
@@ -346,6 +405,7 @@ void PerformanceModel::psuedo_iterate(
 
   if (DEBUG_ENABLED)   printf("CAP: Outside Perf Mdl Pseudo Iterate \n");
 	if (Sim()->getCfg()->getBool("general/microbench_run")) {
+		m_iterating = true;
    	while (m_instruction_queue.size() > 0) {
     	#ifdef ENABLE_PERF_MODEL_OWN_THREAD
       while(m_hold)
@@ -359,12 +419,12 @@ void PerformanceModel::psuedo_iterate(
       bool res = handleInstruction(ins);
       if (!res)
          // DynamicInstructionInfo not available
-         return;
+         break;
 
       if (ins->isDynamic())
          delete ins;
 
-      m_instruction_queue.pop();
+      popInstruction();
 
 			if(	(m_instruction_queue.size() == 0) 
 					&& is_last_loop 
@@ -402,13 +462,24 @@ void PerformanceModel::psuedo_iterate(
   			queueInstruction(dummy_inst);
 			}
 		}
+		m_iterating = false;
 	}
 }
 //#endif
 
 void PerformanceModel::iterate()
+{
+   drainQueues();
+   synchronize();
+}
+
+// Model the queued instructions until the queue is empty or the next one is
+// still missing its DynamicInstructionInfo
+void PerformanceModel::drainQueues()
 {
    if (DEBUG_ENABLED)   printf("CAP: PerformanceModel::iterate with Q size = %d\n", m_instruction_queue.size());
+   bool was_iterating = m_iterating;
+   m_iterating = true;
    while (m_instruction_queue.size() > 0)
    {
       // While the functional thread is waiting because of clock skew minimization, wait here as well
@@ -425,17 +496,14 @@ void PerformanceModel::iterate()
       bool res = handleInstruction(ins);
       if (!res)
          // DynamicInstructionInfo not available
-         return;
+         break;
 
       if (ins->isDynamic())
          delete ins;
 
-      m_instruction_queue.pop();
-     
-
+      popInstruction();
    }
-
-   synchronize();
+   m_iterating = was_iterating;
 }
 
 void PerformanceModel::synchronize()
@@ -453,7 +521,21 @@ void PerformanceModel::pushDynamicInstructionInfo(DynamicInstructionInfo &i, boo
    	#ifdef ENABLE_PERF_MODEL_OWN_THREAD
       m_dynamic_info_queue.push_wait(i);
    	#else
-      m_dynamic_info_queue.push(i);
+      if (m_dynamic_info_queue.full() && !m_iterating)
+      {
+         ++m_queue_drains;
+         drainQueues();
+      }
+      if (m_dynamic_info_queue.full() || !m_dynamic_info_overflow.empty())
+      {
+         LOG_ASSERT_ERROR(m_dynamic_info_overflow.size() < m_queue_overflow_size,
+            "Dynamic info queue overflow reached perf_model/core/queue_overflow_size(%u) entries that could not be modeled yet", m_queue_overflow_size);
+         m_dynamic_info_overflow.push_back(i);
+         ++m_queue_spills;
+         m_queue_spill_max = std::max(m_queue_spill_max, (UInt64)m_dynamic_info_overflow.size());
+      }
+      else
+         m_dynamic_info_queue.push(i);
    	#endif
 		}
 }
@@ -465,6 +547,11 @@ void PerformanceModel::popDynamicInstructionInfo()
       m_dynamic_info_queue.pop_wait();
    #else
       m_dynamic_info_queue.pop();
+      if (!m_dynamic_info_overflow.empty())
+      {
+         m_dynamic_info_queue.push(m_dynamic_info_overflow.front());
+         m_dynamic_info_overflow.pop_front();
+      }
    #endif
 }
 
@@ -509,7 +596,10 @@ DynamicInstructionInfo* PerformanceModel::getDynamicInstructionInfo(const Instru
                NULL,
                info->memory_info.size,
                Core::MEM_MODELED_RETURN,
-               instruction.getAddress()
+               instruction.getAddress(),
+               SubsecondTime::MaxTime(),
+               false,
+               info->memory_info.accel_op
             );
             info->memory_info.latency = res.latency;
             info->memory_info.hit_where = res.hit_where;
@@ -526,6 +616,15 @@ DynamicInstructionInfo* PerformanceModel::getDynamicInstructionInfo(const Instru
          info->memory_info.hit_where = HitWhere::PREDICATE_FALSE;
       }
    }
+   else if (info->type == DynamicInstructionInfo::PIC
+      && info->pic_info.hit_where == HitWhere::UNKNOWN && exec_loads)
+   {
+      // PIC operations are issued with the same policy as memory operations
+      MemoryResult res = m_core->accessPic(info->pic_info.op, info->pic_info.logic, info->pic_info.count,
+                                           info->pic_info.src, info->pic_info.dst);
+      info->pic_info.latency = res.latency;
+      info->pic_info.hit_where = res.hit_where;
+   }
 
    return info;
 }
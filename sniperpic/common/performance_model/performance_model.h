@@ -11,6 +11,7 @@
 #include "instruction_tracer.h"
 
 #include <queue>
+#include <deque>
 #include <iostream>
 #include "magic_server.h"
 
@@ -36,6 +37,7 @@ public:
 
    void queueDynamicInstruction(Instruction *i);
    void queueInstruction(Instruction *i, bool is_pic_ins = false, bool is_cap_ins = false);
+   void queuePicInstruction(UInt32 op, UInt32 logic, UInt32 count, IntPtr src, IntPtr dst);
    void handleIdleInstruction(Instruction *instruction);
    void iterate();
    virtual void synchronize();
@@ -116,6 +118,11 @@ private:
 
    DynamicInstructionInfo* getDynamicInstructionInfo();
 
+   static UInt32 getQueueSize(String key, UInt32 default_size);
+   void pushInstruction(Instruction *ins);
+   void popInstruction();
+   void drainQueues();
+
    // Simulate a single instruction
    virtual bool handleInstruction(Instruction const* instruction) = 0;
 
@@ -161,6 +168,22 @@ private:
    InstructionQueue m_instruction_queue;
    DynamicInstructionInfoQueue m_dynamic_info_queue;
 
+   // Synthetic CAP/PIC streams can outgrow the queues above. A producer that
+   // finds a queue full first models what is already queued (backpressure);
+   // when it is itself called from inside the model (e.g. a checkpoint taken
+   // on a memory access), or the model stops early for a missing
+   // DynamicInstructionInfo, that is not possible, and the entries wait here
+   // until the ring has room again. The rings are never reallocated, so the
+   // DynamicInstructionInfo being modeled stays put. Each overflow holds at
+   // most m_queue_overflow_size entries, more is a fatal error.
+   std::deque<Instruction*> m_instruction_overflow;
+   std::deque<DynamicInstructionInfo> m_dynamic_info_overflow;
+   UInt32 m_queue_overflow_size;
+   bool m_iterating;
+   UInt64 m_queue_drains;
+   UInt64 m_queue_spills;
+   UInt64 m_queue_spill_max;
+
    UInt32 m_current_ins_index;
 
    UInt32 m_min_dummy_inst;
@@ -168,6 +191,10 @@ private:
    BranchPredictor *m_bp;
 
    InstructionTracer *m_instruction_tracer;
+
+   // Shared by all PIC instructions of this core, their operands are in the DynamicInstructionInfo
+   Instruction *m_pic_instruction;
+
    static SInt64 hookProcessAppMagic(UInt64 object, UInt64 argument) {
    	((PerformanceModel*)object)->processAppMagic(argument); return 0;
    }
@@ -135,6 +135,9 @@ DynamicMicroOpNehalem::uop_port_t DynamicMicroOpNehalem::getPort(const MicroOp *
          }
       case MicroOp::UOP_SUBTYPE_BRANCH:
          return DynamicMicroOpNehalem::UOP_PORT5;
+      case MicroOp::UOP_SUBTYPE_PIC:
+         // PIC operations are issued to the L1-D like loads
+         return DynamicMicroOpNehalem::UOP_PORT2;
       default:
          LOG_PRINT_ERROR("Unknown uop_subtype %u", uop->uop_subtype);
    }
@@ -345,12 +345,24 @@ void IntervalTimer::issueMemOp(Windows::WindowEntry& micro_op)
          NULL,
          micro_op.getMicroOp()->getMemoryAccessSize(),
          Core::MEM_MODELED_RETURN,
-         micro_op.getMicroOp()->getInstruction() ? micro_op.getMicroOp()->getInstruction()->getAddress() : static_cast<uint64_t>(NULL)
+         micro_op.getMicroOp()->getInstruction() ? micro_op.getMicroOp()->getInstruction()->getAddress() : static_cast<uint64_t>(NULL),
+         SubsecondTime::MaxTime(),
+         false,
+         micro_op.getDynMicroOp()->getAccelOp()
       );
       uint64_t latency = SubsecondTime::divideRounded(res.latency, m_core->getDvfsDomain()->getPeriod());
       micro_op.getDynMicroOp()->setExecLatency(micro_op.getDynMicroOp()->getExecLatency() + latency); // execlatency already contains bypass latency
       micro_op.getDynMicroOp()->setDCacheHitWhere(res.hit_where);
    }
+   else if (micro_op.getMicroOp()->isPic()
+      && micro_op.getDynMicroOp()->getDCacheHitWhere() == HitWhere::UNKNOWN)
+   {
+      const DynamicMicroOp::PicOperands &pic = micro_op.getDynMicroOp()->getPicOperands();
+      MemoryResult res = m_core->accessPic(pic.op, pic.logic, pic.count, pic.src, pic.dst);
+      uint64_t latency = SubsecondTime::divideRounded(res.latency, m_core->getDvfsDomain()->getPeriod());
+      micro_op.getDynMicroOp()->setExecLatency(micro_op.getDynMicroOp()->getExecLatency() + latency);
+      micro_op.getDynMicroOp()->setDCacheHitWhere(res.hit_where);
+   }
 }
 
 uint64_t IntervalTimer::dispatchInstruction(Windows::WindowEntry& micro_op, StopDispatchReason& continue_dispatching)
@@ -29,6 +29,11 @@ DynamicMicroOp::DynamicMicroOp(const MicroOp *uop, const CoreModel *core_model,
 
    this->m_forceLongLatencyLoad = false;
 
+   this->accelOp = 0;
+
+   this->picOperands.op = this->picOperands.logic = this->picOperands.count = 0;
+   this->picOperands.src = this->picOperands.dst = 0;
+
    for(uint32_t i = 0 ; i < MAXIMUM_NUMBER_OF_DEPENDENCIES; i++)
       this->dependencies[i] = -1;
 
@@ -25,6 +25,8 @@ class DynamicMicroOp
 
       /** The address is valid for UOP_LOAD and UOP_STORE, it contains the load or store address. */
       Memory::Access address;
+      /** CAP/PIC op table tag of a synthetic accelerator access, 0 for normal accesses. */
+      uint32_t accelOp;
 
       /** The microop has been squashed */
       bool squashed;
@@ -56,6 +58,20 @@ class DynamicMicroOp
 
       bool m_forceLongLatencyLoad;
 
+   public:
+      /** PIC operands, only valid for PIC micro-ops. The destination is also in address. */
+      struct PicOperands
+      {
+         uint32_t op;
+         uint32_t logic;
+         uint32_t count;
+         IntPtr src;
+         IntPtr dst;
+      };
+
+   private:
+      PicOperands picOperands;
+
       /** These first/last flags are needed in case of squashing, as long as squashed uop doesn't go to rob
           and we can't use first/last flags of m_uop in such a cases.*/
       /** This microOp is the first microOp of the instruction. */
@@ -141,8 +157,14 @@ class DynamicMicroOp
       void setAddress(const Memory::Access& loadAccess) { this->address = loadAccess; }
       const Memory::Access& getAddress(void) const { return this->address; }
 
+      void setAccelOp(uint32_t tag) { this->accelOp = tag; }
+      uint32_t getAccelOp(void) const { return this->accelOp; }
+
       void setForceLongLatencyLoad(bool forceLLL) { m_forceLongLatencyLoad = forceLLL; }
 
+      const PicOperands& getPicOperands() const { LOG_ASSERT_ERROR(m_uop->isPic(), "Expected a PIC instruction."); return picOperands; }
+      void setPicOperands(const PicOperands& operands) { LOG_ASSERT_ERROR(m_uop->isPic(), "Expected a PIC instruction."); picOperands = operands; }
+
       SubsecondTime getPeriod() const { LOG_ASSERT_ERROR(m_period != SubsecondTime::Zero(), "MicroOp Period is == SubsecondTime::Zero()"); return m_period; }
 
 
@@ -45,6 +45,7 @@ MicroOp::MicroOp()
    this->serializing = false;
 
    this->branch = false;
+   this->pic = false;
 
    this->m_membar = false;
    this->is_x87 = false;
@@ -119,6 +120,27 @@ void MicroOp::makeDynamic(const String& instructionOpcodeName, uint32_t execLate
    this->setTypes();
 }
 
+// PIC: a single execute micro-op that does its own cache access at issue time.
+// Source and destination are passed in rbx and rcx (SimMagic2), the result in rax.
+// PIC operations work on the cached data, so they are ordered with the
+// surrounding loads and stores like a memory barrier.
+void MicroOp::makePic() {
+   this->uop_type = UOP_EXECUTE;
+   this->microOpTypeOffset = 0;
+   this->intraInstructionDependencies = 0;
+   this->instructionOpcode = XED_ICLASS_INVALID;
+#ifdef ENABLE_MICROOP_STRINGS
+   this->instructionOpcodeName = "pic";
+#endif
+   this->branch = false;
+   this->pic = true;
+   this->m_membar = true;
+   this->setTypes();
+   this->addSourceRegister(XED_REG_RBX, "rbx");
+   this->addSourceRegister(XED_REG_RCX, "rcx");
+   this->addDestinationRegister(XED_REG_RAX, "rax");
+}
+
 
 MicroOp::uop_subtype_t MicroOp::getSubtype_Exec(const MicroOp& uop)
 {
@@ -205,6 +227,8 @@ MicroOp::uop_subtype_t MicroOp::getSubtype(const MicroOp& uop)
       return UOP_SUBTYPE_STORE;
    else if (uop.isBranch()) // conditional branches
       return UOP_SUBTYPE_BRANCH;
+   else if (uop.isPic())
+      return UOP_SUBTYPE_PIC;
    else if (uop.isExecute())
       return getSubtype_Exec(uop);
    else
@@ -226,6 +250,8 @@ String MicroOp::getSubtypeString(uop_subtype_t uop_subtype)
          return "generic";
       case UOP_SUBTYPE_BRANCH:
          return "branch";
+      case UOP_SUBTYPE_PIC:
+         return "pic";
       default:
          LOG_ASSERT_ERROR(false, "Unknown UopType %u", uop_subtype);
          return "unknown";
@@ -69,6 +69,7 @@ struct MicroOp
       UOP_SUBTYPE_STORE,
       UOP_SUBTYPE_GENERIC,
       UOP_SUBTYPE_BRANCH,
+      UOP_SUBTYPE_PIC,
       UOP_SUBTYPE_SIZE,
    };
    uop_subtype_t uop_subtype;
@@ -119,6 +120,9 @@ struct MicroOp
    /** Is this instruction a branch ? */
    bool branch;
 
+   /** Is this a PIC operation ? Its operands and cache access come with the DynamicMicroOp. */
+   bool pic;
+
    /** Debug info about the microOperation. */
 #ifdef ENABLE_MICROOP_STRINGS
    String debugInfo;
@@ -133,6 +137,7 @@ struct MicroOp
    void makeExecute(uint32_t offset, uint32_t num_loads, xed_iclass_enum_t instructionOpcode, const String& instructionOpcodeName, bool isBranch);
    void makeStore(uint32_t offset, uint32_t num_execute, xed_iclass_enum_t instructionOpcode, const String& instructionOpcodeName, uint16_t mem_size);
    void makeDynamic(const String& instructionOpcodeName, uint32_t execLatency);
+   void makePic();
 
    static uop_subtype_t getSubtype_Exec(const MicroOp& uop);
    static uop_subtype_t getSubtype(const MicroOp& uop);
@@ -184,6 +189,8 @@ struct MicroOp
 
    bool isBranch() const { return this->branch; }
 
+   bool isPic() const { return this->pic; }
+
    bool isInterrupt() const { return this->interrupt; }
    void setInterrupt(bool interrupt) { this->interrupt = interrupt; }
 
@@ -309,6 +309,7 @@ bool MicroOpPerformanceModel::handleInstruction(Instruction const* instruction)
                Memory::Access addr;
                addr.set(info->memory_info.addr);
                m_current_uops[load_index]->setAddress(addr);
+               m_current_uops[load_index]->setAccelOp(info->memory_info.accel_op);
                m_current_uops[load_index]->setDCacheHitWhere(info->memory_info.hit_where);
                ++m_state_num_reads_done;
             }
@@ -347,6 +348,7 @@ bool MicroOpPerformanceModel::handleInstruction(Instruction const* instruction)
                Memory::Access addr;
                addr.set(info->memory_info.addr);
                m_current_uops[store_index]->setAddress(addr);
+               m_current_uops[store_index]->setAccelOp(info->memory_info.accel_op);
                m_current_uops[store_index]->setDCacheHitWhere(info->memory_info.hit_where);
                ++m_state_num_writes_done;
                if(DEBUG_ENABLED)  printf("\n CAP: For Inst at 0x%x, MEM STORE microop to addr: 0x%x", instruction->getAddress(), info->memory_info.addr);
@@ -378,6 +380,37 @@ bool MicroOpPerformanceModel::handleInstruction(Instruction const* instruction)
 
    }
 
+   if (instruction->getType() == INST_PIC)
+   {
+      // PIC: the operands come with the DynamicInstructionInfo, the cache access
+      // is done here or, like memory operations, by the timer at issue time
+      DynamicInstructionInfo *info = getDynamicInstructionInfo(*instruction, m_issue_memops);
+      if (!info)
+         return false;
+
+      LOG_ASSERT_ERROR(info->type == DynamicInstructionInfo::PIC,
+                       "Expected PIC info, got: %d.", info->type);
+      LOG_ASSERT_ERROR(exec_base_index != SIZE_MAX && m_current_uops[exec_base_index]->getMicroOp()->isPic(),
+                       "Expected to find a PIC micro-op here.");
+
+      DynamicMicroOp::PicOperands operands;
+      operands.op = info->pic_info.op;
+      operands.logic = info->pic_info.logic;
+      operands.count = info->pic_info.count;
+      operands.src = info->pic_info.src;
+      operands.dst = info->pic_info.dst;
+
+      DynamicMicroOp *uop = m_current_uops[exec_base_index];
+      uop->setPicOperands(operands);
+      Memory::Access addr;
+      addr.set(info->pic_info.dst);
+      uop->setAddress(addr);
+      uop->setExecLatency(uop->getExecLatency() + SubsecondTime::divideRounded(info->pic_info.latency, m_state_insn_period));
+      uop->setDCacheHitWhere(info->pic_info.hit_where);
+
+      popDynamicInstructionInfo();
+   }
+
    if(do_squashing > 0)
       doSquashing();
 
@@ -390,7 +423,8 @@ bool MicroOpPerformanceModel::handleInstruction(Instruction const* instruction)
    // Because getCost may fail if there are missing DynInstrInfo's, do not call getCost() anywhere else but here
    // If it fails, keep state because we are waiting for processing that needs to occur,
    // but some costs (I-cache access) have already been resolved
-   SubsecondTime insn_cost = instruction->getCost(getCore());
+   // PIC instructions have already consumed their DynamicInstructionInfo above
+   SubsecondTime insn_cost = instruction->getType() == INST_PIC ? SubsecondTime::Zero() : instruction->getCost(getCore());
    if (insn_cost == PerformanceModel::DyninsninfoNotAvailable())
       return false;
 
@@ -592,7 +592,9 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
          uop.getMicroOp()->getMemoryAccessSize(),
          Core::MEM_MODELED_RETURN,
          uop.getMicroOp()->getInstruction() ? uop.getMicroOp()->getInstruction()->getAddress() : static_cast<uint64_t>(NULL),
-         now.getElapsedTime()
+         now.getElapsedTime(),
+         false,
+         uop.getAccelOp()
       );
   
   //   printf("\n CAP: RobTimer::accessMem uop's d_addr: 0x%lu and i_addr: 0x%lu", uop.getAddress().address, uop.getMicroOp()->getInstruction()->getAddress());
@@ -602,6 +604,16 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
       uop.setExecLatency(uop.getExecLatency() + latency); // execlatency already contains bypass latency
       uop.setDCacheHitWhere(res.hit_where);
    }
+   else if (uop.getMicroOp()->isPic() && uop.getDCacheHitWhere() == HitWhere::UNKNOWN)
+   {
+      const DynamicMicroOp::PicOperands &pic = uop.getPicOperands();
+      MemoryResult res = m_core->accessPic(pic.op, pic.logic, pic.count, pic.src, pic.dst, now.getElapsedTime());
+
+      uint64_t latency = SubsecondTime::divideRounded(res.latency, now.getPeriod());
+
+      uop.setExecLatency(uop.getExecLatency() + latency);
+      uop.setDCacheHitWhere(res.hit_where);
+   }
 
    if (uop.getMicroOp()->isLoad())
    {
@@ -637,6 +649,11 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
       LOG_ASSERT_ERROR(entry->addressReady <= entry->ready, "%ld: Store address cannot be ready (%ld) later than the whole uop is (%ld)",
                        entry->uop->getSequenceNumber(), entry->addressReady.getPS(), entry->ready.getPS());
    }
+   else if (uop.getMicroOp()->isPic())
+   {
+      // PIC operations write the cache, later fences wait for them like for stores
+      last_store_done = std::max(last_store_done, cycle_done);
+   }
 
    if (m_rob_contention)
       m_rob_contention->doIssue(uop);
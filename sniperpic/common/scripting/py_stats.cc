@@ -139,6 +139,19 @@ writeStats(PyObject *self, PyObject *args)
 }
 
 
+//////////
+// flush(): wait until all statistics written with write() are in the database
+//////////
+
+static PyObject *
+flushStats(PyObject *self, PyObject *args)
+{
+   Sim()->getStatsManager()->flush();
+
+   Py_RETURN_NONE;
+}
+
+
 //////////
 // register(): register a callback function that returns a statistics value
 //////////
@@ -247,6 +260,7 @@ static PyMethodDef PyStatsMethods[] = {
    {"get",  getStatsValue, METH_VARARGS, "Retrieve current value of statistic (objectName, index, metricName)."},
    {"getter", getStatsGetter, METH_VARARGS, "Return object to retrieve statistics value."},
    {"write", writeStats, METH_VARARGS, "Write statistics (<prefix>, [<filename>])."},
+   {"flush", flushStats, METH_VARARGS, "Wait until all written statistics are in sim.stats.sqlite3."},
    {"register", registerStats, METH_VARARGS, "Register callback that defines statistics value for (objectName, index, metricName)."},
    {"register_per_thread", registerPerThread, METH_VARARGS, "Add a per-thread statistic (perthreadName) based on a named statistic (objectName, metricName)."},
    {"marker", writeMarker, METH_VARARGS, "Record a marker (coreid, threadid, arg0, arg1, [description])."},
@@ -21,6 +21,10 @@ void setInstrumentationMode(UInt64 opt)
 
 UInt64 handleMagicInstruction(thread_id_t thread_id, UInt64 cmd, UInt64 arg0, UInt64 arg1)
 {
+   // PIC instructions carry their operation in the upper bits of the command
+   if (SIM_CMD_ID(cmd) == SIM_CMD_PIC)
+      return handleMagic(thread_id, cmd, arg0, arg1);
+
    switch(cmd)
    {
    case SIM_CMD_ROI_TOGGLE:
@@ -29,6 +29,9 @@ UInt64 MagicServer::Magic(thread_id_t thread_id, core_id_t core_id, UInt64 cmd,
 
 UInt64 MagicServer::Magic_unlocked(thread_id_t thread_id, core_id_t core_id, UInt64 cmd, UInt64 arg0, UInt64 arg1)
 {
+   if (SIM_CMD_ID(cmd) == SIM_CMD_PIC)
+      return issuePicInstruction(core_id, cmd, arg0, arg1);
+
    switch(cmd)
    {
       case SIM_CMD_ROI_TOGGLE:
@@ -162,6 +165,20 @@ void MagicServer::disablePerformance()
    PinDetach();
 }
 
+// PIC: In detailed mode the operation becomes a PIC instruction of the core, right
+// before the magic instruction itself. Otherwise it is executed functionally now.
+UInt64 MagicServer::issuePicInstruction(core_id_t core_id, UInt64 cmd, UInt64 src, UInt64 dst)
+{
+   Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
+   LOG_ASSERT_ERROR(core != NULL, "PIC instruction issued outside of a core");
+
+   if (Sim()->getInstrumentationMode() == InstMode::DETAILED)
+      core->getPerformanceModel()->queuePicInstruction(SIM_PIC_OP(cmd), SIM_PIC_LOGIC(cmd), SIM_PIC_COUNT(cmd), src, dst);
+   else
+      core->accessPic(SIM_PIC_OP(cmd), SIM_PIC_LOGIC(cmd), SIM_PIC_COUNT(cmd), src, dst);
+   return 0;
+}
+
 void print_allocations();
 
 UInt64 MagicServer::setPerformance(bool enabled)
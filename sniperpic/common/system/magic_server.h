@@ -32,6 +32,7 @@ class MagicServer
       UInt64 setPerformance(bool enabled);
 
       UInt64 setInstrumentationMode(UInt64 sim_api_opt);
+      UInt64 issuePicInstruction(core_id_t core_id, UInt64 cmd, UInt64 src, UInt64 dst);
 
       void setProgress(float progress) { m_progress.setProgress(progress); }
 
@@ -163,6 +163,8 @@ Simulator::~Simulator()
    }
 
    m_stats_manager->recordStats("stop");
+   // Scripts may access the database from their SIM_END hooks
+   m_stats_manager->flush();
    m_hooks_manager->callHooks(HookType::HOOK_SIM_END, 0);
 
    TotalTimer::reports();
@@ -17,6 +17,25 @@
 #define SIM_CMD_NUM_THREADS     12
 #define SIM_CMD_NAMED_MARKER    13
 #define SIM_CMD_SET_THREAD_NAME 14
+#define SIM_CMD_PIC             15
+
+// PIC instruction: the operation, the logical function and the vector count are
+// encoded in the upper bits of the command, source and destination are the arguments
+#define SIM_CMD_ID(cmd)         ((cmd) & 0xff)
+#define SIM_PIC_CMD(op, logic, count) \
+   (SIM_CMD_PIC | ((unsigned long)(op) << 8) | ((unsigned long)(logic) << 16) | ((unsigned long)(count) << 24))
+#define SIM_PIC_OP(cmd)         (((cmd) >> 8) & 0xff)
+#define SIM_PIC_LOGIC(cmd)      (((cmd) >> 16) & 0xff)
+#define SIM_PIC_COUNT(cmd)      (((cmd) >> 24) & 0xffffffff)
+
+#define SIM_PIC_COPY            0  // dst = src
+#define SIM_PIC_CMP             1  // compare src with dst
+#define SIM_PIC_SEARCH          2  // compare count lines of src with the key at dst
+#define SIM_PIC_LOGICAL         4  // dst = src <logic> dst
+
+#define SIM_PIC_LOGIC_OR        0
+#define SIM_PIC_LOGIC_AND       1
+#define SIM_PIC_LOGIC_XOR       2
 
 #define SIM_OPT_INSTRUMENT_DETAILED    0
 #define SIM_OPT_INSTRUMENT_WARMUP      1
@@ -90,5 +109,7 @@
 #define SimUser(cmd, arg)         SimMagic2(SIM_CMD_USER, cmd, arg)
 #define SimSetInstrumentMode(opt) SimMagic1(SIM_CMD_INSTRUMENT_MODE, opt)
 #define SimInSimulator()          (SimMagic0(SIM_CMD_IN_SIMULATOR)!=SIM_CMD_IN_SIMULATOR)
+#define SimPic(op, src, dst, count) SimMagic2(SIM_PIC_CMD(op, 0, count), (unsigned long)(src), (unsigned long)(dst))
+#define SimPicLogical(logic, src, dst, count) SimMagic2(SIM_PIC_CMD(SIM_PIC_LOGICAL, logic, count), (unsigned long)(src), (unsigned long)(dst))
 
 #endif /* __SIM_API */
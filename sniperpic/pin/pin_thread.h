@@ -10,11 +10,13 @@ public:
    PinThread(ThreadFunc func, void *param);
    ~PinThread();
    void run();
+   void join();
 
 private:
    static const int STACK_SIZE=65536;
 
    THREADID m_thread_p;
+   PIN_THREAD_UID m_thread_uid;
    _Thread::ThreadFunc m_func;
    void *m_param;
 };
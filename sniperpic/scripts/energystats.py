@@ -80,6 +80,7 @@ class EnergyStats:
       self.in_stats_write = True
       sim.stats.write(current)
       self.in_stats_write = False
+      sim.stats.flush()
       #   If we also have a previous snapshot: update power
       if self.name_last:
         power = self.run_power(self.name_last, current)
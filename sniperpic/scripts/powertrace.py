@@ -27,6 +27,7 @@ class PowerTrace:
     self.do_power(self.t_last, None)
 
   def do_power(self, t0, t1):
+    sim.stats.flush() # mcpat.py reads the snapshots from sim.stats.sqlite3
     _t0 = t0 or 'roi-begin'
     _t1 = t1 or 'roi-end'
     if not t1: t1 = self.t_roi_end
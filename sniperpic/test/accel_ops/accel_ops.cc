@@ -0,0 +1,168 @@
+#include "fixed_types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <vector>
+#include <unordered_map>
+
+// Cost of recognising CAP/PIC ops on the per-access path of
+// MemoryManager::coreInitiateMemoryAccess, without the caches behind it.
+//
+// "address" is the previous lookup: every access probes capInsInfoMap, the head
+// of picInsInfoVec and picInsInfoMap, and a PIC microbenchmark run probes
+// picInsInfoMap once more for the second-source TLB access. Pending ops are
+// keyed by address. "tagged" is the op table: a synthetic access carries an
+// index (plus one) into a recycled table, and other accesses test it for zero.
+//
+// One access in 64 is a synthetic op, the others are plain loads and stores
+// spread over 64 MB. The maps hold a given number of other pending ops.
+//
+//   ./accel_ops [accesses per run, default 50M]
+
+struct CAPInsInfo { UInt32 op; IntPtr addr; Byte* buf; UInt32 length; UInt32 stream_id; };
+struct PicInsInfo { UInt32 op; IntPtr other_source; IntPtr other_source2; bool is_vpic; UInt32 count; };
+struct AcceleratorOp { bool is_cap; CAPInsInfo cap; PicInsInfo pic; };
+
+static const UInt32 op_interval = 64;
+
+static double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static std::vector<IntPtr> makeAddresses(UInt32 count)
+{
+   std::vector<IntPtr> addresses(count);
+   for (UInt32 i = 0; i < count; ++i)
+      addresses[i] = 0x10000000 + (IntPtr(rand() % (1 << 20)) << 6);
+   return addresses;
+}
+
+static UInt64 runAddress(const std::vector<IntPtr>& addresses, UInt64 accesses, UInt32 pending)
+{
+   std::unordered_map<IntPtr, CAPInsInfo> capInsInfoMap;
+   std::unordered_map<IntPtr, PicInsInfo> picInsInfoMap;
+   std::vector<std::pair<IntPtr, PicInsInfo> > picInsInfoVec;
+   // Ops queued for later, outside the accessed range so they never hit
+   for (UInt32 i = 0; i < pending; ++i)
+   {
+      capInsInfoMap[0x80000000 + (IntPtr(i) << 6)] = CAPInsInfo();
+      picInsInfoMap[0x90000000 + (IntPtr(i) << 6)] = PicInsInfo();
+   }
+   const UInt32 mask = addresses.size() - 1;
+   UInt64 found = 0;
+   for (UInt64 i = 0; i < accesses; ++i)
+   {
+      IntPtr address = addresses[i & mask];
+      if (i % op_interval == 0)
+      {
+         // The op is recorded by address when its synthetic access is created
+         address = 0xa0000000 + ((i / op_interval) % 4096 << 6);
+         PicInsInfo pii = { 1, address + 64, 0, false, 0 };
+         picInsInfoMap[address] = pii;
+      }
+      // Second-source TLB access of microbenchmark runs
+      if (picInsInfoMap.find(address) != picInsInfoMap.end())
+         found += picInsInfoMap[address].other_source & 1;
+      if (capInsInfoMap.find(address) != capInsInfoMap.end())
+      {
+         found += capInsInfoMap[address].length;
+         capInsInfoMap.erase(address);
+         continue;
+      }
+      if (picInsInfoVec.size() && picInsInfoVec[0].first == address)
+      {
+         picInsInfoVec.erase(picInsInfoVec.begin());
+         continue;
+      }
+      if (picInsInfoMap.find(address) != picInsInfoMap.end())
+      {
+         found += picInsInfoMap[address].op;
+         picInsInfoMap.erase(address);
+         continue;
+      }
+      found += address & 1;
+   }
+   return found;
+}
+
+static UInt64 runTagged(const std::vector<IntPtr>& addresses, UInt64 accesses, UInt32 pending)
+{
+   std::vector<AcceleratorOp> ops;
+   std::vector<UInt32> ops_free;
+   pthread_mutex_t lock;
+   pthread_mutex_init(&lock, NULL);
+   for (UInt32 i = 0; i < pending; ++i)
+      ops.push_back(AcceleratorOp());
+   const UInt32 mask = addresses.size() - 1;
+   UInt64 found = 0;
+   for (UInt64 i = 0; i < accesses; ++i)
+   {
+      IntPtr address = addresses[i & mask];
+      UInt32 accel_op = 0;
+      if (i % op_interval == 0)
+      {
+         // newPicOp when the synthetic access is created
+         AcceleratorOp aop;
+         aop.is_cap = false;
+         PicInsInfo pii = { 1, address + 64, 0, false, 0 };
+         aop.pic = pii;
+         pthread_mutex_lock(&lock);
+         if (ops_free.size())
+         {
+            accel_op = ops_free.back() + 1;
+            ops_free.pop_back();
+            ops[accel_op - 1] = aop;
+         }
+         else
+         {
+            ops.push_back(aop);
+            accel_op = ops.size();
+         }
+         pthread_mutex_unlock(&lock);
+      }
+      if (accel_op)
+      {
+         // takeAcceleratorOp
+         pthread_mutex_lock(&lock);
+         ops_free.push_back(accel_op - 1);
+         AcceleratorOp aop = ops[accel_op - 1];
+         pthread_mutex_unlock(&lock);
+         found += aop.pic.op + (aop.pic.other_source & 1);
+         continue;
+      }
+      found += address & 1;
+   }
+   pthread_mutex_destroy(&lock);
+   return found;
+}
+
+int main(int argc, char** argv)
+{
+   UInt64 accesses = argc > 1 ? strtoull(argv[1], NULL, 0) : 50000000;
+   static const UInt32 pendings[] = { 0, 16, 1024, 65536 };
+
+   std::vector<IntPtr> addresses = makeAddresses(1 << 20);
+
+   printf("# %lu accesses, one CAP/PIC op every %u\n", (unsigned long)accesses, op_interval);
+   printf("%-10s %10s %10s %10s %10s\n", "# pending", "address", "tagged", "ns saved", "speedup");
+   printf("%-10s %10s %10s %10s\n", "#", "Macc/s", "Macc/s", "/access");
+   for (UInt32 i = 0; i < sizeof(pendings) / sizeof(pendings[0]); ++i)
+   {
+      double start = now();
+      UInt64 check_address = runAddress(addresses, accesses, pendings[i]);
+      double time_address = now() - start;
+      start = now();
+      UInt64 check_tagged = runTagged(addresses, accesses, pendings[i]);
+      double time_tagged = now() - start;
+      printf("%-10u %10.1f %10.1f %10.1f %9.1fx %s\n", pendings[i],
+             accesses / time_address / 1e6, accesses / time_tagged / 1e6,
+             (time_address - time_tagged) / accesses * 1e9, time_address / time_tagged,
+             check_address == check_tagged ? "ok" : "MISMATCH");
+   }
+   return 0;
+}
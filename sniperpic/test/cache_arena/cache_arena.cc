@@ -0,0 +1,283 @@
+#include "fixed_types.h"
+#include "cache_arena.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <vector>
+#include <new>
+
+// Cache construction time, resident memory and the cost of cache-heavy
+// simulation for the caches of a 64-core configuration. "heap" places every set
+// the way CacheSet does without an arena: the set object, its tag array, its
+// CacheBlockInfos and its data blocks are separate heap allocations, and the
+// data is memset. "arena" places them in one CacheArena per cache, in set order,
+// with the same sizing as Cache::Cache.
+//
+// The access phase walks the L1-D, L2 and NUCA set of random addresses of random
+// cores, touching the set header, its tags, one block info and one line, as a
+// lookup that hits does. dTLB load misses are read from perf_event_open when
+// the host allows it; huge-MB is the memory actually backed by transparent
+// hugepages after construction.
+//
+//   ./cache_arena [cores, default 64] [accesses, default 20M]
+
+struct Geometry
+{
+   const char* name;
+   UInt32 num_sets;
+   UInt32 associativity;
+};
+
+// 32 KB/4-way L1-I, 32 KB/8-way L1-D, 256 KB/8-way L2, 4 MB/16-way NUCA slice per core, 64 B lines
+static const Geometry geometries[] = {
+   { "L1-I", 128, 4 },
+   { "L1-D", 64, 8 },
+   { "L2", 512, 8 },
+   { "nuca-cache", 4096, 16 },
+};
+static const UInt32 num_geometries = sizeof(geometries) / sizeof(geometries[0]);
+static const UInt32 blocksize = 64;
+static const UInt32 pad_ways = 4;
+
+// Same footprint as a SharedCacheBlockInfo: vtable, tag, state, owner, sharers
+class BlockInfo
+{
+   public:
+      BlockInfo() : m_tag(~(IntPtr)0), m_cstate(0), m_owner(0), m_sharers(0) {}
+      virtual ~BlockInfo() {}
+      UInt32 touch() { return ++m_cstate; }
+   private:
+      IntPtr m_tag;
+      UInt32 m_cstate;
+      UInt64 m_owner;
+      UInt64 m_sharers;
+};
+
+// Same fields as a CacheSetLRU; its LRU bits stay on the heap in both layouts
+class Set
+{
+   public:
+      Set(UInt32 associativity, CacheArena* arena)
+         : m_arena(arena), m_associativity(associativity), m_num_attempts(1)
+      {
+         UInt32 num_tags = (associativity + pad_ways - 1) & ~(pad_ways - 1);
+         if (arena)
+         {
+            m_tags = (IntPtr*) arena->allocate(num_tags * sizeof(IntPtr), 32);
+            m_block_infos = (char*) arena->allocate(associativity * sizeof(BlockInfo));
+            m_blocks = (char*) arena->allocate(associativity * blocksize);
+         }
+         else
+         {
+            m_tags = new IntPtr[num_tags];
+            m_block_infos = (char*) ::operator new(associativity * sizeof(BlockInfo));
+            m_blocks = new char[associativity * blocksize];
+            memset(m_blocks, 0x00, associativity * blocksize);
+         }
+         for (UInt32 i = 0; i < num_tags; ++i)
+            m_tags[i] = i < associativity ? (IntPtr(i) << 20) : ~(IntPtr)0;
+         for (UInt32 i = 0; i < associativity; ++i)
+            new (m_block_infos + i * sizeof(BlockInfo)) BlockInfo();
+         m_lru_bits = new UInt8[associativity];
+         for (UInt32 i = 0; i < associativity; ++i)
+            m_lru_bits[i] = i;
+      }
+
+      virtual ~Set()
+      {
+         for (UInt32 i = 0; i < m_associativity; ++i)
+            ((BlockInfo*)(m_block_infos + i * sizeof(BlockInfo)))->~BlockInfo();
+         delete [] m_lru_bits;
+         if (!m_arena)
+         {
+            ::operator delete(m_block_infos);
+            delete [] m_tags;
+            delete [] m_blocks;
+         }
+      }
+
+      UInt64 access(IntPtr tag)
+      {
+         for (SInt32 way = m_associativity - 1; way >= 0; --way)
+            if (m_tags[way] == tag)
+            {
+               UInt64 cstate = ((BlockInfo*)(m_block_infos + way * sizeof(BlockInfo)))->touch();
+               m_lru_bits[way] = 0;
+               return cstate + m_blocks[way * blocksize + (tag & (blocksize - 1))];
+            }
+         return 0;
+      }
+
+   private:
+      CacheArena* m_arena;
+      IntPtr* m_tags;
+      char* m_block_infos;
+      char* m_blocks;
+      UInt32 m_associativity;
+      UInt8* m_lru_bits;
+      UInt32 m_num_attempts;
+};
+
+struct Cache
+{
+   CacheArena* arena;
+   Set** sets;
+   UInt32 num_sets;
+};
+
+static double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static long residentMB()
+{
+   long pages = 0, resident = 0;
+   FILE* fp = fopen("/proc/self/statm", "r");
+   if (fp)
+   {
+      if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+         resident = 0;
+      fclose(fp);
+   }
+   return resident * sysconf(_SC_PAGESIZE) >> 20;
+}
+
+// Anonymous memory backed by transparent hugepages
+static long hugeMB()
+{
+   long kb = 0;
+   char line[256];
+   FILE* fp = fopen("/proc/self/smaps_rollup", "r");
+   if (fp)
+   {
+      while (fgets(line, sizeof(line), fp))
+         if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1)
+            break;
+      fclose(fp);
+   }
+   return kb >> 10;
+}
+
+static int openDtlbCounter()
+{
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.size = sizeof(attr);
+   attr.type = PERF_TYPE_HW_CACHE;
+   attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+   attr.disabled = 1;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void run(const char* name, bool use_arena, UInt32 num_cores, UInt64 accesses)
+{
+   const UInt32 num_caches = num_cores * num_geometries;
+   std::vector<Cache> caches(num_caches);
+   long rss_before = residentMB();
+
+   double start = now();
+   for (UInt32 c = 0; c < num_caches; ++c)
+   {
+      const Geometry& g = geometries[c % num_geometries];
+      Cache& cache = caches[c];
+      cache.num_sets = g.num_sets;
+      cache.arena = NULL;
+      if (use_arena)
+      {
+         UInt64 set_bytes = 256
+            + 64 + ((g.associativity + pad_ways - 1) & ~(pad_ways - 1)) * sizeof(IntPtr)
+            + 64 + g.associativity * sizeof(BlockInfo)
+            + 64 + g.associativity * blocksize;
+         cache.arena = new CacheArena(g.num_sets * set_bytes);
+      }
+      cache.sets = new Set*[g.num_sets];
+      for (UInt32 i = 0; i < g.num_sets; ++i)
+         cache.sets[i] = cache.arena ? new (cache.arena->allocate(sizeof(Set))) Set(g.associativity, cache.arena)
+                                     : new Set(g.associativity, NULL);
+   }
+   double time_create = now() - start;
+   long rss = residentMB() - rss_before;
+   long huge = hugeMB();
+
+   // Random core, then its L1-D, L2 and NUCA set of a random line, all hits
+   srand(1);
+   std::vector<UInt64> keys(1 << 20);
+   for (UInt32 i = 0; i < keys.size(); ++i)
+      keys[i] = (UInt64(rand()) << 31) ^ rand();
+   const UInt32 key_mask = keys.size() - 1;
+
+   int fd = openDtlbCounter();
+   if (fd >= 0)
+   {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+   }
+   UInt64 sum = 0;
+   start = now();
+   for (UInt64 i = 0; i < accesses; ++i)
+   {
+      UInt64 key = keys[i & key_mask];
+      UInt32 core = key % num_cores;
+      for (UInt32 level = 1; level < num_geometries; ++level)
+      {
+         const Geometry& g = geometries[level];
+         Cache& cache = caches[core * num_geometries + level];
+         UInt32 set = (key >> 8) % g.num_sets;
+         IntPtr tag = IntPtr((key >> 40) % g.associativity) << 20;
+         sum += cache.sets[set]->access(tag);
+      }
+   }
+   double time_access = now() - start;
+   long long dtlb_misses = -1;
+   if (fd >= 0)
+   {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &dtlb_misses, sizeof(dtlb_misses)) != sizeof(dtlb_misses))
+         dtlb_misses = -1;
+      close(fd);
+   }
+
+   start = now();
+   for (UInt32 c = 0; c < num_caches; ++c)
+   {
+      for (UInt32 i = 0; i < caches[c].num_sets; ++i)
+         if (caches[c].arena)
+            caches[c].sets[i]->~Set();
+         else
+            delete caches[c].sets[i];
+      delete [] caches[c].sets;
+      delete caches[c].arena;
+   }
+   double time_destroy = now() - start;
+
+   char tlb[32];
+   if (dtlb_misses >= 0)
+      snprintf(tlb, sizeof(tlb), "%10.3f", dtlb_misses / double(accesses));
+   else
+      snprintf(tlb, sizeof(tlb), "%10s", "n/a");
+   printf("%-6s %9.1f %8ld %8ld %9.1f %10.1f %s %9.1f  check %lu\n", name, time_create * 1e3, rss, huge,
+          time_access / accesses * 1e9, accesses / time_access / 1e6, tlb, time_destroy * 1e3, (unsigned long)(sum & 0xff));
+}
+
+int main(int argc, char** argv)
+{
+   UInt32 num_cores = argc > 1 ? atoi(argv[1]) : 64;
+   UInt64 accesses = argc > 2 ? strtoull(argv[2], NULL, 0) : 20000000;
+
+   printf("# %u cores, %lu accesses of L1-D, L2 and NUCA sets\n", num_cores, (unsigned long)accesses);
+   printf("%-6s %9s %8s %8s %9s %10s %10s %9s\n", "# sets", "create-ms", "rss-MB", "huge-MB", "ns/access", "Maccess/s", "dTLB/acc", "free-ms");
+   run("heap", false, num_cores, accesses);
+   run("arena", true, num_cores, accesses);
+   return 0;
+}
@@ -0,0 +1,144 @@
+#include "fixed_types.h"
+#include "cache_set_tags.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+#include <algorithm>
+
+// Tag lookups/s of CacheSet::find on the cache geometries of the PIC configs.
+// "blocks" is the previous layout, one heap object per way scanned through a
+// pointer array; "scalar" is the per-set tag array searched with
+// CacheSetTags::matchWaysScalar, which isolates the layout change; "tags" is the
+// same array searched with the vector kernel of CacheSetTags::matchWays.
+// Half the lookups hit.
+//
+//   ./cache_tags [lookups per geometry, default 20M]
+
+struct Geometry
+{
+   const char* name;
+   UInt32 num_sets;
+   UInt32 associativity;
+};
+
+// 32 KB/8-way L1-D, 256 KB/8-way L2, 8 MB/16-way L3 and NUCA slice, 64 B lines
+static const Geometry geometries[] = {
+   { "L1-D", 64, 8 },
+   { "L2", 512, 8 },
+   { "L3", 8192, 16 },
+   { "nuca-cache", 4096, 16 },
+};
+
+// Same footprint as a SharedCacheBlockInfo: vtable, tag, state, owner, sharers
+class Block
+{
+   public:
+      Block() : m_tag(CacheSetTags::InvalidTag), m_cstate(0), m_owner(0) {}
+      virtual ~Block() {}
+      IntPtr getTag() const { return m_tag; }
+      void setTag(IntPtr tag) { m_tag = tag; }
+   private:
+      IntPtr m_tag;
+      UInt32 m_cstate;
+      UInt64 m_owner;
+      UInt64 m_sharers;
+};
+
+static double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void run(const Geometry& g, UInt64 lookups)
+{
+   const UInt32 padded = CacheSetTags::paddedWays(g.associativity);
+   const UInt32 num_blocks = g.num_sets * g.associativity;
+
+   // Blocks are allocated in random order, as they end up after warmup
+   std::vector<UInt32> order(num_blocks);
+   for (UInt32 i = 0; i < num_blocks; ++i)
+      order[i] = i;
+   std::random_shuffle(order.begin(), order.end());
+   std::vector<Block*> blocks(num_blocks);
+   for (UInt32 i = 0; i < num_blocks; ++i)
+      blocks[order[i]] = new Block();
+
+   std::vector<IntPtr> tags(g.num_sets * padded, CacheSetTags::InvalidTag);
+   for (UInt32 set = 0; set < g.num_sets; ++set)
+      for (UInt32 way = 0; way < g.associativity; ++way)
+      {
+         IntPtr tag = (IntPtr(way) << 20) | set;
+         blocks[set * g.associativity + way]->setTag(tag);
+         tags[set * padded + way] = tag;
+      }
+
+   std::vector<IntPtr> keys(1 << 16);
+   std::vector<UInt32> sets(keys.size());
+   for (UInt32 i = 0; i < keys.size(); ++i)
+   {
+      sets[i] = rand() % g.num_sets;
+      // Ways at 2*associativity and beyond are never resident
+      keys[i] = (IntPtr(rand() % (2 * g.associativity)) << 20) | sets[i];
+   }
+   const UInt32 key_mask = keys.size() - 1;
+
+   UInt64 hits_blocks = 0;
+   double start = now();
+   for (UInt64 i = 0; i < lookups; ++i)
+   {
+      UInt32 set = sets[i & key_mask];
+      IntPtr key = keys[i & key_mask];
+      Block** ways = &blocks[set * g.associativity];
+      for (SInt32 way = g.associativity - 1; way >= 0; --way)
+         if (ways[way]->getTag() == key)
+         {
+            hits_blocks += way + 1;
+            break;
+         }
+   }
+   double time_blocks = now() - start;
+
+   UInt64 hits_scalar = 0;
+   start = now();
+   for (UInt64 i = 0; i < lookups; ++i)
+   {
+      UInt32 set = sets[i & key_mask];
+      UInt64 match = CacheSetTags::matchWaysScalar(&tags[set * padded], g.associativity, keys[i & key_mask]);
+      if (match)
+         hits_scalar += 64 - __builtin_clzll(match);
+   }
+   double time_scalar = now() - start;
+
+   UInt64 hits_tags = 0;
+   start = now();
+   for (UInt64 i = 0; i < lookups; ++i)
+   {
+      UInt32 set = sets[i & key_mask];
+      UInt64 match = CacheSetTags::matchWays(&tags[set * padded], g.associativity, keys[i & key_mask]);
+      if (match)
+         hits_tags += 64 - __builtin_clzll(match);
+   }
+   double time_tags = now() - start;
+
+   printf("%-12s %6u %4u %10.1f %10.1f %10.1f %6.2fx %s\n", g.name, g.num_sets, g.associativity,
+          lookups / time_blocks / 1e6, lookups / time_scalar / 1e6, lookups / time_tags / 1e6,
+          time_blocks / time_tags, hits_blocks == hits_tags && hits_scalar == hits_tags ? "ok" : "MISMATCH");
+
+   for (UInt32 i = 0; i < num_blocks; ++i)
+      delete blocks[i];
+}
+
+int main(int argc, char** argv)
+{
+   UInt64 lookups = argc > 1 ? strtoull(argv[1], NULL, 0) : 20000000;
+
+   printf("# way search: %s\n", CacheSetTags::isaString());
+   printf("# Mlookups/s\n%-12s %6s %4s %10s %10s %10s %7s\n", "# cache", "sets", "ways", "blocks", "scalar", "tags", "speedup");
+   for (UInt32 i = 0; i < sizeof(geometries) / sizeof(geometries[0]); ++i)
+      run(geometries[i], lookups);
+   return 0;
+}
@@ -0,0 +1,301 @@
+#include "cap_bitset.h"
+#include "cap_anml_loader.h"
+#include "cap_report_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+// Host-side behaviour tests of the CAP building blocks: the CapBitset kernels
+// against byte-wise references, an ANML automaton compiled by CapAnmlLoader and
+// matched the way CacheCntlr::processPatternMatch does, and the binary report
+// file written by CapReportQueue.
+//
+//   ./cap_test
+
+using namespace ParametricDramDirectoryMSI;
+
+static UInt32 failures = 0;
+
+#define CHECK(expr, ...)                                 \
+   if (!(expr))                                          \
+   {                                                     \
+      printf("FAIL %s:%d: ", __FILE__, __LINE__);        \
+      printf(__VA_ARGS__);                               \
+      printf("\n");                                      \
+      ++failures;                                        \
+   }
+
+static void randomBytes(Byte* buf, UInt32 length, UInt32 density)
+{
+   // density: percentage of bits set
+   for (UInt32 i = 0; i < length; ++i)
+   {
+      buf[i] = 0;
+      for (UInt32 b = 0; b < 8; ++b)
+         if ((UInt32)(rand() % 100) < density)
+            buf[i] |= 1 << b;
+   }
+}
+
+static void testOrRow()
+{
+   // Lengths around the word and vector widths, at unaligned offsets
+   for (UInt32 length = 0; length <= 130; ++length)
+      for (UInt32 offset = 0; offset < 3; ++offset)
+      {
+         std::vector<Byte> out(length + offset + 8), row(length + offset + 8), expect;
+         randomBytes(&out[0], out.size(), 30);
+         randomBytes(&row[0], row.size(), 30);
+         expect = out;
+         for (UInt32 i = 0; i < length; ++i)
+            expect[offset + i] |= row[offset + i];
+
+         CapBitset::orRow(&out[offset], &row[offset], length);
+         CHECK(out == expect, "orRow length %u offset %u", length, offset);
+      }
+}
+
+static void testMaskAnd()
+{
+   for (UInt32 length = 1; length <= 70; ++length)
+   {
+      std::vector<Byte> a(length), b(length), out(length), expect(length);
+      randomBytes(&a[0], length, length % 2 ? 2 : 40);
+      randomBytes(&b[0], length, 40);
+      bool any = false;
+      for (UInt32 i = 0; i < length; ++i)
+      {
+         expect[i] = a[i] & b[i];
+         any |= expect[i] != 0;
+      }
+      CHECK(CapBitset::maskAnd(&out[0], &a[0], &b[0], length) == any, "maskAnd result length %u", length);
+      CHECK(out == expect, "maskAnd length %u", length);
+      CHECK(CapBitset::intersects(&a[0], &b[0], length) == any, "intersects length %u", length);
+   }
+}
+
+static void testNextState()
+{
+   const UInt32 row_lengths[] = { 1, 7, 8, 16, 33, 64 };
+   const UInt32 densities[] = { 0, 1, 10, 50, 100 };
+   for (UInt32 r = 0; r < sizeof(row_lengths) / sizeof(row_lengths[0]); ++r)
+      for (UInt32 d = 0; d < sizeof(densities) / sizeof(densities[0]); ++d)
+      {
+         UInt32 row_length = row_lengths[r], num_rows = 8 * row_length;
+         std::vector<Byte> swizzle(num_rows * row_length), active(row_length);
+         std::vector<Byte> next(row_length, 0xff), expect(row_length, 0);
+         randomBytes(&swizzle[0], swizzle.size(), 20);
+         randomBytes(&active[0], row_length, densities[d]);
+
+         // Reference: STE n is bit 7-(n%8) of byte n/8
+         UInt32 expect_active = 0;
+         for (UInt32 ste = 0; ste < num_rows; ++ste)
+            if (active[ste / 8] & (0x80 >> (ste % 8)))
+            {
+               ++expect_active;
+               for (UInt32 i = 0; i < row_length; ++i)
+                  expect[i] |= swizzle[ste * row_length + i];
+            }
+
+         UInt32 num_active = CapBitset::nextState(&swizzle[0], row_length, num_rows, &active[0], &next[0]);
+         CHECK(num_active == expect_active, "nextState row_length %u density %u: %u active, expected %u",
+               row_length, densities[d], num_active, expect_active);
+         CHECK(next == expect, "nextState row_length %u density %u", row_length, densities[d]);
+      }
+}
+
+// Three patterns over two subarrays of 8 STEs, in document order:
+//  0-5   c o l o r, then a reporting or (kept as report-only STE 5)
+//  6-7   a, then b which reports itself
+//  8-12  x, a non-reporting or (folded away) into y and w, y then z, and
+//        z and w into a reporting or (STE 12)
+static const char anml_text[] =
+   "<anml version=\"1.0\">\n"
+   "  <automata-network id=\"test\">\n"
+   "    <state-transition-element id=\"c\" symbol-set=\"[c]\" start=\"all-input\">\n"
+   "      <activate-on-match element=\"o1\"/>\n"
+   "    </state-transition-element>\n"
+   "    <state-transition-element id=\"o1\" symbol-set=\"o\"><activate-on-match element=\"l\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"l\" symbol-set=\"[l]\"><activate-on-match element=\"o2\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"o2\" symbol-set=\"[o]\"><activate-on-match element=\"r\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"r\" symbol-set=\"[r]\"><activate-on-match element=\"color\"/></state-transition-element>\n"
+   "    <or id=\"color\"><report-on-high reportcode=\"1\"/></or>\n"
+   "    <state-transition-element id=\"a\" symbol-set=\"[a]\" start=\"all-input\"><activate-on-match element=\"b\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"b\" symbol-set=\"[b]\"><report-on-match/></state-transition-element>\n"
+   "    <state-transition-element id=\"x\" symbol-set=\"[x]\" start=\"all-input\"><activate-on-match element=\"fork\"/></state-transition-element>\n"
+   "    <or id=\"fork\"><activate-on-match element=\"y\"/><activate-on-match element=\"w\"/></or>\n"
+   "    <state-transition-element id=\"y\" symbol-set=\"[y]\"><activate-on-match element=\"z\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"w\" symbol-set=\"[w]\"><activate-on-match element=\"xyz\"/></state-transition-element>\n"
+   "    <state-transition-element id=\"z\" symbol-set=\"[z]\"><activate-on-match element=\"xyz\"/></state-transition-element>\n"
+   "    <or id=\"xyz\"><report-on-high reportcode=\"2\"/></or>\n"
+   "  </automata-network>\n"
+   "</anml>\n";
+
+// The per-symbol step of CacheCntlr::processPatternMatch on the loader's images
+class CapMatcher
+{
+   public:
+      CapMatcher(const CapParameters& cap, CapAnmlLoader& loader)
+         : m_cap(cap)
+         , m_cache(loader.getCacheImage())
+         , m_swizzle(loader.getSwizzleImage())
+         , m_start(loader.getSteImage().begin(), loader.getSteImage().begin() + cap.stateBytes())
+         , m_reporting(loader.getSteImage().begin() + cap.stateBytes(), loader.getSteImage().begin() + 2 * cap.stateBytes())
+         , m_all_input(loader.getSteImage().begin() + 2 * cap.stateBytes(), loader.getSteImage().end())
+         , m_curr(m_start)
+         , m_active(cap.switch_row_bytes)
+         , m_num_symbols(0)
+      {
+         m_curr.resize(cap.switch_row_bytes);
+         m_all_input.resize(cap.switch_row_bytes);
+      }
+
+      void match(const char* input, std::vector<CapReport>& reports)
+      {
+         UInt32 length = m_cap.switch_row_bytes, ste_bytes = m_cap.steBytesPerSubarray();
+         for (const char* p = input; *p; ++p)
+         {
+            for (UInt32 subarray = 0; subarray < m_cap.num_subarrays; ++subarray)
+               memcpy(&m_active[subarray * ste_bytes],
+                      &m_cache[((UInt64)subarray * m_cap.lines_per_subarray + (Byte)*p) * ste_bytes], ste_bytes);
+            ++m_num_symbols;
+
+            CapBitset::orRow(&m_curr[0], &m_all_input[0], length);
+            if (!CapBitset::maskAnd(&m_active[0], &m_active[0], &m_curr[0], length))
+            {
+               memcpy(&m_curr[0], &m_start[0], m_cap.stateBytes());
+               continue;
+            }
+            CapBitset::nextState(&m_swizzle[0], m_cap.switch_row_bytes, m_cap.switch_rows, &m_active[0], &m_curr[0]);
+            for (UInt32 k = 0; k < m_cap.stateBytes(); ++k)
+               for (UInt32 i = 0; i < 8; ++i)
+                  if (m_curr[k] & m_reporting[k] & (0x80 >> i))
+                  {
+                     CapReport report = { m_num_symbols - 1, m_num_symbols, 8 * k + i, 0 };
+                     reports.push_back(report);
+                  }
+         }
+      }
+
+   private:
+      const CapParameters& m_cap;
+      const std::vector<Byte>& m_cache;
+      const std::vector<Byte>& m_swizzle;
+      std::vector<Byte> m_start, m_reporting, m_all_input, m_curr, m_active;
+      UInt64 m_num_symbols;
+};
+
+static std::vector<CapReport> testAnmlMatch(const CapParameters& cap)
+{
+   char filename[] = "/tmp/cap_test_XXXXXX";
+   int fd = mkstemp(filename);
+   CHECK(fd >= 0, "cannot create %s", filename);
+   CHECK(write(fd, anml_text, sizeof(anml_text) - 1) == (ssize_t)(sizeof(anml_text) - 1), "cannot write %s", filename);
+   close(fd);
+
+   CapAnmlLoader loader(cap);
+   loader.load(filename);
+   unlink(filename);
+
+   CHECK(loader.getNumStes() == 13, "%u STEs, expected 13 (the non-reporting or folded)", loader.getNumStes());
+   // Reporting STEs: the kept ors 5 and 12, and b (7)
+   const std::vector<Byte>& ste_image = loader.getSteImage();
+   CHECK(ste_image[cap.stateBytes()] == 0x05 && ste_image[cap.stateBytes() + 1] == 0x08,
+         "reporting mask %02x %02x, expected 05 08", ste_image[cap.stateBytes()], ste_image[cap.stateBytes() + 1]);
+   // x (8) activates y (9) and w (10) through the folded or
+   CHECK(loader.getSwizzleImage()[8 * cap.switch_row_bytes + 1] == 0x60,
+         "row of x is %02x, expected 60", loader.getSwizzleImage()[8 * cap.switch_row_bytes + 1]);
+
+   // CAP reports when a reporting STE is enabled: the kept ors on the last
+   // symbol of their pattern, b already on the a before it. All-input c
+   // restarts "color" inside "colcolor".
+   //                   0         1         2
+   //                   012345678901234567890123
+   const char input[] = "color ab xyz xw colcolor";
+   const UInt64 expect[][2] = { { 5, 4 }, { 7, 6 }, { 12, 11 }, { 12, 14 }, { 5, 23 } };
+   const UInt32 num_expect = sizeof(expect) / sizeof(expect[0]);
+
+   std::vector<CapReport> reports;
+   CapMatcher matcher(cap, loader);
+   matcher.match(input, reports);
+
+   CHECK(reports.size() == num_expect, "%lu reports, expected %u", (unsigned long)reports.size(), num_expect);
+   for (UInt32 i = 0; i < reports.size() && i < num_expect; ++i)
+      CHECK(reports[i].ste == expect[i][0] && reports[i].offset == expect[i][1],
+            "report %u: STE %u at offset %lu, expected STE %lu at offset %lu", i,
+            reports[i].ste, (unsigned long)reports[i].offset, (unsigned long)expect[i][0], (unsigned long)expect[i][1]);
+   return reports;
+}
+
+static void testReportFile(const std::vector<CapReport>& reports)
+{
+   char filename[] = "/tmp/cap_test_reports_XXXXXX";
+   int fd = mkstemp(filename);
+   CHECK(fd >= 0, "cannot create %s", filename);
+   close(fd);
+
+   {
+      // A queue of 2 is drained by the producer while the reports come in
+      CapReportQueue queue(2, filename, 3);
+      for (UInt32 i = 0; i < reports.size(); ++i)
+      {
+         CapReport report = reports[i];
+         report.stream = i % 2;
+         queue.push(report);
+      }
+      queue.drain();
+      CHECK(queue.getNumDrained() == reports.size(), "%lu reports drained, expected %lu",
+            (unsigned long)queue.getNumDrained(), (unsigned long)reports.size());
+      CHECK(queue.getNumFullDrains() > 0, "full queue was never drained by the producer");
+   }
+
+   FILE* fp = fopen(filename, "rb");
+   CHECK(fp != NULL, "cannot open %s", filename);
+   if (!fp)
+      return;
+
+   CapReportQueue::CapReportFileHeader header;
+   CHECK(fread(&header, sizeof(header), 1, fp) == 1, "short report file header");
+   CHECK(memcmp(header.magic, "CAPR", 4) == 0, "bad magic");
+   CHECK(header.version == 1, "version %u, expected 1", header.version);
+   CHECK(header.record_size == sizeof(CapReport) && sizeof(CapReport) == 24, "record size %u, expected 24", header.record_size);
+   CHECK(header.core_id == 3, "core %u, expected 3", header.core_id);
+
+   CapReport record;
+   UInt32 num_records = 0;
+   while (fread(&record, sizeof(record), 1, fp) == 1)
+   {
+      if (num_records < reports.size())
+         CHECK(record.offset == reports[num_records].offset && record.cycle == reports[num_records].cycle
+               && record.ste == reports[num_records].ste && record.stream == num_records % 2,
+               "record %u differs", num_records);
+      ++num_records;
+   }
+   CHECK(num_records == reports.size(), "%u records, expected %lu", num_records, (unsigned long)reports.size());
+   fclose(fp);
+   unlink(filename);
+}
+
+int main(int argc, char** argv)
+{
+   // 2 subarrays of 8 STEs, a 16-row swizzle switch of 2 byte rows
+   CapParameters cap(2, 256, 8, 16, 2, 1, ComponentLatency(NULL, 0), 64);
+
+   printf("CapBitset kernel: %s\n", CapBitset::isaString());
+   testOrRow();
+   testMaskAnd();
+   testNextState();
+   std::vector<CapReport> reports = testAnmlMatch(cap);
+   testReportFile(reports);
+
+   if (failures)
+   {
+      printf("%u checks failed\n", failures);
+      return 1;
+   }
+   printf("All CAP tests passed\n");
+   return 0;
+}
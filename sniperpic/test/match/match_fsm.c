@@ -53,9 +53,7 @@ void cap_cache_init(Byte* cap_file)
   assert(cap_file);
 
   //CAP: Read the file line/line and load the cache inputs
-  SimRoiStart();
   SimNamedMarker((unsigned long)cap_file,"cprg");
-  SimRoiEnd();
 }
 
 void cap_ss_init(Byte* cap_file)
@@ -63,10 +61,7 @@ void cap_ss_init(Byte* cap_file)
   assert(cap_file);
 
   //CAP: Read the file line/line and load the ss inputs
-  
-  SimRoiStart();
   SimNamedMarker((unsigned long)cap_file,"ssprg");
-  SimRoiEnd();
 }
 
 void cap_repSte_init(Byte* ste_file)
@@ -74,134 +69,181 @@ void cap_repSte_init(Byte* ste_file)
   assert(ste_file);
 
   //CAP: Read the file line/line and load the reporting STE inputs
-  
-  SimRoiStart();
   SimNamedMarker((unsigned long)ste_file,"repSte");
-  SimRoiEnd();
 }
 
-void cap_inputMatch_init(Byte* inp_file)
+void cap_anml_init(char* anml_file)
 {
+  assert(anml_file);
+
+  //CAP: The simulator compiles the ANML automaton into all three images
+  SimNamedMarker((unsigned long)anml_file,"anml");
+}
+
+// CAP: payload bytes per packet when the input is split into several flows
+#define CAP_PACKET_SIZE 1460
+
+void cap_inputMatch_init(Byte* inp_file, UInt64 length, UInt64 num_streams)
+{
+  UInt64 stream[3];
+  UInt64 flow_length, pos, id;
   assert(inp_file);
+  assert(num_streams > 0);
+
+  //CAP: Split the input file into num_streams flows of (almost) equal length
+  //and send them through the matcher one packet at a time, round-robin
+  flow_length = (length + num_streams - 1) / num_streams;
+
+  for (pos = 0; pos < flow_length; pos += CAP_PACKET_SIZE) {
+    for (id = 0; id < num_streams; id++) {
+      UInt64 start = id * flow_length + pos;
+      UInt64 end = id * flow_length + flow_length;
+      if (end > length)
+        end = length;
+      if (start >= end)
+        continue;
+      stream[0] = (UInt64)(inp_file + start);
+      stream[1] = (end - start < CAP_PACKET_SIZE) ? (end - start) : CAP_PACKET_SIZE;
+      stream[2] = id;
+      SimNamedMarker((unsigned long)stream,"mstream");
+      //CAP: last packet of this flow, let the simulator release its context
+      if (start + stream[1] >= end)
+        SimNamedMarker(id,"mstreamend");
+    }
+  }
+  SimNamedMarker(0,"mend");
+}
+
+// CAP: everything one CAP unit needs, each partition thread gets the same images
+// and the same input, the simulator keeps only the STEs of its partition
+typedef struct {
+   Byte *cache_image, *ss_image, *ste_image, *input;
+   char *anml_file;     // set when programming from ANML instead of the images
+   UInt64 input_length, num_streams;
+} cap_job_t;
+
+void *cap_partition_thread(void *arg)
+{
+  cap_job_t *job = (cap_job_t *) arg;
+
+  if (job->anml_file) {
+    cap_anml_init(job->anml_file);
+  }
+  else {
+    // the swizzle switch goes first, it decides which STEs each partition owns
+    cap_ss_init(job->ss_image);
+    cap_cache_init(job->cache_image);
+    cap_repSte_init(job->ste_image);
+  }
+  cap_inputMatch_init(job->input, job->input_length, job->num_streams);
+  return NULL;
+}
+
+Byte *cap_map_file(char *name, struct stat *finfo, int *fd)
+{
+   Byte *fdata;
+
+   CHECK_ERROR((*fd = open(name,O_RDONLY)) < 0);
+   // Get the file length
+   CHECK_ERROR(fstat(*fd, finfo) < 0);
+   // Memory map the file
+   CHECK_ERROR((fdata = mmap(0, finfo->st_size + 1,
+      PROT_READ | PROT_WRITE, MAP_PRIVATE, *fd, 0)) == NULL);
+   return fdata;
+}
 
-  //CAP: Read the input file line/line and load the ss inputs
-  
-  SimRoiStart();
-  SimNamedMarker((unsigned long)inp_file,"match");
-  SimRoiEnd();
+void cap_unmap_file(Byte *fdata, struct stat *finfo, int fd)
+{
+   CHECK_ERROR(munmap(fdata, finfo->st_size + 1) < 0);
+   CHECK_ERROR(close(fd) < 0);
 }
 
 int main(int argc, char *argv[]) 
 {   
    int fd_cap, fd_cap2, fd_cap3, fd_cap4;
-   Byte * fdata_cap, * fdata_cap2, *fdata_cap3, *fdata_cap4;
    struct stat finfo_cap, finfo_cap2, finfo_cap3, finfo_cap4;
    char *InputMatchFile, *CacheProgramFile, *SSProgramFile, *RepSteProgFile;
+   UInt64 num_streams = 1, num_partitions = 1, i;
+   size_t name_length;
+   cap_job_t job;
+   pthread_t *threads;
+   struct timeval starttime,endtime;
 
    //CAP: If the input text file or the cache program image file is not specified, then exit
    if (argv[1] == NULL || argv[2] == NULL || argv[3] == NULL || argv[4] == NULL)
    {
-      printf("USAGE: %s <Input match filename> <Cache Program Image file> <SS program Image file><Reporting STE file>\n", argv[0]);
+      printf("USAGE: %s <Input match filename> <Cache Program Image file> <SS program Image file><Reporting STE file> [number of streams] [number of partitions]\n", argv[0]);
+      printf("       %s <Input match filename> <ANML file> - - [number of streams] [number of partitions]\n", argv[0]);
       exit(1);
    }
    InputMatchFile = argv[1];
    CacheProgramFile = argv[2];
    SSProgramFile = argv[3];
    RepSteProgFile = argv[4];
-     
-   struct timeval starttime,endtime,starttime2,endtime2,starttime3,endtime3,starttime4,endtime4;
-   srand( (unsigned)time( NULL ) );
-
-   printf("CAP: Program the Cache with STEs...\n");
-
-   // ******************************************
-   // Program the cache
-   // ******************************************
-   // Read in the Cache Program file
-   CHECK_ERROR((fd_cap = open(CacheProgramFile,O_RDONLY)) < 0);
-   // Get the file length
-   CHECK_ERROR(fstat(fd_cap, &finfo_cap) < 0);
-   // Memory map the file
-   CHECK_ERROR((fdata_cap= mmap(0, finfo_cap.st_size + 1,
-      PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_cap, 0)) == NULL);
-
-   printf("CAP: Cache pgm file ptr :0x%p, content: %d\n", fdata_cap, *(fdata_cap+3));
-	 gettimeofday(&starttime,0);
-   cap_cache_init(fdata_cap);
-	 gettimeofday(&endtime,0);
-   printf("CAP: Cache STE Programming Completed %ld\n",(endtime.tv_sec - starttime.tv_sec));
-
-   CHECK_ERROR(munmap(fdata_cap, finfo_cap.st_size + 1) < 0);
-   CHECK_ERROR(close(fd_cap) < 0);
+   if (argc > 5)
+      num_streams = strtoul(argv[5], NULL, 10);
+   if (num_streams == 0)
+      num_streams = 1;
+   // one thread per partition, must match perf_model/cap/partitions
+   if (argc > 6)
+      num_partitions = strtoul(argv[6], NULL, 10);
+   if (num_partitions == 0)
+      num_partitions = 1;
 
-   // ******************************************
-   // Program the swizzle switch
-   // ******************************************
-   printf("CAP: Program the Swizzle Switch with STEs...\n");
-
-   // Read in the Cache Program file
-   CHECK_ERROR((fd_cap2 = open(SSProgramFile,O_RDONLY)) < 0);
-   // Get the file length
-   CHECK_ERROR(fstat(fd_cap2, &finfo_cap2) < 0);
-   // Memory map the file
-   CHECK_ERROR((fdata_cap2= mmap(0, finfo_cap2.st_size + 1,
-      PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_cap2, 0)) == NULL);
-
-   printf("CAP: Swizzle switch pgm file ptr :0x%p, content: %d\n", fdata_cap2, *(fdata_cap2+3));
-	 gettimeofday(&starttime2,0);
-   cap_ss_init(fdata_cap2);
-	 gettimeofday(&endtime2,0);
-   printf("CAP: Swizzle Switch STE Programming Completed %ld\n",(endtime2.tv_sec - starttime2.tv_sec));
-
-
-   CHECK_ERROR(munmap(fdata_cap2, finfo_cap2.st_size + 1) < 0);
-   CHECK_ERROR(close(fd_cap2) < 0);
-
-   // ******************************************
-   // Program the reporting ste config
-   // ******************************************
-   printf("CAP: Program the Reporting STE ...\n");
-
-   // Read in the Rep STE Program file
-   CHECK_ERROR((fd_cap3 = open(RepSteProgFile,O_RDONLY)) < 0);
-   // Get the file length
-   CHECK_ERROR(fstat(fd_cap3, &finfo_cap3) < 0);
-   // Memory map the file
-   CHECK_ERROR((fdata_cap3= mmap(0, finfo_cap3.st_size + 1,
-      PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_cap3, 0)) == NULL);
+   srand( (unsigned)time( NULL ) );
 
-   printf("CAP: Reporting STE file ptr :0x%p, content: %d\n", fdata_cap3, *(fdata_cap3+3));
-	 gettimeofday(&starttime3,0);
-   cap_repSte_init(fdata_cap3);
-	 gettimeofday(&endtime3,0);
-   printf("CAP: Reporting STE Programming Completed %ld\n",(endtime3.tv_sec - starttime3.tv_sec));
+   //CAP: An .anml automaton replaces the three prog.pl images
+   name_length = strlen(CacheProgramFile);
+   job.anml_file = NULL;
+   if (name_length > 5 && strcmp(CacheProgramFile + name_length - 5, ".anml") == 0)
+      job.anml_file = CacheProgramFile;
 
+   if (!job.anml_file) {
+      job.cache_image = cap_map_file(CacheProgramFile, &finfo_cap, &fd_cap);
+      job.ss_image = cap_map_file(SSProgramFile, &finfo_cap2, &fd_cap2);
+      job.ste_image = cap_map_file(RepSteProgFile, &finfo_cap3, &fd_cap3);
+   }
+   job.input = cap_map_file(InputMatchFile, &finfo_cap4, &fd_cap4);
+   job.input_length = finfo_cap4.st_size;
+   job.num_streams = num_streams;
 
-   CHECK_ERROR(munmap(fdata_cap3, finfo_cap3.st_size + 1) < 0);
-   CHECK_ERROR(close(fd_cap3) < 0);
+   if (job.anml_file) {
+      printf("CAP: ANML file: %s\n", job.anml_file);
+   }
+   else {
+      printf("CAP: Cache pgm file ptr :0x%p, content: %d\n", job.cache_image, *(job.cache_image+3));
+      printf("CAP: Swizzle switch pgm file ptr :0x%p, content: %d\n", job.ss_image, *(job.ss_image+3));
+      printf("CAP: Reporting STE file ptr :0x%p, content: %d\n", job.ste_image, *(job.ste_image+3));
+   }
+   printf("CAP: Input stream file ptr :0x%p, content: %d\n", job.input, *(job.input+3));
 
    // ******************************************
-   // Finally start streaming in the inputs
+   // Program the CAP units and stream in the inputs, 
+   // one thread (core) per partition
    // ******************************************
-   printf("CAP: Reading the input file stream...\n");
-
-   // Read in the input match file
-   CHECK_ERROR((fd_cap4 = open(InputMatchFile,O_RDONLY)) < 0);
-   // Get the file length
-   CHECK_ERROR(fstat(fd_cap4, &finfo_cap4) < 0);
-   // Memory map the file
-   CHECK_ERROR((fdata_cap4= mmap(0, finfo_cap4.st_size + 1,
-      PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_cap4, 0)) == NULL);
-
-   printf("CAP: Input stream file ptr :0x%p, content: %d\n", fdata_cap4, *(fdata_cap4+3));
-	 gettimeofday(&starttime4,0);
-   cap_inputMatch_init(fdata_cap4);
-	 gettimeofday(&endtime4,0);
-   printf("CAP: Input streaming Completed %ld\n",(endtime4.tv_sec - starttime4.tv_sec));
-
-
-   CHECK_ERROR(munmap(fdata_cap4, finfo_cap4.st_size + 1) < 0);
-   CHECK_ERROR(close(fd_cap4) < 0);
+   printf("CAP: Programming and matching on %lu partition(s)...\n", num_partitions);
+
+   threads = (pthread_t *) malloc(num_partitions * sizeof(pthread_t));
+   CHECK_ERROR(threads == NULL);
+
+   gettimeofday(&starttime,0);
+   SimRoiStart();
+   for (i = 1; i < num_partitions; i++)
+      CHECK_ERROR(pthread_create(&threads[i], NULL, cap_partition_thread, &job) != 0);
+   cap_partition_thread(&job);
+   for (i = 1; i < num_partitions; i++)
+      CHECK_ERROR(pthread_join(threads[i], NULL) != 0);
+   SimRoiEnd();
+   gettimeofday(&endtime,0);
+   printf("CAP: Input streaming Completed %ld\n",(endtime.tv_sec - starttime.tv_sec));
+
+   free(threads);
+   if (!job.anml_file) {
+      cap_unmap_file(job.cache_image, &finfo_cap, fd_cap);
+      cap_unmap_file(job.ss_image, &finfo_cap2, fd_cap2);
+      cap_unmap_file(job.ste_image, &finfo_cap3, fd_cap3);
+   }
+   cap_unmap_file(job.input, &finfo_cap4, fd_cap4);
 
    return 0;
 }
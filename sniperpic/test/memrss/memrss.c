@@ -0,0 +1,79 @@
+#include "sim_api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Regression test for per-access allocations in the simulated memory path.
+// The simulator lives in the same process as the application, so the
+// resident set read from /proc/self/status includes its memory. Every phase
+// performs the same number of loads and stores; once the first phase has
+// warmed up the caches and TLBs, the resident set must stay flat.
+
+#define ARRAY_SIZE (1 << 20)   // 8 MB of longs, larger than the LLC
+
+static long array[ARRAY_SIZE];
+
+static long rss_kb(void)
+{
+   char line[256];
+   long rss = -1;
+   FILE *fp = fopen("/proc/self/status", "r");
+   if (!fp)
+      return -1;
+   while (fgets(line, sizeof(line), fp))
+   {
+      if (strncmp(line, "VmRSS:", 6) == 0)
+      {
+         rss = strtol(line + 6, NULL, 10);
+         break;
+      }
+   }
+   fclose(fp);
+   return rss;
+}
+
+static long phase(long accesses, long seed)
+{
+   long sum = 0, idx = seed;
+   for (long i = 0; i < accesses; i += 2)
+   {
+      // stride through the array so most accesses miss somewhere
+      idx = (idx + 4099) & (ARRAY_SIZE - 1);
+      sum += array[idx];
+      array[(idx + 64) & (ARRAY_SIZE - 1)] = sum;
+   }
+   return sum;
+}
+
+int main(int argc, char *argv[])
+{
+   long phases = argc > 1 ? strtol(argv[1], NULL, 10) : 4;
+   long accesses = argc > 2 ? strtol(argv[2], NULL, 10) : 2000000;
+   long max_growth_kb = (argc > 3 ? strtol(argv[3], NULL, 10) : 8) * 1024;
+   long rss_first = 0, rss, sum = 0;
+   int failed = 0;
+
+   memset(array, 0, sizeof(array));
+
+   SimRoiStart();
+   for (long p = 0; p < phases; ++p)
+   {
+      sum += phase(accesses, p);
+      rss = rss_kb();
+      if (p == 0)
+         rss_first = rss;
+      printf("[MEMRSS] phase %ld: %ld accesses, rss %ld kB (+%ld kB)\n", p, accesses, rss, rss - rss_first);
+      if (rss - rss_first > max_growth_kb)
+         failed = 1;
+   }
+   SimRoiEnd();
+
+   if (failed)
+   {
+      printf("[MEMRSS] FAILED: resident set grew by more than %ld kB after the first phase\n", max_growth_kb);
+      return 1;
+   }
+   printf("[MEMRSS] OK (%ld)\n", sum & 1);
+   return 0;
+}
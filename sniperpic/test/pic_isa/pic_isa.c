@@ -0,0 +1,92 @@
+#include "sim_api.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// PIC instructions issued from the instruction stream (SimPic/SimPicLogical).
+// Operands are written into the simulated lines with the picwr marker, the
+// outcome of the PIC operations is read back with the picres marker.
+
+#define LINE 64
+#define MAX_LINES 256
+
+static char src[MAX_LINES * LINE] __attribute__((aligned(LINE)));
+static char dst[MAX_LINES * LINE] __attribute__((aligned(LINE)));
+static char key[LINE] __attribute__((aligned(LINE)));
+
+static void pic_write(void *addr, long length)
+{
+   unsigned long args[3] = { (unsigned long)addr, (unsigned long)addr, (unsigned long)length };
+   SimNamedMarker((unsigned long)args, "picwr");
+}
+
+static void pic_read(void *addr, long length)
+{
+   unsigned long args[3] = { (unsigned long)addr, (unsigned long)addr, (unsigned long)length };
+   SimNamedMarker((unsigned long)args, "picrd");
+}
+
+static unsigned long pic_hits(void)
+{
+   unsigned long result[3] = { 0, 0, 0 };   // mask, hits, ops
+   SimNamedMarker((unsigned long)result, "picres");
+   return result[1];
+}
+
+int main(int argc, char *argv[])
+{
+   long lines = argc > 1 ? strtol(argv[1], NULL, 10) : 16;
+   unsigned long hits;
+   int failed = 0;
+   int simulated = SimInSimulator();   // natively the PIC instructions do nothing
+
+   if (lines < 1 || lines > MAX_LINES)
+   {
+      printf("[PIC_ISA] Usage: %s <lines, 1..%d>\n", argv[0], MAX_LINES);
+      return 1;
+   }
+
+   for (long i = 0; i < lines * LINE; ++i)
+      src[i] = (char)(i / LINE);
+   memset(dst, 0xff, sizeof(dst));
+   memset(key, 3, sizeof(key));
+
+   SimRoiStart();
+   pic_write(src, lines * LINE);
+   pic_write(dst, lines * LINE);
+   pic_write(key, LINE);
+
+   // dst = src, line by line
+   SimPic(SIM_PIC_COPY, src, dst, lines);
+   pic_hits();
+
+   // only line 3 equals the key
+   SimPic(SIM_PIC_SEARCH, dst, key, lines);
+   hits = pic_hits();
+   printf("[PIC_ISA] search: %lu hits\n", hits);
+   if (simulated && hits != (lines > 3 ? 1 : 0))
+      failed = 1;
+
+   // dst = src ^ dst clears every line
+   SimPicLogical(SIM_PIC_LOGIC_XOR, src, dst, lines);
+   pic_hits();
+   pic_read(dst, lines * LINE);
+   SimRoiEnd();
+
+   for (long i = 0; simulated && i < lines * LINE; ++i)
+      if (dst[i] != 0)
+      {
+         printf("[PIC_ISA] xor: byte %ld is %d\n", i, dst[i]);
+         failed = 1;
+         break;
+      }
+
+   if (failed)
+   {
+      printf("[PIC_ISA] FAILED\n");
+      return 1;
+   }
+   printf("[PIC_ISA] OK\n");
+   return 0;
+}
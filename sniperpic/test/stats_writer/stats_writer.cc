@@ -0,0 +1,249 @@
+#include <sqlite3.h>
+#include <pthread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Caller-side latency of StatsManager::recordStats when periodic statistics are
+// written to sqlite. Reproduces the database layout and the write pattern of
+// common/misc/stats.cc without the simulator around it:
+//
+//   "sync-memory"  the previous recordStats: inserts on the calling thread,
+//                  in-memory rollback journal
+//   "sync-wal"     general/stats_queue_depth=0: inserts on the calling thread, WAL
+//   "queued"       general/stats_queue_depth=4: snapshot copy, background writer
+//                  thread, WAL; a full queue makes the caller write the oldest snapshot
+//
+// Between two records the "simulation" spins for a fixed time.
+//
+//   ./stats_writer [values per record, default 20000] [records, default 200] [work between records in us, default 5000]
+
+static uint64_t now_us()
+{
+   struct timeval tv = {0,0};
+   gettimeofday(&tv, NULL);
+   return uint64_t(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+static void spin(uint64_t usec)
+{
+   uint64_t end = now_us() + usec;
+   while (now_us() < end)
+      ;
+}
+
+struct StatsValue
+{
+   uint64_t nameid;
+   uint32_t core;
+   uint64_t value;
+};
+
+struct Snapshot
+{
+   uint64_t prefixid;
+   std::string prefix;
+   std::vector<StatsValue> values;
+};
+
+class Writer
+{
+   public:
+      Writer(const char *filename, const char *journal_mode, unsigned int queue_depth)
+         : m_queue_depth(queue_depth)
+         , m_stop(false)
+      {
+         unlink(filename);
+         unlink((std::string(filename) + "-wal").c_str());
+         unlink((std::string(filename) + "-shm").c_str());
+         sqlite3_open(filename, &m_db);
+         sqlite3_exec(m_db, "PRAGMA synchronous = OFF", NULL, NULL, NULL);
+         sqlite3_exec(m_db, (std::string("PRAGMA journal_mode = ") + journal_mode).c_str(), NULL, NULL, NULL);
+         sqlite3_exec(m_db, "CREATE TABLE `prefixes` (prefixid INTEGER, prefixname TEXT);", NULL, NULL, NULL);
+         sqlite3_exec(m_db, "CREATE TABLE `values` (prefixid INTEGER, nameid INTEGER, core INTEGER, value INTEGER);", NULL, NULL, NULL);
+         sqlite3_exec(m_db, "CREATE INDEX `idx_value_prefix` ON `values`(`prefixid`);", NULL, NULL, NULL);
+         sqlite3_prepare(m_db, "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);", -1, &m_stmt_prefix, NULL);
+         sqlite3_prepare(m_db, "INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?);", -1, &m_stmt_value, NULL);
+         pthread_mutex_init(&m_db_lock, NULL);
+         pthread_mutex_init(&m_queue_lock, NULL);
+         pthread_cond_init(&m_queue_cond, NULL);
+         if (m_queue_depth)
+            pthread_create(&m_thread, NULL, threadFunc, this);
+      }
+
+      ~Writer()
+      {
+         if (m_queue_depth)
+         {
+            pthread_mutex_lock(&m_queue_lock);
+            m_stop = true;
+            pthread_cond_broadcast(&m_queue_cond);
+            pthread_mutex_unlock(&m_queue_lock);
+            pthread_join(m_thread, NULL);
+         }
+         for(std::vector<Snapshot*>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+            delete *it;
+         sqlite3_finalize(m_stmt_prefix);
+         sqlite3_finalize(m_stmt_value);
+         sqlite3_exec(m_db, "PRAGMA wal_checkpoint(TRUNCATE)", NULL, NULL, NULL);
+         sqlite3_close(m_db);
+      }
+
+      void record(uint64_t prefixid, const std::vector<StatsValue> &metrics)
+      {
+         pthread_mutex_lock(&m_queue_lock);
+         Snapshot *snapshot;
+         if (m_free.empty())
+            snapshot = new Snapshot();
+         else
+         {
+            snapshot = m_free.back();
+            m_free.pop_back();
+         }
+         pthread_mutex_unlock(&m_queue_lock);
+
+         snapshot->prefixid = prefixid;
+         snapshot->prefix = "periodic-" + std::to_string(prefixid);
+         snapshot->values.assign(metrics.begin(), metrics.end());
+
+         pthread_mutex_lock(&m_queue_lock);
+         if (m_queue_depth == 0)
+         {
+            pthread_mutex_unlock(&m_queue_lock);
+            write(snapshot);
+            pthread_mutex_lock(&m_queue_lock);
+            m_free.push_back(snapshot);
+         }
+         else
+         {
+            while (m_pending.size() >= m_queue_depth)
+            {
+               Snapshot *oldest = m_pending.front();
+               m_pending.pop_front();
+               pthread_mutex_unlock(&m_queue_lock);
+               write(oldest);
+               pthread_mutex_lock(&m_queue_lock);
+               m_free.push_back(oldest);
+            }
+            m_pending.push_back(snapshot);
+            pthread_cond_broadcast(&m_queue_cond);
+         }
+         pthread_mutex_unlock(&m_queue_lock);
+      }
+
+   private:
+      static void *threadFunc(void *arg)
+      {
+         ((Writer*)arg)->run();
+         return NULL;
+      }
+
+      void run()
+      {
+         pthread_mutex_lock(&m_queue_lock);
+         while (true)
+         {
+            while (m_pending.empty() && !m_stop)
+               pthread_cond_wait(&m_queue_cond, &m_queue_lock);
+            if (m_pending.empty())
+               break;
+            Snapshot *snapshot = m_pending.front();
+            m_pending.pop_front();
+            pthread_mutex_unlock(&m_queue_lock);
+            write(snapshot);
+            pthread_mutex_lock(&m_queue_lock);
+            m_free.push_back(snapshot);
+         }
+         pthread_mutex_unlock(&m_queue_lock);
+      }
+
+      void write(Snapshot *snapshot)
+      {
+         pthread_mutex_lock(&m_db_lock);
+         sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+         sqlite3_reset(m_stmt_prefix);
+         sqlite3_bind_int64(m_stmt_prefix, 1, snapshot->prefixid);
+         sqlite3_bind_text(m_stmt_prefix, 2, snapshot->prefix.c_str(), -1, SQLITE_STATIC);
+         if (sqlite3_step(m_stmt_prefix) != SQLITE_DONE)
+            fprintf(stderr, "insert failed: %s\n", sqlite3_errmsg(m_db)), exit(1);
+         sqlite3_bind_int64(m_stmt_value, 1, snapshot->prefixid);
+         for(std::vector<StatsValue>::iterator it = snapshot->values.begin(); it != snapshot->values.end(); ++it)
+         {
+            sqlite3_reset(m_stmt_value);
+            sqlite3_bind_int64(m_stmt_value, 2, it->nameid);
+            sqlite3_bind_int(m_stmt_value, 3, it->core);
+            sqlite3_bind_int64(m_stmt_value, 4, it->value);
+            if (sqlite3_step(m_stmt_value) != SQLITE_DONE)
+               fprintf(stderr, "insert failed: %s\n", sqlite3_errmsg(m_db)), exit(1);
+         }
+         sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+         pthread_mutex_unlock(&m_db_lock);
+      }
+
+      sqlite3 *m_db;
+      sqlite3_stmt *m_stmt_prefix, *m_stmt_value;
+      pthread_mutex_t m_db_lock;
+
+      unsigned int m_queue_depth;
+      std::deque<Snapshot*> m_pending;
+      std::vector<Snapshot*> m_free;
+      pthread_mutex_t m_queue_lock;
+      pthread_cond_t m_queue_cond;
+      pthread_t m_thread;
+      bool m_stop;
+};
+
+static void measure(const char *name, const char *journal_mode, unsigned int queue_depth,
+                    const std::vector<StatsValue> &metrics, unsigned int records, unsigned int work_us)
+{
+   std::vector<uint64_t> latency;
+   uint64_t start = now_us();
+   {
+      Writer writer("stats_writer.sqlite3", journal_mode, queue_depth);
+      for(unsigned int i = 0; i < records; ++i)
+      {
+         spin(work_us);
+         uint64_t t0 = now_us();
+         writer.record(i + 1, metrics);
+         latency.push_back(now_us() - t0);
+      }
+   }
+   uint64_t total = now_us() - start;
+
+   std::sort(latency.begin(), latency.end());
+   uint64_t sum = 0;
+   for(std::vector<uint64_t>::iterator it = latency.begin(); it != latency.end(); ++it)
+      sum += *it;
+   printf("%-12s  recordStats mean %7.1f us  median %6lu us  p99 %6lu us  max %6lu us  total %6.2f s\n",
+      name, sum / double(records), (unsigned long)latency[records / 2],
+      (unsigned long)latency[records * 99 / 100], (unsigned long)latency.back(), total / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+   unsigned int num_values = argc > 1 ? atoi(argv[1]) : 20000;
+   unsigned int records = argc > 2 ? atoi(argv[2]) : 200;
+   unsigned int work_us = argc > 3 ? atoi(argv[3]) : 5000;
+
+   std::vector<StatsValue> metrics(num_values);
+   for(unsigned int i = 0; i < num_values; ++i)
+   {
+      StatsValue value = { i / 64 + 1, i % 64, uint64_t(i) * 2654435761u };
+      metrics[i] = value;
+   }
+
+   printf("%u values per record, %u records, %u us of work between records\n", num_values, records, work_us);
+   measure("sync-memory", "MEMORY", 0, metrics, records, work_us);
+   measure("sync-wal", "WAL", 0, metrics, records, work_us);
+   measure("queued", "WAL", 4, metrics, records, work_us);
+
+   unlink("stats_writer.sqlite3");
+   return 0;
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+
+# Per-event dynamic energies of the PIC and CAP hardware, from CACTI 6.5 models
+# of the configured geometry. The output is a config fragment that sets
+# perf_model/<cache>/pic_energy/<op> and perf_model/cap/energy/<event> (pJ);
+# pass it to the simulator with -c so that the pic_energy_* and cap_energy_*
+# statistics are charged, then mcpat_pic.py and pic_microbench.py report them.
+#
+#   cacti_pic.py -c <sim.cfg> [-c <override.cfg>] [--cacti <path to cacti65 binary>] > energy.cfg
+#
+# Modeled arrays, one CACTI RAM run each (read and write energy per access):
+#   PIC bank: cache_size/banks, one line per access. A line-op reads its
+#     operand lines and writes its result line (see PIC_LINE_ACCESSES).
+#   CAP subarray: lines_per_subarray lines of stes_per_subarray bits, one
+#     line read per subarray and symbol, one line write to program it.
+#   Swizzle switch: switch_rows rows of switch_row_bytes, one row read per
+#     active STE. The current state mask register is as wide as a row, an
+#     update is charged as a row write.
+
+import sys, os, re, getopt, subprocess, tempfile, sniper_config
+
+PIC_CACHES = ('l1_dcache', 'l2_cache', 'l3_cache', 'nuca')
+# (line reads, line writes) of one PIC line-op
+PIC_LINE_ACCESSES = {
+  'copy':   (1, 1),
+  'cmp':    (2, 0),
+  'search': (2, 0),
+  'logic':  (2, 1),
+  'clmult': (2, 1),
+}
+
+CACTI_CFG = '''-size (bytes) %(size)d
+-block size (bytes) %(block)d
+-associativity 1
+-read-write port 1
+-exclusive read port 0
+-exclusive write port 0
+-single ended read ports 0
+-UCA bank count 1
+-technology (u) %(tech).3f
+-page size (bits) 8192
+-burst length 8
+-internal prefetch width 8
+-Data array cell type - "itrs-hp"
+-Data array peripheral type - "itrs-hp"
+-Tag array cell type - "itrs-hp"
+-Tag array peripheral type - "itrs-hp"
+-output/input bus width %(bus)d
+-operating temperature (K) 360
+-cache type "ram"
+-tag size (b) "default"
+-access mode (normal, sequential, fast) - "normal"
+-design objective (weight delay, dynamic power, leakage power, cycle time, area) 0:100:0:0:0
+-deviate (delay, dynamic power, leakage power, cycle time, area) 60:100000:100000:100000:100000
+-Optimize ED or ED^2 (ED, ED^2, NONE): "NONE"
+-Cache model (NUCA, UCA)  - "UCA"
+-Wire signalling (fullswing, lowswing, default) - "default"
+-Wire inside mat - "semi-global"
+-Wire outside mat - "semi-global"
+-Interconnect projection - "conservative"
+-Add ECC - "false"
+-Print level (DETAILED, CONCISE) - "CONCISE"
+-Print input parameters - "false"
+-Force cache config - "false"
+'''
+
+def cacti_energy(cacti, size, block, tech_nm):
+  # Returns (read, write) dynamic energy per access in pJ
+  cfg = tempfile.NamedTemporaryFile(mode = 'w', suffix = '.cfg', delete = False)
+  cfg.write(CACTI_CFG % { 'size': max(size, 64), 'block': block, 'tech': tech_nm / 1000., 'bus': 8 * block })
+  cfg.close()
+  try:
+    out = subprocess.Popen([ cacti, '-infile', cfg.name ], stdout = subprocess.PIPE,
+                           cwd = os.path.dirname(os.path.abspath(cacti))).communicate()[0]
+  finally:
+    os.unlink(cfg.name)
+  read = re.search(r'Total dynamic read energy per access \(nJ\): *([0-9.e+-]+)', out)
+  if not read:
+    raise ValueError('CACTI found no organization for a %d byte array of %d byte lines' % (size, block))
+  # CACTI 6.5 does not always print a write energy, a write then costs as much as a read
+  write = re.search(r'Total dynamic write energy per access \(nJ\): *([0-9.e+-]+)', out)
+  return (float(read.group(1)) * 1000, float((write or read).group(1)) * 1000)
+
+def pic_energies(cfg, cacti, tech_nm):
+  for cache in PIC_CACHES:
+    key = 'perf_model/%s/cache_size' % cache
+    if key not in cfg or (cache == 'nuca' and sniper_config.get_config_default(cfg, 'perf_model/nuca/enabled', 'false') != 'true'):
+      continue
+    size = 1024 * int(sniper_config.get_config(cfg, key))
+    banks = int(sniper_config.get_config_default(cfg, 'perf_model/%s/banks' % cache, 1))
+    block = int(sniper_config.get_config_default(cfg, 'perf_model/%s/cache_block_size' % cache,
+                sniper_config.get_config(cfg, 'perf_model/l1_dcache/cache_block_size')))
+    read, write = cacti_energy(cacti, size / banks, block, tech_nm)
+    yield 'perf_model/%s/pic_energy' % cache, [ (op, reads * read + writes * write)
+                                               for op, (reads, writes) in sorted(PIC_LINE_ACCESSES.items()) ]
+
+def cap_energies(cfg, cacti, tech_nm):
+  if 'perf_model/cap/num_subarrays' not in cfg:
+    return
+  get = lambda name: int(sniper_config.get_config(cfg, 'perf_model/cap/' + name))
+  ste_bytes = get('stes_per_subarray') / 8
+  sub_read, sub_write = cacti_energy(cacti, get('lines_per_subarray') * ste_bytes, ste_bytes, tech_nm)
+  row_bytes = get('switch_row_bytes')
+  ss_read, ss_write = cacti_energy(cacti, get('switch_rows') * row_bytes, row_bytes, tech_nm)
+  yield 'perf_model/cap/energy', [
+    ('subarray_read', sub_read),
+    ('switch_row', ss_read),
+    ('state_update', ss_write),
+    ('program_write', max(sub_write, ss_write)),
+  ]
+
+
+if __name__ == '__main__':
+  def usage():
+    print('Usage: %s -c <sim.cfg> [-c <sim.cfg>...] [--cacti <cacti binary>]' % sys.argv[0])
+    sys.exit(1)
+
+  configs = []
+  cacti = os.environ.get('CACTI', os.path.join(os.path.dirname(__file__), '../cacti65/cacti'))
+  try:
+    opts, args = getopt.getopt(sys.argv[1:], 'hc:', [ 'cacti=' ])
+  except getopt.GetoptError, e:
+    print(e)
+    usage()
+  for o, a in opts:
+    if o == '-h':
+      usage()
+    elif o == '-c':
+      configs.append(a)
+    elif o == '--cacti':
+      cacti = a
+  if not configs:
+    usage()
+  if not os.path.exists(cacti):
+    print >> sys.stderr, 'CACTI 6.5 binary %s not found, set --cacti or CACTI' % cacti
+    sys.exit(1)
+
+  cfg = {}
+  for filename in configs:
+    cfg = sniper_config.parse_config(file(filename).read(), cfg)
+  tech_nm = int(sniper_config.get_config_default(cfg, 'power/technology_node', 45))
+
+  print('# Dynamic energy per event in pJ, CACTI 6.5 at %d nm' % tech_nm)
+  for section, energies in list(pic_energies(cfg, cacti, tech_nm)) + list(cap_energies(cfg, cacti, tech_nm)):
+    print('[%s]' % section)
+    for name, energy in energies:
+      print('%s = %.4f' % (name, energy))
+    print('')
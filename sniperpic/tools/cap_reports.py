@@ -0,0 +1,31 @@
+#!/usr/bin/env python
+
+# Dump the CAP report events written by CapReportQueue (cap_reports-<core>.bin)
+# as one "offset ste stream cycle" line per report
+
+import sys, struct
+
+HEADER = struct.Struct('<4sIII')   # magic, version, record size, core id
+RECORD = struct.Struct('<QQII')    # offset, cycle, ste, stream
+
+def read_reports(filename):
+  f = open(filename, 'rb')
+  magic, version, record_size, core_id = HEADER.unpack(f.read(HEADER.size))
+  if magic != b'CAPR' or record_size != RECORD.size:
+    raise ValueError('%s: not a CAP report file' % filename)
+  while True:
+    data = f.read(record_size)
+    if len(data) < record_size:
+      break
+    yield (core_id,) + RECORD.unpack(data)
+
+
+if __name__ == '__main__':
+  if len(sys.argv) < 2:
+    print('Usage: %s <cap_reports-N.bin> [...]' % sys.argv[0])
+    sys.exit(1)
+
+  print('# core offset ste stream cycle')
+  for filename in sys.argv[1:]:
+    for core_id, offset, cycle, ste, stream in read_reports(filename):
+      print('%d %d %d %d %d' % (core_id, offset, ste, stream, cycle))
@@ -229,6 +229,7 @@ def main(jobid, resultsdir, outputfile, powertype = 'dynamic', config = None, no
   time0_begin = results['results']['performance_model.elapsed_time_begin'][0]
   time0_end = results['results']['performance_model.elapsed_time_end'][0]
   seconds = (time0_end - time0_begin)/1e15
+  accel = accel_energy(results['results'])
   results = power_stack(power_dat, powertype)
   # Plot stack
   plot_labels = []
@@ -277,6 +278,17 @@ def main(jobid, resultsdir, outputfile, powertype = 'dynamic', config = None, no
         print '  %-12s    %6.4f W   %6.4f %sJ    %6.4f%%' % ('cache', float(total_cache), energy, energy_scale, 100 * float(total_cache) / total)
         energy, energy_scale = sniper_lib.scale_sci(float(total) * seconds)
         print '  %-12s    %6.4f W   %6.4f %sJ    %6.4f%%' % ('total', float(total), energy, energy_scale, 100 * float(total) / total)
+    # PIC/CAP dynamic energy, counted per event by the simulator (see tools/cacti_pic.py)
+    if print_stack and (accel['pic_ops'] or accel['cap_symbols']):
+      print
+      print '                     Energy    Per event   Throughput'
+      for name, energy, events, unit in (('pic', accel['pic'], accel['pic_ops'], 'op'), ('cap', accel['cap'], accel['cap_symbols'], 'B')):
+        if not events:
+          continue
+        total_energy, energy_scale = sniper_lib.scale_sci(energy)
+        per_event, per_event_scale = sniper_lib.scale_sci(energy / events)
+        throughput, throughput_scale = sniper_lib.scale_sci(events / (seconds or 1e-15))
+        print '  %-12s    %6.4f %sJ   %6.4f %sJ/%s   %6.4f %s%s/s' % (name, total_energy, energy_scale, per_event, per_event_scale, unit, throughput, throughput_scale, unit)
 
   if not no_graph:
     # Use Gnuplot to make a stacked bargraphs of these cpi-stacks
@@ -291,6 +303,16 @@ def main(jobid, resultsdir, outputfile, powertype = 'dynamic', config = None, no
 
 
 
+def accel_energy(stats):
+  # pic_energy_* and cap_energy_* are kept in fJ, the event counts alongside them
+  total = lambda prefix: sum(sum(v) for k, v in stats.items() if k.split('.')[-1].startswith(prefix))
+  return {
+    'pic': total('pic_energy_') * 1e-15,
+    'pic_ops': total('pic_ops_'),
+    'cap': total('cap_energy_') * 1e-15,
+    'cap_symbols': total('cap_symbols'),
+  }
+
 def power_stack(power_dat, powertype = 'total', nocollapse = False):
   def getpower(powers, key = None, ic_only = False):
     def getcomponent(suffix):
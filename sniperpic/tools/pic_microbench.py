@@ -0,0 +1,58 @@
+#!/usr/bin/env python
+
+# Results table of the declarative PIC microbenchmark kernel
+# (general/microbench_type = 6, [general/microbench_kernel]), one line per
+# results directory: the same kernel run with general/pic_on false (baseline
+# loads/stores) and true (PIC ops) lines up row by row. ops counts the lines
+# of every op of a mix, microbench.kernel-ops-<op> splits it per op.
+#
+# energy/op is the PIC/CAP dynamic energy the simulator counted (pic_energy_*,
+# cap_energy_*, see cacti_pic.py) per kernel op; it is 0 unless the energy
+# parameters were set. Core and cache power come from mcpat_pic.py.
+
+import sys, sniper_lib
+
+LEVELS = ('L1-D', 'L2', 'L3', 'nuca-cache')
+WHERES = ('L1', 'L2', 'L3', 'nuca-cache', 'dram')
+PIC_OPS = ('copy', 'cmp', 'search', 'logic', 'clmult')
+
+def kernel_row(resultsdir):
+  res = sniper_lib.get_results(resultsdir = resultsdir)
+  config, stats = res['config'], res['results']
+  stat = lambda name: stats.get(name, [0])[0]   # the kernel runs on core 0
+
+  ops = stat('microbench.kernel-ops')
+  cycles = stat('performance_model.cycle_count')
+  seconds = stat('performance_model.elapsed_time') * 1e-15
+
+  # Where the core's own loads and stores were served (dram-local/-remote are dram)
+  accesses = [ sum(v[0] for k, v in stats.items()
+                   if k.startswith('L1-D.loads-where-' + where) or k.startswith('L1-D.stores-where-' + where))
+               for where in WHERES ]
+  total = float(sum(accesses) or 1)
+
+  pic_ops = [ sum(stat('%s.pic_ops_%s' % (level, op)) for op in PIC_OPS) for level in LEVELS ]
+  energy = sum(sum(v) for k, v in stats.items()
+               if k.split('.')[-1].startswith('pic_energy_') or k.split('.')[-1].startswith('cap_energy_')) * 1e-15
+
+  # an op mix ("copy:3 bmm") stays one column
+  return ([ '+'.join(config.get('general/microbench_kernel/op', 'copy').split()),
+            'pic' if config.get('general/pic_on', 'false') == 'true' else 'base',
+            '%d' % ops, '%d' % cycles,
+            '%.2f' % (cycles / float(ops or 1)),
+            '%.4g' % (ops / (seconds or 1e-15)),
+            '%.4g' % (energy / (ops or 1)) ]
+          + [ '%.1f' % (100 * a / total) for a in accesses ]
+          + [ '%d' % p for p in pic_ops ])
+
+
+if __name__ == '__main__':
+  if len(sys.argv) < 2:
+    print('Usage: %s <resultsdir> [...]' % sys.argv[0])
+    sys.exit(1)
+
+  print('# kernel variant ops cycles cycles/op ops/s J/op '
+        + ' '.join('%%' + where for where in WHERES) + ' '
+        + ' '.join('pic_ops-' + level for level in LEVELS))
+  for resultsdir in sys.argv[1:]:
+    print(' '.join(kernel_row(resultsdir)))